@@ -0,0 +1,166 @@
+/*
+ * bench_aging - reports the queue wait of jobs of each priority class with
+ * and without priority aging (see pri_jobqueue_set_aging).
+ *
+ * A simulated stream of jobs arrives at a queue in bursts of 0 to 3 jobs per
+ * tick, with a mean of load jobs per tick, and one job is dequeued per tick.
+ * Half of the jobs have priority 1 and the rest priorities 2 to 5. The wait
+ * of a job is the number of ticks from its enqueue to its dequeue. Jobs that
+ * are still queued at the end of a run are counted with the wait so far,
+ * and jobs that arrive at a full queue are dropped. For each aging step
+ * (0 for strict priority order) and engine, it reports the p50, p99, p999
+ * and maximum wait of each priority and the time per tick.
+ *
+ * Usage:
+ *      bin/bench/bench_aging [load [ticks [capacity]]]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "benchutil.h"
+#include "../pri_jobqueue.h"
+
+#define PRIORITIES 5
+
+static const char* engine_names[] = { "heap", "scan", "bucket" };
+
+/* cumulative shares of priorities 1 to PRIORITIES, in 1/100ths */
+static const int pri_share[PRIORITIES] = { 50, 70, 85, 95, 100 };
+
+typedef struct waits {
+    unsigned int* ticks;
+    int n;
+    int queued;
+    int dropped;
+} waits_t;
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned int rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (unsigned int) (rng_state >> 32);
+}
+
+/* 0 to 3 arrivals with a mean of load (at most 3) */
+static int arrivals(double load) {
+    int n = 0;
+    for (int i = 0; i < 3; i++) {
+        if (rng() < load / 3 * 4294967296.0) n++;
+    }
+    return n;
+}
+
+static unsigned int priority(void) {
+    unsigned int r = rng() % 100;
+    unsigned int p = 0;
+    while (r >= (unsigned int) pri_share[p]) p++;
+    return p + 1;
+}
+
+static int cmp_uint(const void* a, const void* b) {
+    unsigned int x = *(const unsigned int*) a;
+    unsigned int y = *(const unsigned int*) b;
+    return (x > y) - (x < y);
+}
+
+static unsigned int percentile(waits_t* w, double p) {
+    if (w->n == 0) return 0;
+    int i = (int) (p * (w->n - 1));
+    return w->ticks[i];
+}
+
+static void report(unsigned int step, pri_jobqueue_engine_t engine, int pri,
+    waits_t* w, double ns_per_tick) {
+    qsort(w->ticks, w->n, sizeof(unsigned int), cmp_uint);
+    printf("%5u %-6s %3d %9d %8u %8u %8u %8u %7d %7d %8.1f\n", step,
+        engine_names[engine], pri, w->n, percentile(w, 0.5),
+        percentile(w, 0.99), percentile(w, 0.999),
+        w->n ? w->ticks[w->n - 1] : 0, w->queued, w->dropped, ns_per_tick);
+}
+
+static void run(double load, int ticks, int capacity, unsigned int step,
+    pri_jobqueue_engine_t engine) {
+    pri_jobqueue_t* pjq = pri_jobqueue_new_sized(capacity);
+    unsigned int* enqueued = malloc(3 * (size_t) ticks * sizeof(unsigned int));
+    waits_t waits[PRIORITIES];
+    job_t job;
+
+    if (!pjq || !enqueued) {
+        perror("bench_aging");
+        exit(EXIT_FAILURE);
+    }
+
+    pri_jobqueue_set_engine(pjq, engine);
+    if (step > 0)
+        pri_jobqueue_set_aging(pjq, PRI_JOBQUEUE_AGE_DEQUEUES, step);
+
+    for (int p = 0; p < PRIORITIES; p++) {
+        waits[p].ticks = malloc(3 * (size_t) ticks * sizeof(unsigned int));
+        waits[p].n = waits[p].queued = waits[p].dropped = 0;
+    }
+
+    /* the same stream of jobs for every run */
+    rng_state = 88172645463325252ULL;
+    unsigned int id = 0;
+
+    double t0 = bench_now_ns();
+    for (int t = 0; t < ticks; t++) {
+        for (int a = arrivals(load); a > 0; a--) {
+            unsigned int p = priority();
+            if (pri_jobqueue_is_full(pjq)) {
+                waits[p - 1].dropped++;
+                continue;
+            }
+            enqueued[id] = t;
+            job_set(&job, 1, id++, p, "aging");
+            pri_jobqueue_enqueue(pjq, &job);
+        }
+
+        if (pri_jobqueue_dequeue(pjq, &job)) {
+            waits_t* w = &waits[job.priority - 1];
+            w->ticks[w->n++] = t - enqueued[job.id];
+        }
+    }
+    double ns = bench_now_ns() - t0;
+
+    while (pri_jobqueue_dequeue(pjq, &job)) {
+        waits_t* w = &waits[job.priority - 1];
+        w->ticks[w->n++] = ticks - enqueued[job.id];
+        w->queued++;
+    }
+
+    for (int p = 0; p < PRIORITIES; p++) {
+        report(step, engine, p + 1, &waits[p], ns / ticks);
+        free(waits[p].ticks);
+    }
+
+    free(enqueued);
+    pri_jobqueue_delete(pjq);
+}
+
+int main(int argc, char** argv) {
+    double load = argc > 1 ? atof(argv[1]) : 0.99;
+    int ticks = argc > 2 ? atoi(argv[2]) : 1 << 20;
+    int capacity = argc > 3 ? atoi(argv[3]) : 4096;
+    unsigned int steps[] = { 0, 16, 64, 256 };
+    int nsteps = sizeof(steps) / sizeof(steps[0]);
+
+    if (load <= 0 || load > 3 || ticks < 1) {
+        fprintf(stderr, "usage: %s [load [ticks [capacity]]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("load %.3f, %d ticks, capacity %d, wait in ticks\n", load, ticks,
+        capacity);
+    printf("%5s %-6s %3s %9s %8s %8s %8s %8s %7s %7s %8s\n", "step", "engine",
+        "pri", "jobs", "p50", "p99", "p999", "max", "queued", "dropped",
+        "ns/tick");
+
+    for (int s = 0; s < nsteps; s++) {
+        run(load, ticks, capacity, steps[s], PRI_JOBQUEUE_HEAP);
+        run(load, ticks, capacity, steps[s], PRI_JOBQUEUE_BUCKET);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+/*
+ * bench_job_str - reports the throughput, in jobs per second, of converting
+ * jobs to their string representation (see JOB_STR_FMT in job.h) with 
+ * job_to_str and with snprintf, and of converting the strings back to jobs
+ * with str_to_job and with sscanf. snprintf and sscanf are the references 
+ * that job_to_str and str_to_job match.
+ *
+ * The jobs have random pids, ids and priorities within the widths of their 
+ * fields. Each run converts the same jobs, cycling through them, and the 
+ * best of several runs is reported.
+ *
+ * Usage:
+ *      bin/bench/bench_job_str [jobs [conversions]]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "benchutil.h"
+#include "../job.h"
+
+#define RUNS 5
+
+/* defeats elimination of the conversions */
+static volatile char sink;
+
+static char* snprintf_to_str(job_t* job, char* str) {
+    int ret = snprintf(str, JOB_STR_SIZE, JOB_STR_FMT, job->pid, job->id, 
+        job->priority, job->label);
+    return ret < 0 || ret >= JOB_STR_SIZE ? NULL : str;
+}
+
+static job_t* sscanf_to_job(char* str, job_t* job) {
+    if (strnlen(str, JOB_STR_SIZE + 1) != JOB_STR_SIZE - 1) return NULL;
+    if (sscanf(str, JOB_STR_FMT, &job->pid, &job->id, &job->priority, 
+        job->label) != 4) 
+        return NULL;
+    return job;
+}
+
+static double run(char* (*to_str)(job_t*, char*), job_t* jobs, int n,
+    long conversions) {
+    char str[JOB_STR_SIZE];
+    double best = 0;
+
+    for (int r = 0; r < RUNS; r++) {
+        double t0 = bench_now_ns();
+        for (long c = 0; c < conversions; c++) {
+            if (to_str(&jobs[c % n], str)) sink ^= str[11];
+        }
+        double ns = bench_now_ns() - t0;
+        double rate = conversions / ns * 1e9;
+        if (rate > best) best = rate;
+    }
+
+    return best;
+}
+
+static double run_parse(job_t* (*to_job)(char*, job_t*), char* strs, int n,
+    long conversions) {
+    job_t job;
+    double best = 0;
+
+    for (int r = 0; r < RUNS; r++) {
+        double t0 = bench_now_ns();
+        for (long c = 0; c < conversions; c++) {
+            if (to_job(&strs[(c % n) * JOB_STR_SIZE], &job)) 
+                sink ^= (char) job.id;
+        }
+        double ns = bench_now_ns() - t0;
+        double rate = conversions / ns * 1e9;
+        if (rate > best) best = rate;
+    }
+
+    return best;
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 1024;
+    long conversions = argc > 2 ? atol(argv[2]) : 1L << 22;
+
+    if (n < 1 || conversions < 1) {
+        fprintf(stderr, "usage: %s [jobs [conversions]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    job_t* jobs = malloc(n * sizeof(job_t));
+    char* strs = malloc((size_t) n * JOB_STR_SIZE);
+    if (!jobs || !strs) {
+        perror("bench_job_str");
+        return EXIT_FAILURE;
+    }
+
+    srand(n);
+    for (int i = 0; i < n; i++)
+        job_set(&jobs[i], rand() % 10000000, rand() % 100000, 
+            rand() % 100000, i % 2 ? "bench" : "a_somewhat_longer_label");
+    for (int i = 0; i < n; i++)
+        job_to_str(&jobs[i], &strs[i * JOB_STR_SIZE]);
+
+    printf("%d jobs, %ld conversions per run, best of %d runs\n", n, 
+        conversions, RUNS);
+    printf("%-12s %14s\n", "conversion", "jobs/s");
+
+    printf("%-12s %14.0f\n", "snprintf", 
+        run(snprintf_to_str, jobs, n, conversions));
+    printf("%-12s %14.0f\n", "job_to_str", 
+        run(job_to_str, jobs, n, conversions));
+    printf("%-12s %14.0f\n", "sscanf", 
+        run_parse(sscanf_to_job, strs, n, conversions));
+    printf("%-12s %14.0f\n", "str_to_job", 
+        run_parse(str_to_job, strs, n, conversions));
+
+    free(strs);
+    free(jobs);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,262 @@
+/*
+ * bench_joblog - reports the time per entry of writing jobs to a joblog 
+ * (see joblog.h) without a buffer, so that each entry is a write to the log
+ * file, and with buffers of increasing size, including the final flush. 
+ * It then reports the time per entry of reading every entry of the log with
+ * joblog_read, by a process that does not have the log open, and with 
+ * joblog_read_range in ranges of 1 to 65536 entries, and of 
+ * scanning the log with a cursor, as jobs and as entry text, for the log,
+ * for the same entries in a log of 1024-entry segments, and for a log of 
+ * 1024-entry segments compressed as the log rolls over, with the size of 
+ * its files against that of the text segments. Finally, for 
+ * asynchronous logs with rings of increasing size, it reports the time per
+ * entry spent in joblog_write by the logging thread, the time per entry 
+ * until the writer thread has written every entry and the number of 
+ * entries dropped.
+ *
+ * The log is written to JOBLOG_PATH, which is created if it does not 
+ * exist, and deleted at the end of each run.
+ *
+ * Usage:
+ *      bin/bench/bench_joblog [entries]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include "benchutil.h"
+#include "../joblog.h"
+
+#define LABEL_OFFSET 37     // of the label in a job string (JOB_STR_FMT)
+
+static void run(proc_t* proc, int entries, size_t buffer) {
+    job_t job;
+
+    joblog_init(proc);
+    if (joblog_set_buffer(proc, buffer) != 0) {
+        perror("joblog_set_buffer");
+        exit(EXIT_FAILURE);
+    }
+
+    double t0 = bench_now_ns();
+    for (int i = 0; i < entries; i++) {
+        job_set(&job, 1, i % 100000, i % 10 + 1, "bench");
+        joblog_write(proc, &job);
+    }
+    joblog_flush(proc);
+    double ns = bench_now_ns() - t0;
+
+    printf("%10zu %12.1f %14.0f\n", buffer / JOB_STR_SIZE, ns / entries,
+        entries / ns * 1e9);
+}
+
+static void run_async(proc_t* proc, int entries, int ring, 
+    joblog_full_t full) {
+    job_t job;
+
+    joblog_init(proc);
+    if (joblog_set_async(proc, ring, 10, full) != 0) {
+        perror("joblog_set_async");
+        exit(EXIT_FAILURE);
+    }
+
+    double t0 = bench_now_ns();
+    for (int i = 0; i < entries; i++) {
+        job_set(&job, 1, i % 100000, i % 10 + 1, "bench");
+        joblog_write(proc, &job);
+    }
+    double logged_ns = bench_now_ns() - t0;
+    long dropped = joblog_dropped(proc);
+    joblog_set_async(proc, 0, 0, full);
+    double ns = bench_now_ns() - t0;
+
+    printf("%10d %6s %12.1f %12.1f %10ld\n", ring, 
+        full == JOBLOG_FULL_DROP ? "drop" : "block", logged_ns / entries, 
+        ns / entries, dropped);
+}
+
+/* writes entries to a log rolled over every segment entries */
+/* the bytes of the text and compressed segment files of proc's log */
+static long long log_bytes(proc_t* proc, int segments) {
+    static const char* exts[] = { "txt", "jlz" };
+    char name[128];
+    struct stat sb;
+    long long bytes = 0;
+
+    for (int s = 0; s < segments; s++) {
+        for (int e = 0; e < 2; e++) {
+            if (s == 0)
+                snprintf(name, sizeof(name), "%s/%.31s%07d.%s", JOBLOG_PATH,
+                    proc->type_label, proc->id, exts[e]);
+            else
+                snprintf(name, sizeof(name), "%s/%.31s%07d.%06d.%s", 
+                    JOBLOG_PATH, proc->type_label, proc->id, s, exts[e]);
+            if (stat(name, &sb) == 0) bytes += sb.st_size;
+        }
+    }
+    return bytes;
+}
+
+static void write_segmented(proc_t* proc, int entries, int segment, 
+    bool compress) {
+    job_t job;
+
+    joblog_init(proc);
+    if (joblog_set_segment_size(proc, (size_t) segment * JOB_STR_SIZE) != 0
+        || joblog_set_buffer(proc, 256 * JOB_STR_SIZE) != 0
+        || joblog_set_compression(proc, compress) != 0) {
+        perror("bench_joblog");
+        exit(EXIT_FAILURE);
+    }
+
+    double t0 = bench_now_ns();
+    for (int i = 0; i < entries; i++) {
+        job_set(&job, 1, i % 100000, i % 10 + 1, "bench");
+        joblog_write(proc, &job);
+    }
+    joblog_close(proc);
+    double ns = bench_now_ns() - t0;
+
+    int segments = (entries + segment - 1) / segment;
+    printf("%d %ssegments of %d entries:\n", segments, 
+        compress ? "compressed " : "", segment);
+    printf("write %d entries: %.1f ns/entry, %lld bytes (text %lld)\n", 
+        entries, ns / entries, log_bytes(proc, segments), 
+        (long long) entries * JOB_STR_SIZE);
+}
+
+static void run_read(proc_t* proc) {
+    job_t job;
+
+    joblog_close(proc);
+
+    double t0 = bench_now_ns();
+    int n = joblog_count(proc);
+    for (int i = 0; i < n; i++) {
+        if (!joblog_read(proc, i, &job) || job.id != (unsigned int) i % 100000) {
+            fprintf(stderr, "bench_joblog: bad entry %d\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    double ns = bench_now_ns() - t0;
+
+    printf("read %d entries: %.1f ns/entry\n", n, ns / n);
+}
+
+static void run_read_range(proc_t* proc) {
+    int n = joblog_count(proc);
+    job_t* jobs = malloc(n * sizeof(job_t));
+    if (!jobs) {
+        perror("bench_joblog");
+        exit(EXIT_FAILURE);
+    }
+
+    int ranges[] = { 1, 64, 4096, 65536 };
+    for (int r = 0; r < (int) (sizeof(ranges) / sizeof(ranges[0])); r++) {
+        double t0 = bench_now_ns();
+        for (int i = 0; i < n; i += ranges[r]) {
+            int count = n - i < ranges[r] ? n - i : ranges[r];
+            if (joblog_read_range(proc, i, count, jobs + i) != count) {
+                fprintf(stderr, "bench_joblog: bad range %d\n", i);
+                exit(EXIT_FAILURE);
+            }
+        }
+        double ns = bench_now_ns() - t0;
+
+        for (int i = 0; i < n; i++) {
+            if (jobs[i].id != (unsigned int) i % 100000) {
+                fprintf(stderr, "bench_joblog: bad entry %d\n", i);
+                exit(EXIT_FAILURE);
+            }
+        }
+        printf("read ranges of %d entries: %.1f ns/entry\n", ranges[r], 
+            ns / n);
+    }
+    free(jobs);
+}
+
+static void run_cursor(proc_t* proc) {
+    joblog_cursor_t cur;
+    job_t job;
+
+    double t0 = bench_now_ns();
+    if (joblog_cursor_open(proc, &cur) != 0) {
+        perror("joblog_cursor_open");
+        exit(EXIT_FAILURE);
+    }
+    int n = joblog_cursor_count(&cur);
+    for (int i = 0; i < n; i++) {
+        if (!joblog_cursor_next(&cur, &job) 
+            || job.id != (unsigned int) i % 100000) {
+            fprintf(stderr, "bench_joblog: bad entry %d\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    joblog_cursor_close(&cur);
+    double ns = bench_now_ns() - t0;
+
+    printf("cursor scan %d entries: %.1f ns/entry\n", n, ns / n);
+
+    /* the entry text, e.g. to filter on the label without converting */
+    long labelled = 0;
+    t0 = bench_now_ns();
+    if (joblog_cursor_open(proc, &cur) != 0) {
+        perror("joblog_cursor_open");
+        exit(EXIT_FAILURE);
+    }
+    const char* entry;
+    while ((entry = joblog_cursor_next_str(&cur)))
+        labelled += entry[LABEL_OFFSET] == 'b';
+    joblog_cursor_close(&cur);
+    ns = bench_now_ns() - t0;
+
+    printf("cursor text scan %ld entries: %.1f ns/entry\n", labelled, 
+        ns / n);
+}
+
+int main(int argc, char** argv) {
+    int entries = argc > 1 ? atoi(argv[1]) : 1 << 18;
+    work_ms_t w = { 0, 0 };
+
+    if (entries < 1) {
+        fprintf(stderr, "usage: %s [entries]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    proc_t* proc = proc_new(BWAIT_CONS_PROC, "bench", 9999999, 1, true, 0, 0,
+        w, w);
+    if (!proc) {
+        perror("proc_new");
+        return EXIT_FAILURE;
+    }
+
+    printf("%d entries per run\n", entries);
+    printf("%10s %12s %14s\n", "buffered", "ns/entry", "entries/s");
+
+    size_t buffers[] = { 0, 1, 16, 256, 4096 };
+    for (int b = 0; b < (int) (sizeof(buffers) / sizeof(buffers[0])); b++)
+        run(proc, entries, buffers[b] * JOB_STR_SIZE);
+
+    run_read(proc);
+    run_read_range(proc);
+    run_cursor(proc);
+    write_segmented(proc, entries, 1024, false);
+    run_read(proc);
+    run_read_range(proc);
+    run_cursor(proc);
+    write_segmented(proc, entries, 1024, true);
+    run_read(proc);
+    run_read_range(proc);
+    run_cursor(proc);
+
+    printf("%10s %6s %12s %12s %10s\n", "ring", "full", "write ns", 
+        "written ns", "dropped");
+    int rings[] = { 256, 4096, 65536 };
+    for (int r = 0; r < (int) (sizeof(rings) / sizeof(rings[0])); r++) {
+        run_async(proc, entries, rings[r], JOBLOG_FULL_BLOCK);
+        run_async(proc, entries, rings[r], JOBLOG_FULL_DROP);
+    }
+    joblog_delete(proc);
+
+    proc_delete(proc);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+/*
+ * bench_joblog_sync - reports the throughput of writing jobs to a joblog
+ * (see joblog.h) and the latency of joblog_write (median, 99th percentile
+ * and maximum) for each sync mode (see joblog_set_sync), for a synchronous
+ * log and for an asynchronous log. The time includes the final
+ * joblog_flush, which writes and syncs the remaining entries.
+ *
+ * The log is written to JOBLOG_PATH, which is created if it does not
+ * exist, and deleted at the end of each run, so the results are for the
+ * file system of JOBLOG_PATH.
+ *
+ * Usage:
+ *      bin/bench/bench_joblog_sync [entries]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "benchutil.h"
+#include "../joblog.h"
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*) a;
+    double y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+static void run(proc_t* proc, int entries, double* lat, const char* name,
+    joblog_sync_t sync, int n, bool async) {
+    job_t job;
+
+    joblog_init(proc);
+    if (joblog_set_sync(proc, sync, n) != 0
+        || (async && joblog_set_async(proc, 4096, 10, JOBLOG_FULL_BLOCK))) {
+        perror("bench_joblog_sync");
+        exit(EXIT_FAILURE);
+    }
+
+    double t0 = bench_now_ns();
+    for (int i = 0; i < entries; i++) {
+        job_set(&job, 1, i % 100000, i % 10 + 1, "bench");
+        double t = bench_now_ns();
+        joblog_write(proc, &job);
+        lat[i] = bench_now_ns() - t;
+    }
+    joblog_flush(proc);
+    double ns = bench_now_ns() - t0;
+    joblog_close(proc);
+
+    qsort(lat, entries, sizeof(double), cmp_double);
+    printf("%-14s %6s %12.0f %10.0f %10.0f %12.0f\n", name,
+        async ? "async" : "sync", entries / ns * 1e9, lat[entries / 2],
+        lat[(int) (entries * 0.99)], lat[entries - 1]);
+}
+
+int main(int argc, char** argv) {
+    int entries = argc > 1 ? atoi(argv[1]) : 4096;
+    work_ms_t w = { 0, 0 };
+
+    if (entries < 1) {
+        fprintf(stderr, "usage: %s [entries]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    proc_t* proc = proc_new(BWAIT_CONS_PROC, "bench", 9999999, 1, true, 0, 0,
+        w, w);
+    double* lat = malloc(entries * sizeof(double));
+    if (!proc || !lat) {
+        perror("bench_joblog_sync");
+        return EXIT_FAILURE;
+    }
+
+    printf("%d entries per run\n", entries);
+    printf("%-14s %6s %12s %10s %10s %12s\n", "sync", "log", "entries/s",
+        "p50 ns", "p99 ns", "max ns");
+
+    for (int a = 0; a < 2; a++) {
+        run(proc, entries, lat, "none", JOBLOG_SYNC_NONE, 0, a);
+        run(proc, entries, lat, "interval 10ms", JOBLOG_SYNC_INTERVAL, 10, a);
+        run(proc, entries, lat, "records 64", JOBLOG_SYNC_RECORDS, 64, a);
+        run(proc, entries, lat, "every", JOBLOG_SYNC_EVERY, 0, a);
+    }
+    joblog_delete(proc);
+
+    free(lat);
+    proc_delete(proc);
+    return EXIT_SUCCESS;
+}
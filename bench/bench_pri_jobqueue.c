@@ -0,0 +1,119 @@
+/*
+ * bench_pri_jobqueue - compares the PRI_JOBQUEUE_AOS and PRI_JOBQUEUE_SOA
+ * slot layouts (see pri_jobqueue.h) for peek and dequeue/enqueue on full 
+ * queues of increasing capacity.
+ *
+ * For each capacity, engine and layout it reports the time and, where the
+ * hardware counter is available, the number of cache misses per operation.
+ * A dequeue is always followed by the enqueue of the dequeued job so that 
+ * the queue stays full.
+ *
+ * Usage:
+ *      bin/bench/bench_pri_jobqueue [capacity ...]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "benchutil.h"
+#include "../pri_jobqueue.h"
+
+#define OPS_PER_RUN (1 << 22)   // slot visits per measured run
+
+static const char* engine_names[] = { "heap", "scan", "bucket" };
+static const char* layout_names[] = { "soa", "aos" };
+
+static pri_jobqueue_t* full_queue(int capacity, pri_jobqueue_engine_t engine,
+    pri_jobqueue_layout_t layout) {
+    pri_jobqueue_t* pjq = pri_jobqueue_new_sized(capacity);
+    job_t job;
+
+    if (!pjq) return NULL;
+
+    pri_jobqueue_set_engine(pjq, engine);
+    pri_jobqueue_set_layout(pjq, layout);
+
+    srand(capacity);
+    for (int i = 0; i < capacity; i++) {
+        job_set(&job, i, i, rand() % 100 + 1, "bench");
+        pri_jobqueue_enqueue(pjq, &job);
+    }
+
+    return pjq;
+}
+
+static void report(const char* op, int capacity, pri_jobqueue_engine_t engine,
+    pri_jobqueue_layout_t layout, int ops, double ns, long long misses) {
+    printf("%-8s %9d %-6s %-4s %12.1f", op, capacity, engine_names[engine], 
+        layout_names[layout], ns / ops);
+    if (misses >= 0)
+        printf(" %12.2f\n", (double) misses / ops);
+    else
+        printf(" %12s\n", "n/a");
+}
+
+static void run(int capacity, pri_jobqueue_engine_t engine,
+    pri_jobqueue_layout_t layout, int counter) {
+    pri_jobqueue_t* pjq = full_queue(capacity, engine, layout);
+    job_t job;
+
+    if (!pjq) {
+        perror("pri_jobqueue_new_sized");
+        exit(EXIT_FAILURE);
+    }
+
+    /* an O(buf_size) scan visits every slot, so do fewer of them */
+    int ops = engine == PRI_JOBQUEUE_SCAN ? OPS_PER_RUN / capacity : 
+        OPS_PER_RUN / 64;
+    if (ops < 16) ops = 16;
+
+    double t0 = bench_now_ns();
+    bench_counter_start(counter);
+    for (int i = 0; i < ops; i++)
+        pri_jobqueue_peek(pjq, &job);
+    long long misses = bench_counter_stop(counter);
+    report("peek", capacity, engine, layout, ops, bench_now_ns() - t0, misses);
+
+    t0 = bench_now_ns();
+    bench_counter_start(counter);
+    for (int i = 0; i < ops; i++) {
+        pri_jobqueue_dequeue(pjq, &job);
+        job.priority = (job.priority * 7) % 100 + 1;
+        pri_jobqueue_enqueue(pjq, &job);
+    }
+    misses = bench_counter_stop(counter);
+    report("deq+enq", capacity, engine, layout, ops, bench_now_ns() - t0, 
+        misses);
+
+    pri_jobqueue_delete(pjq);
+}
+
+int main(int argc, char** argv) {
+    int default_capacities[] = { 128, 1024, 16384, 262144 };
+    int ncap = sizeof(default_capacities) / sizeof(default_capacities[0]);
+    int* capacities = default_capacities;
+
+    if (argc > 1) {
+        ncap = argc - 1;
+        capacities = malloc(ncap * sizeof(int));
+        for (int i = 0; i < ncap; i++)
+            capacities[i] = atoi(argv[i + 1]);
+    }
+
+    int counter = bench_counter_open();
+    if (counter < 0)
+        fprintf(stderr, "cache-miss counter unavailable, timing only\n");
+
+    printf("%-8s %9s %-6s %-4s %12s %12s\n", "op", "capacity", "engine", 
+        "lay", "ns/op", "misses/op");
+
+    for (int c = 0; c < ncap; c++) {
+        for (int e = PRI_JOBQUEUE_HEAP; e <= PRI_JOBQUEUE_BUCKET; e++) {
+            run(capacities[c], e, PRI_JOBQUEUE_AOS, counter);
+            run(capacities[c], e, PRI_JOBQUEUE_SOA, counter);
+        }
+    }
+
+    bench_counter_close(counter);
+    if (capacities != default_capacities) free(capacities);
+
+    return EXIT_SUCCESS;
+}
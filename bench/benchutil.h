@@ -0,0 +1,40 @@
+#ifndef _BENCHUTIL_H
+#define _BENCHUTIL_H
+
+/* 
+ * Introduction
+ *
+ * Helpers shared by the benchmarks in this directory: a monotonic clock and 
+ * an optional hardware cache-miss counter for the calling thread.
+ *
+ * The counter uses perf_event_open(2). It may be unavailable (e.g. in a 
+ * container or when perf_event_paranoid forbids it), in which case 
+ * bench_counter_open returns -1, bench_counter_stop returns -1 and 
+ * benchmarks report timings only.
+ *
+ * Usage:
+ *      int fd = bench_counter_open();
+ *      double t0 = bench_now_ns();
+ *      bench_counter_start(fd);
+ *      ...                             // code under test
+ *      long long misses = bench_counter_stop(fd);
+ *      double ns = bench_now_ns() - t0;
+ *      ...
+ *      bench_counter_close(fd);
+ */
+
+/* the time in nanoseconds since an arbitrary fixed point */
+double bench_now_ns(void);
+
+/* open a cache-miss counter, -1 if counters are not available */
+int bench_counter_open(void);
+
+/* reset and enable the counter fd, no effect if fd is -1 */
+void bench_counter_start(int fd);
+
+/* disable the counter fd and return its count, or -1 if fd is -1 */
+long long bench_counter_stop(int fd);
+
+void bench_counter_close(int fd);
+
+#endif
@@ -6,14 +6,43 @@
 #include "proc.h"
 
 ipc_jobqueue_t* ipc_jobqueue_new(proc_t* proc) {
-    ipc_jobqueue_t* ijq = ipc_new(proc, "ipc_jobq", sizeof(pri_jobqueue_t));
+    return ipc_jobqueue_new_sized(proc, JOB_BUFFER_SIZE);
+}
+
+ipc_jobqueue_t* ipc_jobqueue_new_sized(proc_t* proc, int capacity) {
+    ipc_jobqueue_t* ijq = ipc_new(proc, "ipc_jobq",
+        pri_jobqueue_sizeof(capacity));
+    if (!ijq)
+        return NULL;
+    if (proc->is_init)
+        pri_jobqueue_init_sized((pri_jobqueue_t*) ijq->addr, capacity);
+    return ijq;
+}
+
+ipc_jobqueue_t* ipc_jobqueue_new_compact(proc_t* proc, int capacity, 
+    int labels) {
+    ipc_jobqueue_t* ijq = ipc_new(proc, "ipc_jobq",
+        pri_jobqueue_sizeof_compact(capacity, labels));
     if (!ijq)
         return NULL;
     if (proc->is_init)
-        pri_jobqueue_init((pri_jobqueue_t*) ijq->addr);
+        pri_jobqueue_init_compact((pri_jobqueue_t*) ijq->addr, capacity, 
+            labels);
     return ijq;
 }
 
+label_table_t* ipc_jobqueue_labels(ipc_jobqueue_t* ijq) {
+    if (!ijq) return NULL;
+    return pri_jobqueue_labels((pri_jobqueue_t*)ijq->addr);
+}
+
+compact_job_t* ipc_jobqueue_dequeue_compact(ipc_jobqueue_t* ijq, 
+    compact_job_t* dst) {
+    if (!ijq) return NULL;
+    do_critical_work(ijq->proc);
+    return pri_jobqueue_dequeue_compact((pri_jobqueue_t*)ijq->addr, dst);
+}
+
 job_t* ipc_jobqueue_dequeue(ipc_jobqueue_t* ijq, job_t* dst) {
     if (!ijq) return NULL;
     do_critical_work(ijq->proc);
@@ -25,6 +54,79 @@ void ipc_jobqueue_enqueue(ipc_jobqueue_t* ijq, job_t* job) {
     do_critical_work(ijq->proc);
     pri_jobqueue_enqueue((pri_jobqueue_t*)ijq->addr, job);
 }
+
+int ipc_jobqueue_dequeue_n(ipc_jobqueue_t* ijq, job_t* dst, int n) {
+    if (!ijq) return 0;
+    do_critical_work(ijq->proc);
+    return pri_jobqueue_dequeue_n((pri_jobqueue_t*)ijq->addr, dst, n);
+}
+
+int ipc_jobqueue_enqueue_n(ipc_jobqueue_t* ijq, job_t* jobs, int n) {
+    if (!ijq) return 0;
+    do_critical_work(ijq->proc);
+    return pri_jobqueue_enqueue_n((pri_jobqueue_t*)ijq->addr, jobs, n);
+}
+
+const job_t* ipc_jobqueue_borrow(ipc_jobqueue_t* ijq) {
+    if (!ijq) return NULL;
+    do_critical_work(ijq->proc);
+    return pri_jobqueue_borrow((pri_jobqueue_t*)ijq->addr);
+}
+
+bool ipc_jobqueue_commit(ipc_jobqueue_t* ijq, const job_t* job) {
+    if (!ijq) return false;
+    do_critical_work(ijq->proc);
+    return pri_jobqueue_commit((pri_jobqueue_t*)ijq->addr, job);
+}
+
+bool ipc_jobqueue_set_order(ipc_jobqueue_t* ijq, pri_jobqueue_order_t order) {
+    if (!ijq) return false;
+    do_critical_work(ijq->proc);
+    return pri_jobqueue_set_order((pri_jobqueue_t*)ijq->addr, order);
+}
+
+bool ipc_jobqueue_enqueue_deadline(ipc_jobqueue_t* ijq, deadline_job_t* job) {
+    if (!ijq) return false;
+    do_critical_work(ijq->proc);
+    return pri_jobqueue_enqueue_deadline((pri_jobqueue_t*)ijq->addr, job);
+}
+
+deadline_job_t* ipc_jobqueue_dequeue_deadline(ipc_jobqueue_t* ijq, 
+    deadline_job_t* dst) {
+    if (!ijq) return NULL;
+    do_critical_work(ijq->proc);
+    return pri_jobqueue_dequeue_deadline((pri_jobqueue_t*)ijq->addr, dst);
+}
+
+deadline_job_t* ipc_jobqueue_peek_reachable(ipc_jobqueue_t* ijq, uint64_t now,
+    deadline_job_t* dst) {
+    if (!ijq) return NULL;
+    do_critical_work(ijq->proc);
+    return pri_jobqueue_peek_reachable((pri_jobqueue_t*)ijq->addr, now, dst);
+}
+
+deadline_job_t* ipc_jobqueue_dequeue_reachable(ipc_jobqueue_t* ijq, 
+    uint64_t now, deadline_job_t* dst) {
+    if (!ijq) return NULL;
+    do_critical_work(ijq->proc);
+    return pri_jobqueue_dequeue_reachable((pri_jobqueue_t*)ijq->addr, now, 
+        dst);
+}
+
+bool ipc_jobqueue_cancel(ipc_jobqueue_t* ijq, pid_t pid, unsigned int id) {
+    if (!ijq) return false;
+    do_critical_work(ijq->proc);
+    return pri_jobqueue_cancel((pri_jobqueue_t*)ijq->addr, pid, id);
+}
+
+bool ipc_jobqueue_reprioritise(ipc_jobqueue_t* ijq, pid_t pid, unsigned int id,
+    unsigned int priority) {
+    if (!ijq) return false;
+    do_critical_work(ijq->proc);
+    return pri_jobqueue_reprioritise((pri_jobqueue_t*)ijq->addr, pid, id, 
+        priority);
+}
+
 bool ipc_jobqueue_is_empty(ipc_jobqueue_t* ijq) {
     if (!ijq) return true; 
     do_critical_work(ijq->proc);
@@ -32,7 +134,7 @@ bool ipc_jobqueue_is_empty(ipc_jobqueue_t* ijq) {
 }
 
 bool ipc_jobqueue_is_full(ipc_jobqueue_t* ijq) {
-    if (!ijq) return false;
+    if (!ijq) return true;
     do_critical_work(ijq->proc);
     return pri_jobqueue_is_full((pri_jobqueue_t*)ijq->addr);
 }
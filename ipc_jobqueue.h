@@ -12,8 +12,29 @@
  * This header file defines an ipc_jobqueue type and the functions that 
  * operate on the queue (its interface):
  *      ipc_jobqueue_new(proc_t* proc);
+ *      ipc_jobqueue_new_sized(proc_t* proc, int capacity);
+ *      ipc_jobqueue_new_compact(proc_t* proc, int capacity, int labels);
+ *      ipc_jobqueue_labels(ipc_jobqueue_t* ijq);
+ *      ipc_jobqueue_dequeue_compact(ipc_jobqueue_t* ijq, compact_job_t* dst);
  *      ipc_jobqueue_dequeue(ipc_jobqueue_t* ijq, job_t* dst);
  *      ipc_jobqueue_enqueue(ipc_jobqueue_t* ijq, job_t* job);
+ *      ipc_jobqueue_dequeue_n(ipc_jobqueue_t* ijq, job_t* dst, int n);
+ *      ipc_jobqueue_enqueue_n(ipc_jobqueue_t* ijq, job_t* jobs, int n);
+ *      ipc_jobqueue_borrow(ipc_jobqueue_t* ijq);
+ *      ipc_jobqueue_commit(ipc_jobqueue_t* ijq, const job_t* job);
+ *      ipc_jobqueue_set_order(ipc_jobqueue_t* ijq, 
+ *          pri_jobqueue_order_t order);
+ *      ipc_jobqueue_enqueue_deadline(ipc_jobqueue_t* ijq, 
+ *          deadline_job_t* job);
+ *      ipc_jobqueue_dequeue_deadline(ipc_jobqueue_t* ijq, 
+ *          deadline_job_t* dst);
+ *      ipc_jobqueue_peek_reachable(ipc_jobqueue_t* ijq, uint64_t now,
+ *          deadline_job_t* dst);
+ *      ipc_jobqueue_dequeue_reachable(ipc_jobqueue_t* ijq, uint64_t now,
+ *          deadline_job_t* dst);
+ *      ipc_jobqueue_cancel(ipc_jobqueue_t* ijq, pid_t pid, unsigned int id);
+ *      ipc_jobqueue_reprioritise(ipc_jobqueue_t* ijq, pid_t pid, 
+ *          unsigned int id, unsigned int priority);
  *      ipc_jobqueue_is_empty(ipc_jobqueue_t* ijq);
  *      ipc_jobqueue_is_full(ipc_jobqueue_t* ijq);
  *      ipc_jobqueue_peek(ipc_jobqueue_t* ijq, job_t* dst);
@@ -97,6 +118,95 @@ typedef ipc_t ipc_jobqueue_t;
  */
 ipc_jobqueue_t* ipc_jobqueue_new(proc_t* proc);
 
+/*
+ * ipc_jobqueue_new_sized(proc_t* proc, int capacity)
+ * 
+ * As ipc_jobqueue_new but the underlying pri_jobqueue has a buffer of 
+ * capacity jobs (ipc_jobqueue_new creates a queue of JOB_BUFFER_SIZE jobs). 
+ * The shared memory object is sized by pri_jobqueue_sizeof(capacity).
+ *
+ * Every process sharing the queue must pass the same capacity.
+ * 
+ * Parameters:
+ * proc - the non-null descriptor of a process sharing this queue
+ * capacity - the number of jobs the queue can hold, from 1 to 
+ *      PRI_JOBQUEUE_MAX_CAPACITY
+ *
+ * Return:
+ * As for ipc_jobqueue_new.
+ *
+ * Errors:
+ * If the call fails, the NULL pointer will be returned and errno will be 
+ * set as follows:
+ *      EINVAL - invalid argument if proc is NULL or capacity is invalid
+ *      Other values as specified by the system library functions used to
+ *      implement the function (see ipc_new in ipc.h)
+ *
+ * See also:
+ * pri_jobqueue_new_sized and pri_jobqueue_sizeof in pri_jobqueue.h
+ */
+ipc_jobqueue_t* ipc_jobqueue_new_sized(proc_t* proc, int capacity);
+
+/*
+ * ipc_jobqueue_new_compact(proc_t* proc, int capacity, int labels)
+ * 
+ * As ipc_jobqueue_new_sized but the underlying pri_jobqueue has compact 
+ * slots and a label table for up to labels distinct labels, both in the 
+ * shared memory of the queue (see COMPACT SLOTS in pri_jobqueue.h). The 
+ * shared memory object is sized by 
+ * pri_jobqueue_sizeof_compact(capacity, labels).
+ *
+ * Every process sharing the queue must pass the same capacity and labels.
+ * The label table is shared and append-only: once it is full, a job with a
+ * new label is not enqueued and errno is set to ENOSPC (see 
+ * pri_jobqueue_new_compact).
+ * 
+ * Parameters:
+ * proc - the non-null descriptor of a process sharing this queue
+ * capacity - the number of jobs the queue can hold, from 1 to 
+ *      PRI_JOBQUEUE_MAX_CAPACITY
+ * labels - the number of distinct labels the queue can hold, from 1 to
+ *      PRI_JOBQUEUE_MAX_LABELS
+ *
+ * Return:
+ * As for ipc_jobqueue_new.
+ *
+ * Errors:
+ * If the call fails, the NULL pointer will be returned and errno will be 
+ * set as follows:
+ *      EINVAL - invalid argument if proc is NULL or capacity or labels is 
+ *          invalid
+ *      Other values as specified by the system library functions used to
+ *      implement the function (see ipc_new in ipc.h)
+ */
+ipc_jobqueue_t* ipc_jobqueue_new_compact(proc_t* proc, int capacity, 
+    int labels);
+
+/*
+ * ipc_jobqueue_labels(ipc_jobqueue_t* ijq)
+ *
+ * This is a wrapper for pri_jobqueue_labels.
+ *
+ * See the specification of pri_jobqueue_labels in pri_jobqueue.h. The table
+ * is in the shared memory of the queue, so the returned pointer is valid in
+ * the calling process only. Expanding a compact job with it reads labels 
+ * that are never changed once interned, so no critical work is simulated.
+ */
+label_table_t* ipc_jobqueue_labels(ipc_jobqueue_t* ijq);
+
+/*
+ * ipc_jobqueue_dequeue_compact(ipc_jobqueue_t* ijq, compact_job_t* dst)
+ *
+ * This is a wrapper for pri_jobqueue_dequeue_compact.
+ *
+ * See the specification of pri_jobqueue_dequeue_compact in pri_jobqueue.h.
+ *
+ * If the ijq parameter is NULL, NULL is returned and no critical work is 
+ * simulated.
+ */
+compact_job_t* ipc_jobqueue_dequeue_compact(ipc_jobqueue_t* ijq, 
+    compact_job_t* dst);
+
 /*
  * ipc_jobqueue_dequeue(ipc_jobqueue_t* ijq, job_t* dst)
  *
@@ -123,6 +233,116 @@ job_t* ipc_jobqueue_dequeue(ipc_jobqueue_t* ijq, job_t* dst);
  */
 void ipc_jobqueue_enqueue(ipc_jobqueue_t* ijq, job_t* job);
 
+/*
+ * ipc_jobqueue_dequeue_n(ipc_jobqueue_t* ijq, job_t* dst, int n)
+ *
+ * This is a wrapper for pri_jobqueue_dequeue_n.
+ *
+ * See the specification of pri_jobqueue_dequeue_n in pri_jobqueue.h.
+ *
+ * Critical work is simulated once for the whole batch rather than once per
+ * job. If the ijq parameter is NULL, 0 is returned and no critical work is
+ * simulated.
+ */
+int ipc_jobqueue_dequeue_n(ipc_jobqueue_t* ijq, job_t* dst, int n);
+
+/*
+ * ipc_jobqueue_enqueue_n(ipc_jobqueue_t* ijq, job_t* jobs, int n)
+ *
+ * This is a wrapper for pri_jobqueue_enqueue_n.
+ *
+ * See the specification of pri_jobqueue_enqueue_n in pri_jobqueue.h.
+ *
+ * Critical work is simulated once for the whole batch rather than once per
+ * job. If the ijq parameter is NULL, 0 is returned and no critical work is
+ * simulated.
+ */
+int ipc_jobqueue_enqueue_n(ipc_jobqueue_t* ijq, job_t* jobs, int n);
+
+/*
+ * ipc_jobqueue_borrow(ipc_jobqueue_t* ijq)
+ *
+ * This is a wrapper for pri_jobqueue_borrow.
+ *
+ * See the specification of pri_jobqueue_borrow in pri_jobqueue.h. The 
+ * returned pointer is to the job in the shared memory of the queue, so it is
+ * valid in the calling process only and only until the job is committed. 
+ * Any process sharing the queue may commit it.
+ *
+ * If the ijq parameter is NULL, NULL is returned and no critical work is 
+ * simulated.
+ */
+const job_t* ipc_jobqueue_borrow(ipc_jobqueue_t* ijq);
+
+/*
+ * ipc_jobqueue_commit(ipc_jobqueue_t* ijq, const job_t* job)
+ *
+ * This is a wrapper for pri_jobqueue_commit.
+ *
+ * See the specification of pri_jobqueue_commit in pri_jobqueue.h. 
+ *
+ * If the ijq parameter is NULL, false is returned and no critical work is 
+ * simulated.
+ */
+bool ipc_jobqueue_commit(ipc_jobqueue_t* ijq, const job_t* job);
+
+/*
+ * ipc_jobqueue_set_order(ipc_jobqueue_t* ijq, pri_jobqueue_order_t order)
+ *
+ * This is a wrapper for pri_jobqueue_set_order.
+ *
+ * See the specification of pri_jobqueue_set_order in pri_jobqueue.h. The 
+ * order is a property of the shared queue, so it applies to every process 
+ * that shares it. It is usually set by the init process after creating the
+ * queue.
+ *
+ * If the ijq parameter is NULL, false is returned and no critical work is 
+ * simulated.
+ */
+bool ipc_jobqueue_set_order(ipc_jobqueue_t* ijq, pri_jobqueue_order_t order);
+
+/*
+ * ipc_jobqueue_enqueue_deadline(ipc_jobqueue_t* ijq, deadline_job_t* job)
+ * ipc_jobqueue_dequeue_deadline(ipc_jobqueue_t* ijq, deadline_job_t* dst)
+ * ipc_jobqueue_peek_reachable(ipc_jobqueue_t* ijq, uint64_t now,
+ *      deadline_job_t* dst)
+ * ipc_jobqueue_dequeue_reachable(ipc_jobqueue_t* ijq, uint64_t now,
+ *      deadline_job_t* dst)
+ *
+ * These are wrappers for the corresponding pri_jobqueue functions.
+ *
+ * See their specifications in pri_jobqueue.h. Deadlines are times of 
+ * job_clock_ms, which is the same in every process of the host.
+ *
+ * If the ijq parameter is NULL, false or NULL is returned and no critical 
+ * work is simulated.
+ */
+bool ipc_jobqueue_enqueue_deadline(ipc_jobqueue_t* ijq, deadline_job_t* job);
+deadline_job_t* ipc_jobqueue_dequeue_deadline(ipc_jobqueue_t* ijq, 
+    deadline_job_t* dst);
+deadline_job_t* ipc_jobqueue_peek_reachable(ipc_jobqueue_t* ijq, uint64_t now,
+    deadline_job_t* dst);
+deadline_job_t* ipc_jobqueue_dequeue_reachable(ipc_jobqueue_t* ijq, 
+    uint64_t now, deadline_job_t* dst);
+
+/*
+ * ipc_jobqueue_cancel(ipc_jobqueue_t* ijq, pid_t pid, unsigned int id)
+ * ipc_jobqueue_reprioritise(ipc_jobqueue_t* ijq, pid_t pid, unsigned int id,
+ *      unsigned int priority)
+ *
+ * These are wrappers for pri_jobqueue_cancel and pri_jobqueue_reprioritise.
+ *
+ * See their specifications in pri_jobqueue.h. The index of jobs is in the 
+ * shared memory of the queue, so any process that shares the queue can 
+ * cancel or reprioritise any queued job.
+ *
+ * If the ijq parameter is NULL, false is returned and no critical work is 
+ * simulated.
+ */
+bool ipc_jobqueue_cancel(ipc_jobqueue_t* ijq, pid_t pid, unsigned int id);
+bool ipc_jobqueue_reprioritise(ipc_jobqueue_t* ijq, pid_t pid, unsigned int id,
+    unsigned int priority);
+
 /*
  * ipc_jobqueue_is_empty(ipc_jobqueue_t* ijq)
  *
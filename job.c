@@ -6,10 +6,23 @@
 #include <string.h>
 #include <stdio.h>
 #include <errno.h>
+#include <time.h>
 #include "job.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* the pool selected by job_pool_use, NULL to use malloc and free */
+static job_pool_t* active_pool = NULL;
+
+static job_t* alloc_job(void) {
+    if (active_pool) return job_pool_get(active_pool);
+    return (job_t*) malloc(sizeof(job_t));
+}
+
 job_t* job_new(pid_t pid, unsigned int id, unsigned int priority, const char* label) {
-    return job_set((job_t*) malloc(sizeof(job_t)), pid, id, priority, label);
+    return job_set(alloc_job(), pid, id, priority, label);
 }
 
 job_t* job_copy(job_t* src, job_t* dst) {
@@ -21,7 +34,7 @@ job_t* job_copy(job_t* src, job_t* dst) {
         return dst;  
     }
     if (!dst) {
-        dst = (job_t*) malloc(sizeof(job_t));
+        dst = alloc_job();
         if (!dst) return NULL; 
     }
     dst->pid = src->pid;
@@ -41,6 +54,65 @@ void job_init(job_t* job) {
     job->label[MAX_NAME_SIZE - 1] = '\0';
 }
 
+/* 
+ * the number of jobs copied at a time by the batch functions, a block that
+ * stays in the L1 cache
+ */
+#define JOB_BLOCK 64
+
+/* copies jobs[0] to jobs[1] to jobs[n - 1] in blocks of up to JOB_BLOCK */
+static void replicate(job_t* jobs, int n) {
+    int block = 1;
+
+    while (block < n && block < JOB_BLOCK) {
+        int k = block < n - block ? block : n - block;
+        memcpy(jobs + block, jobs, k * sizeof(job_t));
+        block += k;
+    }
+    for (int done = block; done < n; done += block) {
+        int k = block < n - done ? block : n - done;
+        memcpy(jobs + done, jobs, k * sizeof(job_t));
+    }
+}
+
+void job_init_n(job_t* jobs, int n) {
+    if (!jobs || n < 1) return;
+
+    job_init(jobs);
+    replicate(jobs, n);
+}
+
+job_t* job_set_n(job_t* jobs, int n, pid_t pid, unsigned int id, 
+    unsigned int priority, const char* label) {
+    if (!jobs || n < 1) return NULL;
+
+    job_set(jobs, pid, id, priority, label);
+    replicate(jobs, n);
+    for (int i = 1; i < n; i++)
+        jobs[i].id = id + i;
+    return jobs;
+}
+
+int job_equal_n(job_t* jobs1, job_t* jobs2, int n) {
+    if (n < 1 || jobs1 == jobs2) return n < 1 ? 0 : n;
+    if (!jobs1 || !jobs2) return 0;
+
+    /* 
+     * blocks that are identical byte for byte are equal, a block that is not
+     * may still be equal if labels differ only after their terminating NUL
+     */
+    for (int done = 0; done < n; done += JOB_BLOCK) {
+        int k = JOB_BLOCK < n - done ? JOB_BLOCK : n - done;
+        if (memcmp(jobs1 + done, jobs2 + done, k * sizeof(job_t)) == 0)
+            continue;
+        for (int i = done; i < done + k; i++) {
+            if (!job_is_equal(&jobs1[i], &jobs2[i])) return i;
+        }
+    }
+
+    return n;
+}
+
 bool job_is_equal(job_t* j1, job_t* j2) {
     if (j1 == j2) return true;
     if (!j1 || !j2) return false;
@@ -70,42 +142,347 @@ job_t* job_set(job_t* job, pid_t pid, unsigned int id, unsigned int priority, co
     return job;
 }
 
+/* the number of decimal digits of v */
+static int digits(unsigned int v) {
+    int n = 1;
+    while (v >= 10) {
+        v /= 10;
+        n++;
+    }
+    return n;
+}
+
+/* 
+ * writes v in decimal, zero-padded to width characters after an optional 
+ * sign, as printf's %0<width>d or %0<width>u does, and returns the end
+ */
+static char* put_field(char* p, bool neg, unsigned int v, int width) {
+    int n = digits(v);
+    if (neg) {
+        *p++ = '-';
+        width--;
+    }
+    if (n < width) n = width;
+    for (char* q = p + n - 1; q >= p; q--) {
+        *q = '0' + v % 10;
+        v /= 10;
+    }
+    return p + n;
+}
+
+static char* put_literal(char* p, const char* s, int n) {
+    memcpy(p, s, n);
+    return p + n;
+}
+
+/*
+ * writes the string representation of job to buf, as snprintf with 
+ * JOB_STR_FMT would with unlimited room, and returns its length
+ */
+static int format_job(job_t* job, char* buf) {
+    bool neg = job->pid < 0;
+    unsigned int pid = neg ? 0u - (unsigned int) job->pid 
+        : (unsigned int) job->pid;
+    char* p = buf;
+
+    p = put_literal(p, "pid:", 4);
+    p = put_field(p, neg, pid, 7);
+    p = put_literal(p, ",id:", 4);
+    p = put_field(p, false, job->id, 5);
+    p = put_literal(p, ",pri:", 5);
+    p = put_field(p, false, job->priority, 5);
+    p = put_literal(p, ",label:", 7);
+    p = put_literal(p, job->label, MAX_NAME_SIZE - 1);
+    *p = '\0';
+
+    return p - buf;
+}
+
+/* the length of the longest string representation (10-digit fields) */
+#define JOB_STR_MAX (JOB_STR_SIZE - 1 + 4 + 5 + 5)
+
 char* job_to_str(job_t* job, char* str) {
     if (!job || strnlen(job->label, MAX_NAME_SIZE) != MAX_NAME_SIZE - 1) {
         return NULL;
     }
-    if (!str) {
+    bool allocated = !str;
+    if (allocated) {
         str = (char*) malloc(JOB_STR_SIZE);
         if (!str) return NULL;
     }
-    int ret = snprintf(str, JOB_STR_SIZE, JOB_STR_FMT, job->pid, job->id, job->priority, job->label);
-    if (ret < 0 || ret >= JOB_STR_SIZE) {
-        if (!str) free(str);
-        return NULL;
+
+    /* 
+     * the common case, in which every field fits its width, is written in 
+     * place, otherwise str is left truncated as snprintf leaves it
+     */
+    if (job->pid >= -999999 && job->pid <= 9999999 && job->id <= 99999
+        && job->priority <= 99999) {
+        format_job(job, str);
+        return str;
     }
-    return str;
+
+    char buf[JOB_STR_MAX + 1];
+    format_job(job, buf);
+    memcpy(str, buf, JOB_STR_SIZE - 1);
+    str[JOB_STR_SIZE - 1] = '\0';
+
+    if (allocated) free(str);
+    return NULL;
+}
+
+/* 
+ * The fixed layout of a job string: the literals of JOB_STR_FMT with a '0'
+ * in place of each digit of the pid, id and priority fields, followed by
+ * the MAX_NAME_SIZE - 1 characters of the label. The pid field may instead 
+ * be a '-' and 6 digits.
+ */
+static const char str_layout[] = "pid:0000000,id:00000,pri:00000,label:";
+
+#define STR_PID 4
+#define STR_ID 15
+#define STR_PRI 25
+#define STR_LABEL ((int) sizeof(str_layout) - 1)
+
+#if defined(__SSE2__)
+/* 0xff at the digit positions of str_layout */
+static const unsigned char str_digits[STR_LABEL] = {
+    [4] = 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    [15] = 0xff, 0xff, 0xff, 0xff, 0xff,
+    [25] = 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+/* mask of the 16 characters of s at off that match str_layout */
+static int layout_mask(const char* s, int off) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (s + off));
+    __m128i literal = _mm_cmpeq_epi8(v, 
+        _mm_loadu_si128((const __m128i*) (str_layout + off)));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+        _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    digit = _mm_and_si128(digit, 
+        _mm_loadu_si128((const __m128i*) (str_digits + off)));
+    return _mm_movemask_epi8(_mm_or_si128(literal, digit));
+}
+
+/* mask of the 16 characters of s at off that are NUL or white space */
+static int space_mask(const char* s, int off) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (s + off));
+    __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_setzero_si128()),
+        _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+    __m128i control = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)),
+        _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1)));
+    return _mm_movemask_epi8(_mm_or_si128(space, control));
+}
+
+/* 
+ * whether the JOB_STR_SIZE - 1 characters of s follow the fixed layout, 
+ * with 16-byte overlapping loads that cover the fields and the label
+ */
+static bool valid_layout(const char* s) {
+    int pid_sign = (s[STR_PID] == '-') << STR_PID;
+
+    return (layout_mask(s, 0) | pid_sign) == 0xffff
+        && layout_mask(s, 16) == 0xffff
+        && layout_mask(s, STR_LABEL - 16) == 0xffff
+        && space_mask(s, STR_LABEL) == 0
+        && space_mask(s, JOB_STR_SIZE - 1 - 16) == 0;
+}
+#else
+static bool valid_layout(const char* s) {
+    for (int i = 0; i < STR_LABEL; i++) {
+        if (str_layout[i] == '0') {
+            if ((s[i] < '0' || s[i] > '9') && !(i == STR_PID && s[i] == '-'))
+                return false;
+        } else if (s[i] != str_layout[i]) {
+            return false;
+        }
+    }
+    for (int i = STR_LABEL; i < JOB_STR_SIZE - 1; i++) {
+        char c = s[i];
+        if (c == '\0' || c == ' ' || (c >= '\t' && c <= '\r')) return false;
+    }
+    return true;
+}
+#endif
+
+/* the value of the n digits at s */
+static unsigned int get_field(const char* s, int n) {
+    unsigned int v = 0;
+    for (int i = 0; i < n; i++)
+        v = v * 10 + (s[i] - '0');
+    return v;
 }
 
 job_t* str_to_job(char* str, job_t* job) {
-    if (!str || strnlen(str, JOB_STR_SIZE + 1) != JOB_STR_SIZE - 1) return NULL;
+    if (!str || strnlen(str, JOB_STR_SIZE) != JOB_STR_SIZE - 1) return NULL;
+    if (!valid_layout(str)) return NULL;
+
     pid_t pid;
-    unsigned int id, priority;
-    char label[MAX_NAME_SIZE];
-    if (sscanf(str, JOB_STR_FMT, &pid, &id, &priority, label) != 4) {
-        return NULL;
+    if (str[STR_PID] == '-') {
+        pid = -(pid_t) get_field(str + STR_PID + 1, 6);
+        if (pid == 0) return NULL;      // -000000 is not written by job_to_str
+    } else {
+        pid = (pid_t) get_field(str + STR_PID, 7);
     }
+
     if (!job) {
-        job = (job_t*) malloc(sizeof(job_t));
+        job = alloc_job();
         if (!job) return NULL;
     }
     job->pid = pid;
-    job->id = id;
-    job->priority = priority;
-    strncpy(job->label, label, MAX_NAME_SIZE - 1);
-    job->label[MAX_NAME_SIZE - 1] = '\0';
+    job->id = get_field(str + STR_ID, 5);
+    job->priority = get_field(str + STR_PRI, 5);
+    memcpy(job->label, str + STR_LABEL, MAX_NAME_SIZE);
+    return job;
+}
+
+/* little-endian 32-bit field at b */
+static void put_le32(unsigned char* b, uint32_t v) {
+    b[0] = v & 0xff;
+    b[1] = (v >> 8) & 0xff;
+    b[2] = (v >> 16) & 0xff;
+    b[3] = (v >> 24) & 0xff;
+}
+
+static uint32_t get_le32(const unsigned char* b) {
+    return (uint32_t) b[0] | (uint32_t) b[1] << 8 | (uint32_t) b[2] << 16 
+        | (uint32_t) b[3] << 24;
+}
+
+/* offsets of the fields of the binary representation */
+#define BIN_PID 4
+#define BIN_ID 8
+#define BIN_PRI 12
+#define BIN_LABEL 16
+
+unsigned char* job_to_bin(job_t* job, unsigned char* bin) {
+    if (!job || strnlen(job->label, MAX_NAME_SIZE) != MAX_NAME_SIZE - 1) {
+        return NULL;
+    }
+    if (!bin) {
+        bin = (unsigned char*) malloc(JOB_BIN_SIZE);
+        if (!bin) return NULL;
+    }
+
+    bin[0] = JOB_BIN_VERSION;
+    bin[1] = bin[2] = bin[3] = 0;
+    put_le32(bin + BIN_PID, (uint32_t) job->pid);
+    put_le32(bin + BIN_ID, job->id);
+    put_le32(bin + BIN_PRI, job->priority);
+    memcpy(bin + BIN_LABEL, job->label, MAX_NAME_SIZE);
+    return bin;
+}
+
+job_t* bin_to_job(const unsigned char* bin, job_t* job) {
+    if (!bin || bin[0] != JOB_BIN_VERSION || bin[1] || bin[2] || bin[3]) {
+        return NULL;
+    }
+    const char* label = (const char*) bin + BIN_LABEL;
+    if (strnlen(label, MAX_NAME_SIZE) != MAX_NAME_SIZE - 1) return NULL;
+
+    if (!job) {
+        job = alloc_job();
+        if (!job) return NULL;
+    }
+    job->pid = (pid_t) get_le32(bin + BIN_PID);
+    job->id = get_le32(bin + BIN_ID);
+    job->priority = get_le32(bin + BIN_PRI);
+    memcpy(job->label, label, MAX_NAME_SIZE);
     return job;
 }
 
 void job_delete(job_t* job) {
-    if (job) free(job);
+    if (!job) return;
+
+    if (active_pool)
+        job_pool_put(active_pool, job);
+    else
+        free(job);
+}
+
+uint64_t job_clock_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+job_pool_t* job_pool_new(int capacity) {
+    if (capacity < 1) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    job_pool_t* pool = (job_pool_t*) malloc(sizeof(job_pool_t));
+    if (!pool) return NULL;
+
+    pool->slab = (job_t*) malloc(capacity * sizeof(job_t));
+    pool->free_jobs = (job_t**) malloc(capacity * sizeof(job_t*));
+    if (!pool->slab || !pool->free_jobs) {
+        free(pool->slab);
+        free(pool->free_jobs);
+        free(pool);
+        return NULL;
+    }
+
+    pool->capacity = capacity;
+    pool->nfree = capacity;
+    memset(&pool->stats, 0, sizeof(pool->stats));
+
+    /* stacked so that the first jobs of the slab are used first */
+    for (int i = 0; i < capacity; i++)
+        pool->free_jobs[i] = &pool->slab[capacity - 1 - i];
+
+    return pool;
+}
+
+job_pool_t* job_pool_use(job_pool_t* pool) {
+    job_pool_t* previous = active_pool;
+    active_pool = pool;
+    return previous;
+}
+
+job_t* job_pool_get(job_pool_t* pool) {
+    if (!pool) return NULL;
+
+    pool->stats.gets++;
+
+    if (pool->nfree > 0) {
+        pool->stats.hits++;
+        return pool->free_jobs[--pool->nfree];
+    }
+
+    pool->stats.misses++;
+    return (job_t*) malloc(sizeof(job_t));
+}
+
+void job_pool_put(job_pool_t* pool, job_t* job) {
+    if (!pool || !job) return;
+
+    pool->stats.puts++;
+
+    if (job_pool_owns(pool, job))
+        pool->free_jobs[pool->nfree++] = job;
+    else
+        free(job);
+}
+
+bool job_pool_owns(job_pool_t* pool, job_t* job) {
+    if (!pool || !job) return false;
+    return job >= pool->slab && job < pool->slab + pool->capacity;
+}
+
+job_pool_stats_t* job_pool_stats(job_pool_t* pool, job_pool_stats_t* stats) {
+    if (!pool || !stats) return NULL;
+
+    *stats = pool->stats;
+    return stats;
+}
+
+void job_pool_delete(job_pool_t* pool) {
+    if (!pool) return;
+
+    if (active_pool == pool) active_pool = NULL;
+
+    free(pool->slab);
+    free(pool->free_jobs);
+    free(pool);
 }
@@ -2,6 +2,7 @@
 #ifndef _JOB_H
 #define _JOB_H
 #include <stdbool.h>
+#include <stdint.h>
 #include <unistd.h>
 #include "sim_config.h"
 
@@ -14,6 +15,13 @@
 /* JOB_STR_FMT - string format for the string representation of a job */
 #define JOB_STR_FMT "pid:%07d,id:%05u,pri:%05u,label:%31s"
 
+/* 
+ * JOB_BIN_SIZE - the size of the binary representation of a job, which is 
+ * versioned by its first byte (JOB_BIN_VERSION for the current layout)
+ */
+#define JOB_BIN_SIZE 48
+#define JOB_BIN_VERSION 1
+
 /* A string of PAD characters of length 31 (MAX_NAME_SIZE - 1) */
 #define PAD_STRING "*******************************"
 
@@ -56,15 +64,63 @@
  *          const char* label)
  *      job_to_str(job_t* job, char* str)
  *      str_to_job(char* str, job_t* job)
+ *      job_to_bin(job_t* job, unsigned char* bin)
+ *      bin_to_job(const unsigned char* bin, job_t* job)
  *      job_delete(job_t* job)
+ *      job_init_n(job_t* jobs, int n)
+ *      job_set_n(job_t* jobs, int n, pid_t pid, unsigned int id, 
+ *          unsigned int priority, const char* label)
+ *      job_equal_n(job_t* jobs1, job_t* jobs2, int n)
  * provide the operations on a job_t to create, set and initialise a job, 
  * to copy from one job to another, to compare two jobs, to convert a job to
- * and from the string representation defined by JOB_STR_FMT, and to deallocate 
- * memory allocated by job_new.
+ * and from the string representation defined by JOB_STR_FMT and the binary
+ * representation described below, and to deallocate memory allocated by 
+ * job_new. The _n functions initialise, set and compare arrays of jobs with
+ * block copies and compares rather than a call per job.
+ *
+ * BINARY REPRESENTATION
+ *
+ * The binary representation of a job is a record of JOB_BIN_SIZE bytes for
+ * logs and snapshots that are read by programs rather than people. Its 
+ * layout is the same on every host:
+ *      offset  size    field
+ *      0       1       version, JOB_BIN_VERSION
+ *      1       3       reserved, 0
+ *      4       4       pid, little-endian two's complement
+ *      8       4       id, little-endian
+ *      12      4       priority, little-endian
+ *      16      32      label, MAX_NAME_SIZE - 1 characters and a NUL
+ * The jobconv program converts files of binary records to text (one string
+ * representation per line, as in a joblog) and back.
+ *
+ * JOB POOLS
+ *
+ * By default, the functions that dynamically allocate a job (job_new, and 
+ * job_copy, str_to_job and bin_to_job with a NULL destination) use malloc 
+ * and job_delete uses free. A process can instead opt in to a job pool 
+ * (job_pool_t), a slab of jobs allocated once, from which jobs are taken 
+ * and to which they are returned in constant time without calls to malloc
+ * or free:
+ *      job_pool_new(int capacity)
+ *      job_pool_use(job_pool_t* pool)
+ *      job_pool_get(job_pool_t* pool)
+ *      job_pool_put(job_pool_t* pool, job_t* job)
+ *      job_pool_owns(job_pool_t* pool, job_t* job)
+ *      job_pool_stats(job_pool_t* pool, job_pool_stats_t* stats)
+ *      job_pool_delete(job_pool_t* pool)
+ * Other libraries that allocate jobs with job_new, such as pri_jobqueue_peek
+ * and pri_jobqueue_dequeue with a NULL dst, use the pool of the process too.
+ *
+ * DEADLINE JOBS
+ *
+ * A deadline_job_t extends a job with an absolute deadline, for queues that
+ * order jobs by earliest deadline (see pri_jobqueue_set_order). Deadlines 
+ * are in milliseconds of the clock given by job_clock_ms, which is the same
+ * for all processes of a host. JOB_NO_DEADLINE is later than any deadline.
  * 
- * job_new, job_copy, job_init, job_set, job_to_str and str_to_job functions 
- * all guarantee that the label field will be a string of length 
- * MAX_NAME_SIZE - 1. 
+ * job_new, job_copy, job_init, job_set, job_to_str, str_to_job, job_to_bin 
+ * and bin_to_job functions all guarantee that the label field will be a 
+ * string of length MAX_NAME_SIZE - 1. 
  * An initialised job will have the PAD_STRING for its label, which is also 
  * used to represent an empty label.
  *
@@ -88,6 +144,50 @@ typedef struct job {
     char label[MAX_NAME_SIZE];
 } job_t;
 
+/*
+ * Definition of struct deadline_job - a job and the time by which it should
+ * be done, in milliseconds of job_clock_ms (JOB_NO_DEADLINE if there is no 
+ * such time).
+ *
+ * Type alias:
+ * A struct deadline_job can also be referred to as deadline_job_t
+ */
+typedef struct deadline_job {
+    job_t job;
+    uint64_t deadline;
+} deadline_job_t;
+
+#define JOB_NO_DEADLINE UINT64_MAX
+
+/*
+ * Definition of struct job_pool - a slab of capacity jobs and a stack of the
+ * free jobs of the slab, with counters of its use.
+ *
+ * Fields:
+ * slab - the jobs of the pool
+ * free_jobs - a stack of pointers to the jobs of the slab that are not in use
+ * capacity - the number of jobs in the slab
+ * nfree - the number of pointers on the free_jobs stack
+ * stats - counters of the use of the pool (see job_pool_stats_t)
+ *
+ * Note fields of the struct should only be accessed in the implementation 
+ * file job.c. Use job_pool functions to operate on a job pool.
+ */
+typedef struct job_pool_stats {
+    unsigned long gets;
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long puts;
+} job_pool_stats_t;
+
+typedef struct job_pool {
+    job_t* slab;
+    job_t** free_jobs;
+    int capacity;
+    int nfree;
+    job_pool_stats_t stats;
+} job_pool_t;
+
 /*
  * job_new(pid_t pid, unsigned int id, unsigned int priority, const char* label)
  * 
@@ -216,6 +316,41 @@ job_t* job_copy(job_t* src, job_t* dst);
  */
 void job_init(job_t* job);
 
+/*
+ * job_init_n(job_t* jobs, int n)
+ *
+ * Initialises the n jobs of the array jobs as job_init does. If jobs is NULL
+ * or n is less than 1, this function has no effect.
+ */
+void job_init_n(job_t* jobs, int n);
+
+/*
+ * job_set_n(job_t* jobs, int n, pid_t pid, unsigned int id, 
+ *      unsigned int priority, const char* label)
+ *
+ * Sets the n jobs of the array jobs as job_set does, with consecutive ids 
+ * from id. That is, jobs[i] is set as by job_set(&jobs[i], pid, id + i, 
+ * priority, label).
+ *
+ * Return:
+ * jobs, or NULL if jobs is NULL or n is less than 1.
+ */
+job_t* job_set_n(job_t* jobs, int n, pid_t pid, unsigned int id, 
+    unsigned int priority, const char* label);
+
+/*
+ * job_equal_n(job_t* jobs1, job_t* jobs2, int n)
+ *
+ * Compares the first n jobs of the arrays jobs1 and jobs2 pairwise, as 
+ * job_is_equal does.
+ *
+ * Return:
+ * The index of the first pair of jobs that are not equal, or n if all n 
+ * pairs are equal (0 if n is less than 1). If one of jobs1 and jobs2 is NULL
+ * (and n is at least 1), 0 is returned.
+ */
+int job_equal_n(job_t* jobs1, job_t* jobs2, int n);
+
 /*
  * job_is_equal(job_t* j1, job_t* j2)
  * 
@@ -303,7 +438,14 @@ job_t* job_set(job_t* job, pid_t pid, unsigned int id, unsigned int priority,
  * Errors:
  * If the call fails, the NULL pointer will be returned.  In particular, 
  * NULL is returned if length of job->label is not MAX_NAME_SIZE - 1.
- * If str is NULL, the function may fail because of a failure of dynamic 
+ * NULL is also returned if a field has more digits than its width in
+ * JOB_STR_FMT (a negative pid less than -999999, or a pid, id or priority
+ * greater than 9999999, 99999 and 99999 respectively), so that the string
+ * representation would be longer than JOB_STR_SIZE - 1. In that case a
+ * non-NULL str holds the representation truncated to JOB_STR_SIZE - 1
+ * characters, exactly as snprintf(str, JOB_STR_SIZE, JOB_STR_FMT, ...)
+ * would leave it.
+ * If str is NULL, the function may fail because of a failure of dynamic
  * allocation and return NULL.
  */
 char* job_to_str(job_t* job, char* str);
@@ -345,11 +487,54 @@ char* job_to_str(job_t* job, char* str);
  * NULL is returned if str is not in the correct format (e.g. is an invalid
  * length, or scanning for the representation of the fields of a job fails, 
  * or the resulting job label is an invalid length).
+ * The format is checked strictly, at the fixed offsets of the fields: the
+ * strings that are converted are exactly those that job_to_str produces.
+ * Each field must be all digits (the pid may be a '-' and 6 digits) and the
+ * label must not contain white space, so variants that sscanf with
+ * JOB_STR_FMT would accept (such as a field with a leading '+' or space)
+ * are rejected.
  * If job is NULL, the function may fail because of a failure of dynamic
  * allocation and return NULL.
  */
 job_t* str_to_job(char* str, job_t* job);
 
+/*
+ * job_to_bin(job_t* job, unsigned char* bin)
+ *
+ * Convert the given job to its binary representation of JOB_BIN_SIZE bytes
+ * (see BINARY REPRESENTATION above).
+ *
+ * Parameters:
+ * job - a non-NULL pointer to the job to convert. If the length of the job 
+ *      label is not exactly MAX_NAME_SIZE - 1 there is no conversion and 
+ *      NULL is returned.
+ * bin - a pointer to a buffer of at least JOB_BIN_SIZE bytes. If bin is 
+ *      NULL, a buffer of JOB_BIN_SIZE bytes is dynamically allocated.
+ *
+ * Return:
+ * On success: a pointer to the binary representation (bin if bin is not 
+ * NULL, otherwise the new buffer).
+ * On failure: the NULL pointer, if job is NULL, its label is not length
+ * MAX_NAME_SIZE - 1 or a buffer cannot be allocated.
+ */
+unsigned char* job_to_bin(job_t* job, unsigned char* bin);
+
+/*
+ * bin_to_job(const unsigned char* bin, job_t* job)
+ *
+ * Convert the given binary representation of a job to a job. If job is NULL,
+ * the memory for the job is dynamically allocated.
+ *
+ * Return:
+ * On success: a pointer to the job (job if job is not NULL, otherwise the 
+ * new job).
+ * On failure: the NULL pointer, if bin is NULL, its version is not 
+ * JOB_BIN_VERSION, its reserved bytes are not 0, its label is not 
+ * MAX_NAME_SIZE - 1 characters followed by a NUL or a job cannot be 
+ * allocated.
+ */
+job_t* bin_to_job(const unsigned char* bin, job_t* job);
+
 /*
  * job_delete(job_t* job);
  * 
@@ -365,4 +550,114 @@ job_t* str_to_job(char* str, job_t* job);
  */
 void job_delete(job_t* job);
 
+/*
+ * job_clock_ms()
+ *
+ * Returns the current time of the clock of job deadlines, in milliseconds 
+ * since an arbitrary fixed point. The clock is monotonic (CLOCK_MONOTONIC) 
+ * and is shared by the processes of a host.
+ *
+ * Usage:
+ *      deadline_job_t dj;
+ *      job_set(&dj.job, getpid(), 1, 2, "report");
+ *      dj.deadline = job_clock_ms() + 500;    // due in half a second
+ */
+uint64_t job_clock_ms(void);
+
+/*
+ * job_pool_new(int capacity)
+ *
+ * Creates a new job pool with a slab of capacity jobs. The pool is not used
+ * by the job functions until it is selected with job_pool_use.
+ *
+ * Usage:
+ *      job_pool_t* pool = job_pool_new(64);
+ *      job_pool_use(pool);             // job_new etc. now take from pool
+ *      ...
+ *      job_t* j = pri_jobqueue_peek(pjq, NULL);    // no malloc
+ *      ...
+ *      job_delete(j);                  // returned to pool, no free
+ *      ...
+ *      job_pool_use(NULL);             // back to malloc and free
+ *      job_pool_delete(pool);
+ *
+ * Parameters:
+ * capacity - the number of jobs in the slab, at least 1
+ *
+ * Return:
+ * On success: a pointer to the new pool, use job_pool_delete to free it.
+ * On failure: NULL, errno is set to EINVAL if capacity is less than 1 or as 
+ * specified for malloc.
+ */
+job_pool_t* job_pool_new(int capacity);
+
+/*
+ * job_pool_use(job_pool_t* pool)
+ *
+ * Selects the pool that job_new, job_copy, str_to_job and job_delete use to 
+ * allocate and deallocate jobs in the calling process. If pool is NULL, 
+ * those functions use malloc and free.
+ *
+ * A job must be deleted while the pool it came from is selected (or be 
+ * returned with job_pool_put). Job pools are not thread-safe.
+ *
+ * Return:
+ * The previously selected pool, or NULL if there was none.
+ */
+job_pool_t* job_pool_use(job_pool_t* pool);
+
+/*
+ * job_pool_get(job_pool_t* pool)
+ *
+ * Takes a job from the pool in constant time. If every job of the slab is in
+ * use, a job is allocated with malloc instead and counted as a miss. The 
+ * fields of the returned job are not set.
+ *
+ * Return:
+ * A pointer to a job, or NULL if pool is NULL or malloc fails.
+ */
+job_t* job_pool_get(job_pool_t* pool);
+
+/*
+ * job_pool_put(job_pool_t* pool, job_t* job)
+ *
+ * Returns a job taken with job_pool_get to the pool in constant time. A job
+ * that the pool does not own (one that was allocated by malloc when the slab
+ * was exhausted) is freed. If job is NULL this function has no effect.
+ *
+ * It is an error to put a job that is not in use or was not taken from pool.
+ */
+void job_pool_put(job_pool_t* pool, job_t* job);
+
+/*
+ * job_pool_owns(job_pool_t* pool, job_t* job)
+ *
+ * Returns true if job is one of the jobs of the slab of pool.
+ */
+bool job_pool_owns(job_pool_t* pool, job_t* job);
+
+/*
+ * job_pool_stats(job_pool_t* pool, job_pool_stats_t* stats)
+ *
+ * Copies the counters of the pool to stats:
+ *      gets - the number of jobs taken from the pool
+ *      hits - the number of those that came from the slab
+ *      misses - the number that were allocated by malloc instead, gets is
+ *          always hits + misses and the hit rate is hits / gets
+ *      puts - the number of jobs returned to the pool
+ *
+ * Return:
+ * stats, or NULL if pool or stats is NULL
+ */
+job_pool_stats_t* job_pool_stats(job_pool_t* pool, job_pool_stats_t* stats);
+
+/*
+ * job_pool_delete(job_pool_t* pool)
+ *
+ * Deletes a pool and its slab. If the pool is selected, the job functions 
+ * revert to malloc and free. Jobs of the slab that are still in use become 
+ * invalid. If pool is NULL this function has no effect.
+ */
+void job_pool_delete(job_pool_t* pool);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,95 @@
+/* This application converts a log of jobs between the text representation
+ * (a line per job, see JOB_STR_FMT in job.h) and the binary representation
+ * (a record of JOB_BIN_SIZE bytes per job, see job_to_bin in job.h).
+ * Usage:
+ *      ./jobconv -b|-t [infile [outfile]]
+ * where -b converts a text log to binary and -t a binary log to text. The
+ * standard input and output are used if files are not given. Conversion
+ * stops at the first invalid entry, with the number of the entry reported.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "job.h"
+
+/* text to binary, returns the number of jobs or -1 at an invalid entry */
+static long to_bin(FILE* in, FILE* out) {
+    char line[JOB_STR_SIZE + 1];    // a job string and its newline
+    unsigned char bin[JOB_BIN_SIZE];
+    job_t job;
+    long n = 0;
+
+    while (fgets(line, sizeof(line), in)) {
+        line[strcspn(line, "\n")] = '\0';
+        if (!str_to_job(line, &job)) {
+            fprintf(stderr, "jobconv: invalid text entry %ld\n", n);
+            return -1;
+        }
+        if (fwrite(job_to_bin(&job, bin), JOB_BIN_SIZE, 1, out) != 1) {
+            perror("jobconv");
+            return -1;
+        }
+        n++;
+    }
+
+    return n;
+}
+
+/* binary to text, returns the number of jobs or -1 at an invalid entry */
+static long to_text(FILE* in, FILE* out) {
+    unsigned char bin[JOB_BIN_SIZE];
+    char str[JOB_STR_SIZE];
+    job_t job;
+    long n = 0;
+    size_t r;
+
+    while ((r = fread(bin, 1, JOB_BIN_SIZE, in)) == JOB_BIN_SIZE) {
+        if (!bin_to_job(bin, &job) || !job_to_str(&job, str)) {
+            fprintf(stderr, "jobconv: invalid binary entry %ld\n", n);
+            return -1;
+        }
+        if (fprintf(out, "%s\n", str) < 0) {
+            perror("jobconv");
+            return -1;
+        }
+        n++;
+    }
+
+    if (r != 0) {
+        fprintf(stderr, "jobconv: truncated binary entry %ld\n", n);
+        return -1;
+    }
+
+    return n;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 4
+        || (strcmp(argv[1], "-b") != 0 && strcmp(argv[1], "-t") != 0)) {
+        printf("usage: %s -b|-t [infile [outfile]]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    bool binary = strcmp(argv[1], "-b") == 0;
+    FILE* in = stdin;
+    FILE* out = stdout;
+
+    if (argc > 2 && !(in = fopen(argv[2], binary ? "r" : "rb"))) {
+        perror(argv[2]);
+        exit(EXIT_FAILURE);
+    }
+    if (argc > 3 && !(out = fopen(argv[3], binary ? "wb" : "w"))) {
+        perror(argv[3]);
+        exit(EXIT_FAILURE);
+    }
+
+    long n = binary ? to_bin(in, out) : to_text(in, out);
+
+    if (fclose(out) != 0) {
+        perror("jobconv");
+        n = -1;
+    }
+    if (in != stdin) fclose(in);
+
+    return n < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -6,122 +6,1929 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include "joblog.h"
+#include "label_table.h"
 
-#define JOB_STR_SIZE 128
-#define MAX_NAME_SIZE 64
-
-typedef struct {
-    pid_t pid;
-    int id;
-    int priority;
-    char label[MAX_NAME_SIZE];
-} job_t;
-
-typedef struct {
-    pid_t pid;
-    int is_init;
-} proc_t;
-
-char* get_log_filename(proc_t* proc) {
-    static char log_fname[128];
-    if (proc->pid == 0) {
-        snprintf(log_fname, sizeof(log_fname), "./out/joblog_0.txt");
-    } else {
-        snprintf(log_fname, sizeof(log_fname), "./out/joblog_%d.txt", proc->pid);
+/* JOBLOG_NAME_SIZE - the size of a buffer for the file name of a log */
+#define JOBLOG_NAME_SIZE 128
+
+/* JOBLOG_HANDLES - the number of logs a process keeps open at a time */
+#define JOBLOG_HANDLES 8
+
+/* the size of a log entry, a job string and its new line */
+#define ENTRY_SIZE JOB_STR_SIZE
+
+/* JOBLOG_BATCH - the most entries the writer thread writes at a time */
+#define JOBLOG_BATCH 256
+
+/* JOBLOG_PENDING - the most segments waiting for the writer to compress */
+#define JOBLOG_PENDING 64
+
+/* the size of a record of the index of a segmented log */
+#define INDEX_RECORD sizeof(int64_t)
+
+/* the file name extensions of text and compressed segments */
+#define TEXT_EXT ".txt"
+#define COMPRESSED_EXT ".jlz"
+
+/* 
+ * A compressed segment is a header of JLZ_MAGIC, the number of entries and 
+ * the number of blocks (32-bit little endian) and the offset of each block
+ * and of the end of the file (64-bit little endian), followed by the blocks
+ * of up to BLOCK_ENTRIES entries each (see encode_block).
+ */
+#define JLZ_MAGIC "JLZ1"
+#define JLZ_HEADER 12
+#define BLOCK_ENTRIES 256
+
+/* the entries joblog_read_range reads from a text segment at a time */
+#define READ_CHUNK 4096
+
+/*
+ * The ring of jobs of an asynchronous log. The thread that logs to the log 
+ * pushes jobs at head and the writer thread writes them from tail, so each
+ * index is only advanced by one thread. The indices run freely and are 
+ * masked to a slot. The writer is woken when trigger jobs are waiting.
+ */
+typedef struct joblog_ring {
+    job_t* slots;
+    uint32_t mask;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t trigger;
+    int interval_ms;
+    joblog_full_t full;
+    long dropped;
+    bool failed;
+} joblog_ring_t;
+
+/*
+ * An open log of this process: the file descriptor of the log file and the
+ * entries that have been written by joblog_write but not yet to the file,
+ * either in the buffer or, for an asynchronous log, in the ring.
+ * The log is that of the process with the given id and type_label (see 
+ * new_log_name). A handle is free if its fd is -1.
+ * The file is synced as specified by sync and sync_n (see joblog_set_sync),
+ * unsynced entries having been written to it since it was last synced at 
+ * synced_ms. For an asynchronous log these are only used by the writer.
+ * The file of a segmented log is its last segment, with entries from 
+ * seg_first and seg_bytes long, rolled over at seg_cap bytes (0 if the log
+ * is not rolled over). For an unsegmented log, segment and seg_first are 0.
+ * If compress is true, a segment is queued for the writer thread to 
+ * compress when the log rolls over.
+ */
+typedef struct joblog_handle {
+    pid_t id;
+    char type_label[MAX_NAME_SIZE];
+    int fd;
+    char* buf;
+    size_t buf_size;
+    size_t used;
+    joblog_ring_t* ring;
+    joblog_sync_t sync;
+    int sync_n;
+    int unsynced;
+    long long synced_ms;
+    bool segmented;
+    int segment;
+    int seg_first;
+    off_t seg_bytes;
+    size_t seg_cap;
+    bool compress;
+} joblog_handle_t;
+
+/* 
+ * The mappings of the segments of a log for a cursor and its ranges, the
+ * entries of a segment being at positions from start of the cursor and 
+ * numbered in the log from first. The mapping of a compressed segment is
+ * of the whole file.
+ */
+struct joblog_maps {
+    int count;
+    struct {
+        const char* map;
+        size_t size;
+        int start;
+        int first;
+        int entries;
+        bool compressed;
+    } segs[];
+};
+
+static joblog_handle_t handles[JOBLOG_HANDLES];
+static bool handles_ready = false;
+static int next_victim = 0;
+
+/* A segment of a log to compress (see compress_segment). */
+typedef struct joblog_segment {
+    char type_label[MAX_NAME_SIZE];
+    pid_t id;
+    int segment;
+    bool sync;
+} joblog_segment_t;
+
+/*
+ * The writer thread holds writer_lock while it writes, and the ring of a 
+ * handle is only attached or detached with the lock held. writer_drained is
+ * signalled each time the writer has written a batch or compressed a 
+ * segment. Segments to compress are queued in pending, oldest first, and 
+ * the one being compressed, without the lock held, is compressing.
+ */
+static pthread_mutex_t writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writer_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t writer_drained = PTHREAD_COND_INITIALIZER;
+static bool writer_running = false;
+static joblog_segment_t pending[JOBLOG_PENDING];
+static int pending_count = 0;
+static joblog_segment_t compressing;
+static bool is_compressing = false;
+
+/* 
+ * the file name, with the given extension, of the given segment of the log
+ * with the given type_label and id, false if there is no such name
+ */
+static bool segment_name(const char* type_label, pid_t id, int segment, 
+    const char* ext, char* name) {
+    static const char* joblog_name_fmt = "%s/%.31s%07d%s";
+    static const char* segment_name_fmt = "%s/%.31s%07d.%06d%s";
+
+    int n = segment == 0
+        ? snprintf(name, JOBLOG_NAME_SIZE, joblog_name_fmt, JOBLOG_PATH,
+            type_label, id, ext)
+        : snprintf(name, JOBLOG_NAME_SIZE, segment_name_fmt, JOBLOG_PATH,
+            type_label, id, segment, ext);
+    return n > 0 && n < JOBLOG_NAME_SIZE;
+}
+
+/* the file name of the index of a log, false if there is no such name */
+static bool index_name(const char* type_label, pid_t id, char* name) {
+    static const char* index_name_fmt = "%s/%.31s%07d.idx";
+
+    int n = snprintf(name, JOBLOG_NAME_SIZE, index_name_fmt, JOBLOG_PATH,
+        type_label, id);
+    return n > 0 && n < JOBLOG_NAME_SIZE;
+}
+
+/* 
+ * a descriptor of the index of proc's log to read, -1 with errno ENOENT if 
+ * the log is not segmented
+ */
+static int open_index(proc_t* proc) {
+    char name[JOBLOG_NAME_SIZE];
+    if (!index_name(proc->type_label, proc->id, name)) return -1;
+    return open(name, O_RDONLY);
+}
+
+/* the number of segments in the index ifd */
+static int index_segments(int ifd) {
+    struct stat sb;
+    if (fstat(ifd, &sb) != 0) return -1;
+    return sb.st_size / INDEX_RECORD;
+}
+
+/* the first entry of the given segment in the index ifd, -1 on failure */
+static int index_first(int ifd, int segment) {
+    int64_t first;
+    if (pread(ifd, &first, INDEX_RECORD, (off_t) segment * INDEX_RECORD)
+        != (ssize_t) INDEX_RECORD) return -1;
+    return (int) first;
+}
+
+/* 
+ * the segment of the index ifd, of the given number of segments, that has
+ * the given entry, by binary search, or -1 on failure
+ */
+static int index_find(int ifd, int segments, int entry_num) {
+    int lo = 0;
+    int hi = segments - 1;
+
+    if (segments < 1) return -1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        int first = index_first(ifd, mid);
+        if (first < 0) return -1;
+        if (first <= entry_num) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
     }
+    return lo;
+}
 
-    return log_fname;
+/* writes all len bytes of buf, false on failure */
+static bool write_all(int fd, const char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t w = write(fd, buf, len);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        buf += w;
+        len -= w;
+    }
+    return true;
 }
 
-void joblog_write(proc_t* proc, job_t* job) {
-    if (proc == NULL || job == NULL) {
-        return;
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * counts entries just written to the file of h and syncs the file if its
+ * sync mode says it is due, or if force is true and there are unsynced 
+ * entries, false if the sync fails
+ */
+static bool sync_handle(joblog_handle_t* h, int entries, bool force) {
+    if (h->sync == JOBLOG_SYNC_NONE) return true;
+
+    h->unsynced += entries;
+    if (h->unsynced == 0) return true;
+
+    bool due = force || h->sync == JOBLOG_SYNC_EVERY
+        || (h->sync == JOBLOG_SYNC_RECORDS && h->unsynced >= h->sync_n)
+        || (h->sync == JOBLOG_SYNC_INTERVAL 
+            && now_ms() - h->synced_ms >= h->sync_n);
+    if (!due) return true;
+
+    h->unsynced = 0;
+    h->synced_ms = now_ms();
+    return fdatasync(h->fd) == 0;
+}
+
+static void put_le32(unsigned char* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (unsigned char) (v >> (8 * i));
+}
+
+static uint32_t get_le32(const unsigned char* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t) p[i] << (8 * i);
+    return v;
+}
+
+static void put_le64(unsigned char* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (unsigned char) (v >> (8 * i));
+}
+
+static uint64_t get_le64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t) p[i] << (8 * i);
+    return v;
+}
+
+/* appends v to p as a LEB128 varint, returning the end of the varint */
+static unsigned char* put_varint(unsigned char* p, uint64_t v) {
+    while (v >= 0x80) {
+        *p++ = (unsigned char) (v | 0x80);
+        v >>= 7;
     }
+    *p++ = (unsigned char) v;
+    return p;
+}
 
-    if (mkdir("./out", 0777) == -1 && errno != EEXIST) {
-        perror("Error creating log directory");
-        return;
+/* reads a varint from *p, before end, into *v, false if it is truncated */
+static bool get_varint(const unsigned char** p, const unsigned char* end, 
+    uint64_t* v) {
+    *v = 0;
+    for (int shift = 0; *p < end && shift < 64; shift += 7) {
+        unsigned char b = *(*p)++;
+        *v |= (uint64_t) (b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
     }
+    return false;
+}
 
-    FILE *log_file = fopen(get_log_filename(proc), "a");
-    if (log_file == NULL) {
-        perror("Error opening log file for writing");
-        return;
+/* zigzag encoding of a signed delta, so that small deltas are small */
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t) v << 1) ^ (uint64_t) (v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t) (v >> 1) ^ -(int64_t) (v & 1);
+}
+
+/* the most bytes encode_block writes for a block of n entries */
+static size_t block_bound(int n) {
+    return 10 + 3 + (size_t) n * (MAX_NAME_SIZE - 1 + 3 + 10 + 10 + 5);
+}
+
+/*
+ * Encodes the n (at most BLOCK_ENTRIES) entries of text to p as a block,
+ * returning the end of the block. A block is the varint count of entries, 
+ * the dictionary of its labels (their varint count, then each label of 
+ * MAX_NAME_SIZE - 1 characters) and the entries by column: the dictionary
+ * index of each label (the count of labels for a malformed entry), the 
+ * zigzag varint deltas of each pid and of each id from those of the entry
+ * before (from 0 for the first), and the varint priorities. lt is a table
+ * of BLOCK_ENTRIES labels that is emptied to build the dictionary.
+ */
+static unsigned char* encode_block(const char* text, int n, 
+    label_table_t* lt, unsigned char* p) {
+    job_t jobs[BLOCK_ENTRIES];
+    uint32_t labels[BLOCK_ENTRIES];
+    char entry[ENTRY_SIZE];
+
+    label_table_init(lt, BLOCK_ENTRIES);
+    for (int i = 0; i < n; i++, text += ENTRY_SIZE) {
+        memcpy(entry, text, ENTRY_SIZE);
+        labels[i] = LABEL_NONE;
+        if (entry[ENTRY_SIZE - 1] == '\n') {
+            entry[ENTRY_SIZE - 1] = '\0';
+            if (str_to_job(entry, &jobs[i])) 
+                labels[i] = label_table_intern(lt, jobs[i].label);
+        }
+        if (labels[i] == LABEL_NONE) job_init(&jobs[i]);
+    }
+
+    uint32_t count = (uint32_t) label_table_count(lt);
+    p = put_varint(p, n);
+    p = put_varint(p, count);
+    for (uint32_t l = 0; l < count; l++) {
+        memcpy(p, label_table_label(lt, l), MAX_NAME_SIZE - 1);
+        p += MAX_NAME_SIZE - 1;
     }
 
-    fprintf(log_file, "pid:%07d,id:%05d,pri:%05d,label:%-*s\n",
-            proc->pid, job->id, job->priority, MAX_NAME_SIZE - 1, job->label);
+    for (int i = 0; i < n; i++)
+        p = put_varint(p, labels[i] == LABEL_NONE ? count : labels[i]);
+    for (int i = 0; i < n; i++)
+        p = put_varint(p, zigzag((int64_t) jobs[i].pid 
+            - (i > 0 ? jobs[i - 1].pid : 0)));
+    for (int i = 0; i < n; i++)
+        p = put_varint(p, zigzag((int64_t) jobs[i].id 
+            - (i > 0 ? jobs[i - 1].id : 0)));
+    for (int i = 0; i < n; i++)
+        p = put_varint(p, jobs[i].priority);
 
-    fclose(log_file);
+    return p;
 }
 
-job_t* joblog_read(proc_t* proc, int entry_num, job_t* job) {
-    if (proc == NULL || entry_num < 0 || job == NULL) {
-        return NULL;
+/*
+ * Decodes the block of len bytes at p into jobs, with valid[i] false for
+ * a malformed entry, returning the number of entries, or -1 if the block 
+ * is corrupt.
+ */
+static int decode_block(const unsigned char* p, size_t len, job_t* jobs, 
+    bool* valid) {
+    const unsigned char* end = p + len;
+    uint64_t n;
+    uint64_t count;
+    uint64_t v;
+
+    if (!get_varint(&p, end, &n) || n > BLOCK_ENTRIES
+        || !get_varint(&p, end, &count) || count > n
+        || (size_t) (end - p) < count * (MAX_NAME_SIZE - 1))
+        return -1;
+
+    const unsigned char* labels = p;
+    p += count * (MAX_NAME_SIZE - 1);
+
+    for (uint64_t i = 0; i < n; i++) {
+        if (!get_varint(&p, end, &v) || v > count) return -1;
+        valid[i] = v < count;
+        if (valid[i]) {
+            memcpy(jobs[i].label, labels + v * (MAX_NAME_SIZE - 1), 
+                MAX_NAME_SIZE - 1);
+            jobs[i].label[MAX_NAME_SIZE - 1] = '\0';
+        }
+    }
+    int64_t prev = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        if (!get_varint(&p, end, &v)) return -1;
+        prev += unzigzag(v);
+        jobs[i].pid = (pid_t) prev;
+    }
+    prev = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        if (!get_varint(&p, end, &v)) return -1;
+        prev += unzigzag(v);
+        jobs[i].id = (unsigned int) prev;
+    }
+    for (uint64_t i = 0; i < n; i++) {
+        if (!get_varint(&p, end, &v)) return -1;
+        jobs[i].priority = (unsigned int) v;
+    }
+    for (uint64_t i = 0; i < n; i++) {
+        if (!valid[i]) job_init(&jobs[i]);
     }
 
-    FILE *log_file = fopen(get_log_filename(proc), "r");
-    if (log_file == NULL) {
-        perror("Error opening log file for reading");
-        return NULL;
+    return (int) n;
+}
+
+/*
+ * Compresses the given text segment of the log with the given type_label
+ * and id: the compressed segment is written, synced if sync is true, and 
+ * renamed into place before the text segment is removed, so that readers 
+ * always find one of them. False on failure, with the text segment kept.
+ */
+static bool compress_segment(const char* type_label, pid_t id, int segment,
+    bool sync) {
+    char text_name[JOBLOG_NAME_SIZE];
+    char name[JOBLOG_NAME_SIZE];
+    char tmp_name[JOBLOG_NAME_SIZE + 4];
+    struct stat sb;
+
+    if (!segment_name(type_label, id, segment, TEXT_EXT, text_name)
+        || !segment_name(type_label, id, segment, COMPRESSED_EXT, name))
+        return false;
+    snprintf(tmp_name, sizeof(tmp_name), "%s.tmp", name);
+
+    int fd = open(text_name, O_RDONLY);
+    if (fd < 0) return false;
+    if (fstat(fd, &sb) != 0) {
+        close(fd);
+        return false;
+    }
+
+    int entries = sb.st_size / ENTRY_SIZE;
+    int blocks = (entries + BLOCK_ENTRIES - 1) / BLOCK_ENTRIES;
+    size_t table = JLZ_HEADER + (size_t) (blocks + 1) * 8;
+    char* text = entries > 0 ? mmap(NULL, (size_t) entries * ENTRY_SIZE, 
+        PROT_READ, MAP_SHARED, fd, 0) : NULL;
+    unsigned char* out = malloc(table + blocks * block_bound(BLOCK_ENTRIES));
+    label_table_t* lt = label_table_new(BLOCK_ENTRIES);
+    close(fd);
+    if (text == MAP_FAILED || !out || !lt) {
+        if (text && text != MAP_FAILED) 
+            munmap(text, (size_t) entries * ENTRY_SIZE);
+        free(out);
+        label_table_delete(lt);
+        return false;
+    }
+
+    memcpy(out, JLZ_MAGIC, 4);
+    put_le32(out + 4, entries);
+    put_le32(out + 8, blocks);
+    unsigned char* p = out + table;
+    for (int b = 0; b < blocks; b++) {
+        int first = b * BLOCK_ENTRIES;
+        int n = entries - first < BLOCK_ENTRIES ? entries - first 
+            : BLOCK_ENTRIES;
+        put_le64(out + JLZ_HEADER + b * 8, p - out);
+        p = encode_block(text + (size_t) first * ENTRY_SIZE, n, lt, p);
+    }
+    put_le64(out + JLZ_HEADER + blocks * 8, p - out);
+    if (text) munmap(text, (size_t) entries * ENTRY_SIZE);
+    label_table_delete(lt);
+
+    bool ok = false;
+    fd = open(tmp_name, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd >= 0) {
+        ok = write_all(fd, (const char*) out, p - out) 
+            && (!sync || fdatasync(fd) == 0);
+        close(fd);
+        ok = ok && rename(tmp_name, name) == 0;
+        if (!ok) unlink(tmp_name);
+    }
+    free(out);
+
+    return ok && unlink(text_name) == 0;
+}
+
+/* 
+ * queues the given segment of the log of h for the writer thread to 
+ * compress, with writer_lock held. The segment is kept as text if the
+ * queue is full.
+ */
+static void queue_compression(joblog_handle_t* h, int segment) {
+    if (pending_count == JOBLOG_PENDING) return;
+
+    joblog_segment_t* s = &pending[pending_count++];
+    memcpy(s->type_label, h->type_label, MAX_NAME_SIZE);
+    s->id = h->id;
+    s->segment = segment;
+    s->sync = h->sync != JOBLOG_SYNC_NONE;
+    pthread_cond_signal(&writer_wake);
+}
+
+/* 
+ * starts a new segment of the segmented log of h after its last segment, 
+ * queueing the last segment for compression if h is compressing, false on
+ * failure
+ */
+static bool roll_over(joblog_handle_t* h) {
+    char name[JOBLOG_NAME_SIZE];
+    int64_t first = h->seg_first + h->seg_bytes / ENTRY_SIZE;
+
+    /* the index records the segment before it is created */
+    if (!index_name(h->type_label, h->id, name)) return false;
+    int ifd = open(name, O_WRONLY | O_APPEND);
+    if (ifd < 0) return false;
+    bool ok = write_all(ifd, (const char*) &first, INDEX_RECORD)
+        && (h->sync == JOBLOG_SYNC_NONE || fdatasync(ifd) == 0);
+    close(ifd);
+    if (!ok) return false;
+
+    int fd = -1;
+    if (segment_name(h->type_label, h->id, h->segment + 1, TEXT_EXT, name))
+        fd = open(name, O_RDWR | O_APPEND | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) return false;
+
+    /* 
+     * the new segment takes over the descriptor of the old, since 
+     * find_handle reads h->fd without writer_lock
+     */
+    sync_handle(h, 0, true);
+    bool moved = dup2(fd, h->fd) >= 0;
+    close(fd);
+    if (!moved) return false;
+    h->segment++;
+    h->seg_first = (int) first;
+    h->seg_bytes = 0;
+
+    /* 
+     * not here, where joblog_write would wait for it, but by the writer. 
+     * Only the writer writes an asynchronous log, with the lock held.
+     */
+    if (h->compress) {
+        if (!h->ring) pthread_mutex_lock(&writer_lock);
+        queue_compression(h, h->segment - 1);
+        if (!h->ring) pthread_mutex_unlock(&writer_lock);
+    }
+    return true;
+}
+
+/* 
+ * writes len bytes of whole entries from buf to the log of h, rolling over
+ * to new segments as they fill, false on failure
+ */
+static bool write_entries(joblog_handle_t* h, const char* buf, size_t len) {
+    bool ok = true;
+
+    while (len > 0) {
+        size_t n = len;
+        if (h->seg_cap > 0) {
+            size_t room = (off_t) h->seg_cap > h->seg_bytes 
+                ? (h->seg_cap - h->seg_bytes) / ENTRY_SIZE * ENTRY_SIZE : 0;
+            if (room == 0) {
+                if (!roll_over(h)) return false;
+                room = h->seg_cap;
+            }
+            if (n > room) n = room;
+        }
+
+        if (!write_all(h->fd, buf, n)) return false;
+        h->seg_bytes += n;
+        ok = sync_handle(h, n / ENTRY_SIZE, false) && ok;
+        buf += n;
+        len -= n;
+    }
+    return ok;
+}
+
+static uint32_t ring_head(joblog_ring_t* r) {
+    return __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+}
+
+static uint32_t ring_tail(joblog_ring_t* r) {
+    return __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+}
+
+/* 
+ * writes the jobs waiting in the ring of h to its file, a batch at a time,
+ * with writer_lock held, false if there were none
+ */
+static bool drain_ring(joblog_handle_t* h) {
+    static char batch[JOBLOG_BATCH * ENTRY_SIZE];
+    joblog_ring_t* r = h->ring;
+    uint32_t tail = r->tail;
+    uint32_t head = ring_head(r);
+
+    if (tail == head) return false;
+
+    while (tail != head) {
+        size_t len = 0;
+        for (int n = 0; n < JOBLOG_BATCH && tail != head; n++, tail++) {
+            /* jobs with fields too large for an entry are not logged */
+            if (job_to_str(&r->slots[tail & r->mask], batch + len)) {
+                batch[len + ENTRY_SIZE - 1] = '\n';
+                len += ENTRY_SIZE;
+            }
+        }
+        if (!write_entries(h, batch, len)) r->failed = true;
+
+        __atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);
+        pthread_cond_broadcast(&writer_drained);
+        head = ring_head(r);
+    }
+    return true;
+}
+
+/*
+ * syncs the asynchronous log of h, with writer_lock held, if it is synced 
+ * by interval and its interval has passed with entries unsynced, and 
+ * returns the ms until it is next due, or 0 if it has no unsynced entries
+ */
+static int sync_interval(joblog_handle_t* h) {
+    if (h->sync != JOBLOG_SYNC_INTERVAL || h->unsynced == 0) return 0;
+
+    long long wait = h->synced_ms + h->sync_n - now_ms();
+    if (wait > 0) return (int) wait;
+
+    if (!sync_handle(h, 0, true)) h->ring->failed = true;
+    return 0;
+}
+
+/* 
+ * compresses the oldest queued segment, with writer_lock held but released
+ * while it compresses, so that the logs can be written meanwhile. The text
+ * segment is kept if it cannot be compressed.
+ */
+static void compress_pending(void) {
+    compressing = pending[0];
+    is_compressing = true;
+    memmove(pending, pending + 1, --pending_count * sizeof(pending[0]));
+
+    pthread_mutex_unlock(&writer_lock);
+    compress_segment(compressing.type_label, compressing.id, 
+        compressing.segment, compressing.sync);
+    pthread_mutex_lock(&writer_lock);
+
+    is_compressing = false;
+    pthread_cond_broadcast(&writer_drained);
+}
+
+/* 
+ * true if s is a segment of the log with the given type_label and id, or
+ * of any log if type_label is NULL
+ */
+static bool segment_of(joblog_segment_t* s, const char* type_label, 
+    pid_t id) {
+    return !type_label || (s->id == id 
+        && strncmp(s->type_label, type_label, MAX_NAME_SIZE) == 0);
+}
+
+/* 
+ * waits until no segment of the log with the given type_label and id (of 
+ * any log if type_label is NULL) is queued or being compressed
+ */
+static void wait_for_compression(const char* type_label, pid_t id) {
+    pthread_mutex_lock(&writer_lock);
+    for (;;) {
+        bool waiting = is_compressing 
+            && segment_of(&compressing, type_label, id);
+        for (int i = 0; i < pending_count && !waiting; i++)
+            waiting = segment_of(&pending[i], type_label, id);
+        if (!waiting) break;
+        pthread_cond_wait(&writer_drained, &writer_lock);
+    }
+    pthread_mutex_unlock(&writer_lock);
+}
+
+static void* writer_main(void* arg);
+
+/* 
+ * starts the writer thread if it is not running, with writer_lock held, 
+ * false with errno set on failure
+ */
+static bool start_writer(void) {
+    if (writer_running) return true;
+
+    pthread_t writer;
+    int e = pthread_create(&writer, NULL, writer_main, NULL);
+    if (e != 0) {
+        errno = e;
+        return false;
     }
+    pthread_detach(writer);
+    writer_running = true;
+    return true;
+}
+
+/*
+ * the writer thread: writes the rings of asynchronous logs, and syncs those
+ * synced by interval that are due, when it is woken or the shortest 
+ * interval of the logs, or time to the next sync, has passed, and then
+ * compresses queued segments, one at a time between writes
+ */
+static void* writer_main(void* arg) {
+    pthread_mutex_lock(&writer_lock);
+
+    for (;;) {
+        int interval_ms = 0;
+        for (int i = 0; i < JOBLOG_HANDLES; i++) {
+            joblog_ring_t* r = handles[i].ring;
+            if (!r) continue;
+
+            drain_ring(&handles[i]);
+            if (interval_ms == 0 || r->interval_ms < interval_ms)
+                interval_ms = r->interval_ms;
+
+            int due_ms = sync_interval(&handles[i]);
+            if (due_ms > 0 && due_ms < interval_ms)
+                interval_ms = due_ms;
+        }
+        pthread_cond_broadcast(&writer_drained);
+
+        if (pending_count > 0) {
+            compress_pending();
+            continue;
+        }
 
-    int line_num = 0;
-    char line[JOB_STR_SIZE];
-    while (fgets(line, sizeof(line), log_file)) {
-        if (line_num == entry_num) {
-            if (sscanf(line, "pid:%d,id:%d,pri:%d,label:%63s", 
-                       &job->pid, &job->id, &job->priority, job->label) != 4) {
-                fclose(log_file);
-                return NULL;
+        if (interval_ms == 0) {
+            pthread_cond_wait(&writer_wake, &writer_lock);
+        } else {
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_sec += interval_ms / 1000;
+            until.tv_nsec += (long) (interval_ms % 1000) * 1000000;
+            if (until.tv_nsec >= 1000000000) {
+                until.tv_sec++;
+                until.tv_nsec -= 1000000000;
             }
-            fclose(log_file);
-            return job;
+            pthread_cond_timedwait(&writer_wake, &writer_lock, &until);
         }
-        line_num++;
     }
 
-    fclose(log_file);
+    return arg;
+}
+
+/* waits, with writer_lock held, until the writer has written up to index */
+static void wait_for_writer(joblog_ring_t* r, uint32_t index) {
+    while ((int32_t) (index - ring_tail(r)) > 0) {
+        pthread_cond_signal(&writer_wake);
+        pthread_cond_wait(&writer_drained, &writer_lock);
+    }
+}
+
+/* 
+ * writes the buffered entries of h to its file, and syncs the file if 
+ * sync is true and it has unsynced entries
+ */
+static bool flush_handle(joblog_handle_t* h, bool sync) {
+    if (h->ring) {
+        pthread_mutex_lock(&writer_lock);
+        wait_for_writer(h->ring, h->ring->head);
+        bool ok = !h->ring->failed && sync_handle(h, 0, sync);
+        h->ring->failed = false;
+        pthread_mutex_unlock(&writer_lock);
+        return ok;
+    }
+    if (h->used == 0) return sync_handle(h, 0, sync);
+
+    bool ok = write_entries(h, h->buf, h->used);
+    ok = sync_handle(h, 0, sync) && ok;
+    h->used = 0;
+    return ok;
+}
+
+/* 
+ * makes the log of h synchronous again, discarding any jobs in its ring, 
+ * so the ring must be flushed first to keep them
+ */
+static void stop_async(joblog_handle_t* h) {
+    joblog_ring_t* r = h->ring;
+    if (!r) return;
+
+    pthread_mutex_lock(&writer_lock);
+    h->ring = NULL;
+    pthread_mutex_unlock(&writer_lock);
+
+    free(r->slots);
+    free(r);
+}
+
+/* releases h, flushing its entries first if flush is true */
+static void release_handle(joblog_handle_t* h, bool flush) {
+    if (h->fd < 0) return;
+
+    if (flush) flush_handle(h, true);
+    stop_async(h);
+    close(h->fd);
+    free(h->buf);
+    h->fd = -1;
+    h->buf = NULL;
+    h->buf_size = h->used = 0;
+}
+
+static void flush_at_exit(void) {
+    int saved_errno = errno;
+
+    for (int i = 0; i < JOBLOG_HANDLES; i++)
+        release_handle(&handles[i], true);
+    wait_for_compression(NULL, 0);
+
+    errno = saved_errno;
+}
+
+/* the writer is not in the middle of a write when a process forks */
+static void lock_at_fork(void) {
+    pthread_mutex_lock(&writer_lock);
+}
+
+static void unlock_at_fork(void) {
+    pthread_mutex_unlock(&writer_lock);
+}
+
+/* 
+ * a child process does not write the buffered entries of its parent, and 
+ * has no writer thread
+ */
+static void drop_at_fork(void) {
+    pthread_mutex_unlock(&writer_lock);
+    pthread_cond_init(&writer_wake, NULL);
+    pthread_cond_init(&writer_drained, NULL);
+    writer_running = false;
+    pending_count = 0;
+    is_compressing = false;
+
+    for (int i = 0; i < JOBLOG_HANDLES; i++)
+        release_handle(&handles[i], false);
+}
+
+static void init_handles(void) {
+    if (handles_ready) return;
+
+    for (int i = 0; i < JOBLOG_HANDLES; i++) {
+        handles[i].fd = -1;
+        handles[i].buf = NULL;
+        handles[i].buf_size = handles[i].used = 0;
+        handles[i].ring = NULL;
+    }
+    atexit(flush_at_exit);
+    pthread_atfork(lock_at_fork, unlock_at_fork, drop_at_fork);
+    handles_ready = true;
+}
+
+/* the open handle of proc's log, or NULL */
+static joblog_handle_t* find_handle(proc_t* proc) {
+    if (!handles_ready) return NULL;
+
+    for (int i = 0; i < JOBLOG_HANDLES; i++) {
+        joblog_handle_t* h = &handles[i];
+        if (h->fd >= 0 && h->id == proc->id 
+            && strncmp(h->type_label, proc->type_label, MAX_NAME_SIZE) == 0)
+            return h;
+    }
     return NULL;
 }
 
+/* the handle of proc's log, opened if it is not open */
+static joblog_handle_t* open_handle(proc_t* proc) {
+    joblog_handle_t* h = find_handle(proc);
+    if (h) return h;
+
+    char name[JOBLOG_NAME_SIZE];
+    struct stat sb;
+    int segment = 0;
+    int seg_first = 0;
+
+    /* a segmented log is written to its last segment */
+    int ifd = open_index(proc);
+    if (ifd >= 0) {
+        segment = index_segments(ifd) - 1;
+        seg_first = segment >= 0 ? index_first(ifd, segment) : -1;
+        close(ifd);
+        if (seg_first < 0) return NULL;
+    }
+    if (!segment_name(proc->type_label, proc->id, segment, TEXT_EXT, name)) 
+        return NULL;
+
+    init_handles();
+
+    int fd = open(name, O_RDWR | O_APPEND | O_CREAT, 0666);
+    if (fd < 0 && errno == ENOENT && mkdir(JOBLOG_PATH, 0777) == 0)
+        fd = open(name, O_RDWR | O_APPEND | O_CREAT, 0666);
+    if (fd < 0) return NULL;
+    if (fstat(fd, &sb) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    for (int i = 0; i < JOBLOG_HANDLES && !h; i++) {
+        if (handles[i].fd < 0) h = &handles[i];
+    }
+    if (!h) {
+        h = &handles[next_victim];
+        next_victim = (next_victim + 1) % JOBLOG_HANDLES;
+        release_handle(h, true);
+    }
+
+    h->id = proc->id;
+    memcpy(h->type_label, proc->type_label, MAX_NAME_SIZE);
+    h->fd = fd;
+    h->sync = JOBLOG_SYNC_NONE;
+    h->sync_n = h->unsynced = 0;
+    h->synced_ms = now_ms();
+    h->segmented = ifd >= 0;
+    h->segment = segment;
+    h->seg_first = seg_first;
+    h->seg_bytes = sb.st_size;
+    h->seg_cap = 0;
+    h->compress = false;
+    return h;
+}
+
 int joblog_init(proc_t* proc) {
-    if (proc == NULL) {
+    if (!proc) {
+        errno = EINVAL;
         return -1;
     }
 
-    if (mkdir("./out", 0777) == -1 && errno != EEXIST) {
-        perror("Error creating log directory");
+    int r = 0;
+    if (proc->is_init) {
+        struct stat sb;
+        if (stat(JOBLOG_PATH, &sb) != 0) {
+            errno = 0;
+            r = mkdir(JOBLOG_PATH, 0777);
+        } else if (!S_ISDIR(sb.st_mode)) {
+            unlink(JOBLOG_PATH);
+            errno = 0;
+            r = mkdir(JOBLOG_PATH, 0777);
+        }
+    }
+
+    joblog_delete(proc);
+
+    return r;
+}
+
+/*
+ * a descriptor of the given segment of proc's log to read from: the 
+ * descriptor of its handle if this process has the segment open, or else a
+ * new descriptor that the caller closes (*opened is set to true)
+ */
+static int segment_fd(proc_t* proc, joblog_handle_t* h, int segment, 
+    bool* opened) {
+    char name[JOBLOG_NAME_SIZE];
+
+    *opened = false;
+    if (h && h->segment == segment) return h->fd;
+    if (!segment_name(proc->type_label, proc->id, segment, TEXT_EXT, name)) 
         return -1;
+
+    int fd = open(name, O_RDONLY);
+    *opened = fd >= 0;
+    return fd;
+}
+
+/*
+ * the segment of proc's log that has the given entry, or the last segment 
+ * if entry_num is -1, and in *first the first entry of the segment (0 for
+ * a log that is not segmented), or -1 on failure
+ */
+static int find_segment(proc_t* proc, joblog_handle_t* h, int entry_num, 
+    int* first) {
+    *first = 0;
+    if (h && !h->segmented) return 0;
+    if (h && (entry_num < 0 || entry_num >= h->seg_first)) {
+        *first = h->seg_first;
+        return h->segment;
     }
 
-    char *log_filename = get_log_filename(proc);
+    int ifd = open_index(proc);
+    if (ifd < 0) return errno == ENOENT ? 0 : -1;
 
-    if (access(log_filename, F_OK) == 0) {
-        if (unlink(log_filename) == -1) {
-            perror("Error deleting log file");
-            return -1;
+    int segments = index_segments(ifd);
+    int segment = entry_num < 0 ? segments - 1 
+        : index_find(ifd, segments, entry_num);
+    *first = segment >= 0 ? index_first(ifd, segment) : -1;
+    close(ifd);
+    return *first < 0 ? -1 : segment;
+}
+
+/*
+ * converts the count entries from the given index of the text segment fd 
+ * to out, reading READ_CHUNK entries at a time into buf (of at least 
+ * count entries, up to READ_CHUNK), returning the number of entries 
+ * converted before the end of the segment or a malformed entry, or -1 if
+ * the segment cannot be read
+ */
+static int read_text_range(int fd, int index, int count, job_t* out, 
+    char* buf) {
+    off_t off = (off_t) index * ENTRY_SIZE;
+    int done = 0;
+
+    /* the kernel reads ahead the whole range, a chunk ahead of conversion */
+    posix_fadvise(fd, off, (off_t) count * ENTRY_SIZE, POSIX_FADV_SEQUENTIAL);
+    while (done < count) {
+        int n = count - done < READ_CHUNK ? count - done : READ_CHUNK;
+        ssize_t r = pread(fd, buf, (size_t) n * ENTRY_SIZE, 
+            off + (off_t) done * ENTRY_SIZE);
+        if (r < 0) return done > 0 ? done : -1;
+        if (done + n < count)
+            posix_fadvise(fd, off + (off_t) (done + n) * ENTRY_SIZE, 
+                (off_t) READ_CHUNK * ENTRY_SIZE, POSIX_FADV_WILLNEED);
+
+        int m = r / ENTRY_SIZE;
+        for (int i = 0; i < m; i++) {
+            char* entry = buf + (size_t) i * ENTRY_SIZE;
+            if (entry[ENTRY_SIZE - 1] != '\n') return done + i;
+            entry[ENTRY_SIZE - 1] = '\0';
+            if (!str_to_job(entry, &out[done + i])) return done + i;
         }
+        done += m;
+        if (m < n) break;
+    }
+
+    return done;
+}
+
+/*
+ * decodes the count entries from the given index of the compressed segment
+ * fd to out, reading the offsets of their blocks and then the blocks with 
+ * one read each, returning the number of entries decoded before the end of
+ * the segment or a malformed entry, or -1 if the segment cannot be read
+ */
+static int decode_range(int fd, int index, int count, job_t* out) {
+    unsigned char header[JLZ_HEADER];
+
+    if (pread(fd, header, JLZ_HEADER, 0) != JLZ_HEADER 
+        || memcmp(header, JLZ_MAGIC, 4) != 0) {
+        errno = EINVAL;
+        return -1;
     }
+    uint32_t entries = get_le32(header + 4);
+    if ((uint32_t) index >= entries || count == 0) return 0;
+    if ((uint32_t) count > entries - index) count = entries - index;
+
+    int b0 = index / BLOCK_ENTRIES;
+    int blocks = (index + count - 1) / BLOCK_ENTRIES - b0 + 1;
+    size_t table = ((size_t) blocks + 1) * 8;
+    unsigned char* offsets = malloc(table);
+    if (!offsets 
+        || pread(fd, offsets, table, JLZ_HEADER + (off_t) b0 * 8) 
+            != (ssize_t) table) {
+        free(offsets);
+        return -1;
+    }
+
+    uint64_t base = get_le64(offsets);
+    uint64_t end = get_le64(offsets + table - 8);
+    size_t len = end > base && end - base <= blocks * block_bound(BLOCK_ENTRIES)
+        ? end - base : 0;
+    unsigned char* data = len > 0 ? malloc(len) : NULL;
+    posix_fadvise(fd, base, len, POSIX_FADV_SEQUENTIAL);
+    if (!data || pread(fd, data, len, base) != (ssize_t) len) {
+        free(offsets);
+        free(data);
+        return -1;
+    }
+
+    /* a block that cannot be decoded ends the range as a malformed entry */
+    job_t jobs[BLOCK_ENTRIES];
+    bool valid[BLOCK_ENTRIES];
+    int done = 0;
+    bool malformed = false;
+    for (int b = 0; b < blocks && !malformed; b++) {
+        uint64_t off = get_le64(offsets + (size_t) b * 8) - base;
+        uint64_t block_end = get_le64(offsets + (size_t) b * 8 + 8) - base;
+        int n = off <= block_end && block_end <= len 
+            ? decode_block(data + off, block_end - off, jobs, valid) : -1;
+
+        malformed = n < 0;
+        for (int i = b == 0 ? index % BLOCK_ENTRIES : 0; 
+            i < n && done < count && !malformed; i++) {
+            malformed = !valid[i];
+            if (!malformed) out[done++] = jobs[i];
+        }
+    }
+
+    free(offsets);
+    free(data);
+    return done;
+}
+
+/* 
+ * decodes the count entries from the given index of the compressed segment
+ * of proc's log to out (see decode_range)
+ */
+static int read_compressed_range(proc_t* proc, int segment, int index, 
+    int count, job_t* out) {
+    char name[JOBLOG_NAME_SIZE];
+
+    if (!segment_name(proc->type_label, proc->id, segment, COMPRESSED_EXT, 
+        name)) return -1;
+    int fd = open(name, O_RDONLY);
+    if (fd < 0) return -1;
+
+    int done = decode_range(fd, index, count, out);
+    int saved_errno = errno;
+    close(fd);
+    errno = saved_errno;
+    return done;
+}
+
+/*
+ * reads the entry at the given index of the compressed segment of proc's
+ * log into job (see joblog_read), or NULL if there is no such entry
+ */
+static job_t* read_compressed(proc_t* proc, int segment, int index, 
+    job_t* job) {
+    job_t decoded;
+
+    if (read_compressed_range(proc, segment, index, 1, &decoded) != 1) 
+        return NULL;
+    return job_copy(&decoded, job);
+}
+
+job_t* joblog_read(proc_t* proc, int entry_num, job_t* job) {
+    if (!proc || entry_num < 0) return NULL;
+
+    int saved_errno = errno;
+    bool opened;
+    int first;
+    joblog_handle_t* h = find_handle(proc);
+    if (h) flush_handle(h, false);
+
+    /* every entry is JOB_STR_SIZE bytes, a job string and a new line */
+    char entry[ENTRY_SIZE];
+    ssize_t r = 0;
+
+    /* 
+     * segment 0, the log file, has the first entries of a log whether it 
+     * is segmented or not, so without the log open the index is only read
+     * for an entry after them
+     */
+    if (!h) {
+        int fd = segment_fd(proc, NULL, 0, &opened);
+        if (fd >= 0) {
+            r = pread(fd, entry, ENTRY_SIZE, (off_t) entry_num * ENTRY_SIZE);
+            close(fd);
+        }
+    }
+
+    /* a segment that is not text may have been compressed */
+    if (r <= 0) {
+        int segment = find_segment(proc, h, entry_num, &first);
+        int fd = segment >= 0 ? segment_fd(proc, h, segment, &opened) : -1;
+        if (fd < 0) {
+            job_t* result = segment >= 0 && errno == ENOENT 
+                ? read_compressed(proc, segment, entry_num - first, job) 
+                : NULL;
+            errno = saved_errno;
+            return result;
+        }
+        r = pread(fd, entry, ENTRY_SIZE, 
+            (off_t) (entry_num - first) * ENTRY_SIZE);
+        if (opened) close(fd);
+    }
+
+    job_t* result = NULL;
+    if (r == ENTRY_SIZE && entry[ENTRY_SIZE - 1] == '\n') {
+        entry[ENTRY_SIZE - 1] = '\0';
+        result = str_to_job(entry, job);
+    }
+
+    errno = saved_errno;
+    return result;
+}
+
+int joblog_count(proc_t* proc) {
+    if (!proc) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    /* the entries of the last segment follow those before it */
+    char name[JOBLOG_NAME_SIZE];
+    struct stat sb;
+    int first;
+    joblog_handle_t* h = find_handle(proc);
+    if (h) flush_handle(h, false);
+
+    int segment = find_segment(proc, h, -1, &first);
+    if (segment < 0) return -1;
+
+    /* the size of a segment that is not open, without opening it */
+    int r = h && h->segment == segment ? fstat(h->fd, &sb)
+        : segment_name(proc->type_label, proc->id, segment, TEXT_EXT, name)
+            ? stat(name, &sb) : -1;
+    if (r != 0) return -1;
+
+    return first + (int) (sb.st_size / ENTRY_SIZE);
+}
+
+int joblog_read_range(proc_t* proc, int first, int count, job_t* out) {
+    if (!proc || !out || first < 0 || count < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    joblog_handle_t* h = find_handle(proc);
+    if (h) flush_handle(h, false);
+
+    /* as for joblog_read, a range in the log file needs no index */
+    if (!h) {
+        bool opened;
+        struct stat sb;
+        char* buf = NULL;
+        int done = -1;
+        int saved_errno = errno;
+        int fd = segment_fd(proc, NULL, 0, &opened);
+        if (fd >= 0 && fstat(fd, &sb) == 0 
+            && (off_t) first + count <= sb.st_size / ENTRY_SIZE
+            && (buf = malloc((size_t) (count < READ_CHUNK ? count 
+                : READ_CHUNK) * ENTRY_SIZE + 1))) 
+            done = read_text_range(fd, first, count, out, buf);
+        if (fd >= 0) close(fd);
+        free(buf);
+        errno = saved_errno;
+        if (done >= 0) return done;
+    }
+
+    /* the segment of first, or the one segment of a log with no index */
+    int ifd = h && !h->segmented ? -1 : open_index(proc);
+    if (ifd < 0 && (!h || h->segmented) && errno != ENOENT) return -1;
+    int segments = ifd >= 0 ? index_segments(ifd) : 1;
+    int segment = ifd >= 0 ? index_find(ifd, segments, first) : 0;
+    int seg_first = segment > 0 ? index_first(ifd, segment) : 0;
+    char* buf = malloc((size_t) (count < READ_CHUNK ? count : READ_CHUNK) 
+        * ENTRY_SIZE + 1);
+    if (segment < 0 || seg_first < 0 || !buf) {
+        if (!buf) errno = ENOMEM;
+        int saved_errno = errno;
+        if (ifd >= 0) close(ifd);
+        free(buf);
+        errno = saved_errno;
+        return -1;
+    }
+
+    /* the range ends at a partial or malformed entry, or a missing segment */
+    int saved_errno = errno;
+    int done = 0;
+    while (done < count && segment < segments) {
+        int next_first = segment + 1 < segments 
+            ? index_first(ifd, segment + 1) : -1;
+        int n = count - done;
+        if (next_first >= 0 && next_first - (first + done) < n) 
+            n = next_first - (first + done);
+
+        bool opened;
+        int index = first + done - seg_first;
+        int fd = segment_fd(proc, h, segment, &opened);
+        int r = fd >= 0 ? read_text_range(fd, index, n, out + done, buf)
+            : errno == ENOENT 
+                ? read_compressed_range(proc, segment, index, n, out + done) 
+                : -1;
+        if (r < 0) saved_errno = errno;
+        if (opened) close(fd);
+        if (r < 0) {
+            if (done == 0) done = -1;
+            break;
+        }
+
+        done += r;
+        if (r < n || next_first < 0) break;
+        seg_first = next_first;
+        segment++;
+    }
+
+    if (ifd >= 0) close(ifd);
+    free(buf);
+    errno = saved_errno;
+    return done;
+}
+
+/* pushes job to the ring r, applying the full policy of r if it is full */
+static void push_job(joblog_ring_t* r, job_t* job) {
+    uint32_t head = r->head;
+    uint32_t tail = ring_tail(r);
+
+    if (head - tail > r->mask) {
+        if (r->full == JOBLOG_FULL_DROP) {
+            r->dropped++;
+            return;
+        }
+        pthread_mutex_lock(&writer_lock);
+        wait_for_writer(r, head - r->mask);
+        pthread_mutex_unlock(&writer_lock);
+        tail = ring_tail(r);
+    }
+
+    r->slots[head & r->mask] = *job;
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+
+    if (head + 1 - tail == r->trigger) pthread_cond_signal(&writer_wake);
+}
+
+void joblog_write(proc_t* proc, job_t* job) {
+    if (!proc || !job) return;
+
+    int saved_errno = errno;
+    char entry[ENTRY_SIZE];
+    joblog_handle_t* h = find_handle(proc);
+
+    if (h && h->ring) {
+        push_job(h->ring, job);
+        errno = saved_errno;
+        return;
+    }
+
+    if (!job_to_str(job, entry) || (!h && !(h = open_handle(proc)))) {
+        errno = saved_errno;
+        return;
+    }
+    entry[ENTRY_SIZE - 1] = '\n';
+
+    if (h->buf_size == 0 || h->sync == JOBLOG_SYNC_EVERY) {
+        flush_handle(h, false);
+        write_entries(h, entry, ENTRY_SIZE);
+    } else {
+        memcpy(h->buf + h->used, entry, ENTRY_SIZE);
+        h->used += ENTRY_SIZE;
+        if (h->used + ENTRY_SIZE > h->buf_size) flush_handle(h, false);
+    }
+
+    errno = saved_errno;
+}
+
+void joblog_write_compact(proc_t* proc, label_table_t* lt,
+    compact_job_t* cjob) {
+    job_t job;
+    if (proc && label_table_expand(lt, cjob, &job))
+        joblog_write(proc, &job);
+}
+
+int joblog_set_buffer(proc_t* proc, size_t size) {
+    joblog_handle_t* h;
+
+    if (!proc) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(h = open_handle(proc))) return -1;
+
+    /* at least one entry is buffered, so that writes are whole entries */
+    if (size > 0 && size < ENTRY_SIZE) size = ENTRY_SIZE;
+
+    if (!flush_handle(h, false)) return -1;
+    stop_async(h);
+    if (size != h->buf_size) {
+        char* buf = size > 0 ? malloc(size) : NULL;
+        if (size > 0 && !buf) return -1;
+        free(h->buf);
+        h->buf = buf;
+        h->buf_size = size;
+    }
+    return 0;
+}
+
+int joblog_set_async(proc_t* proc, int entries, int interval_ms, 
+    joblog_full_t full) {
+    joblog_handle_t* h;
+
+    if (!proc || entries < 0 || (entries > 0 && interval_ms < 1)
+        || (full != JOBLOG_FULL_BLOCK && full != JOBLOG_FULL_DROP)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(h = open_handle(proc))) return -1;
+
+    if (!flush_handle(h, false)) return -1;
+    stop_async(h);
+    if (entries == 0) return 0;
+
+    uint32_t capacity = 1;
+    while (capacity < (uint32_t) entries && capacity < (1u << 30)) 
+        capacity <<= 1;
+
+    joblog_ring_t* r = malloc(sizeof(joblog_ring_t));
+    job_t* slots = malloc(capacity * sizeof(job_t));
+    if (!r || !slots) {
+        free(r);
+        free(slots);
+        return -1;
+    }
+    r->slots = slots;
+    r->mask = capacity - 1;
+    r->head = r->tail = 0;
+    r->trigger = capacity > 1 ? capacity / 2 : 1;
+    r->interval_ms = interval_ms;
+    r->full = full;
+    r->dropped = 0;
+    r->failed = false;
+
+    pthread_mutex_lock(&writer_lock);
+    if (!start_writer()) {
+        pthread_mutex_unlock(&writer_lock);
+        free(slots);
+        free(r);
+        return -1;
+    }
+
+    /* the ring replaces the buffer */
+    free(h->buf);
+    h->buf = NULL;
+    h->buf_size = 0;
+    h->ring = r;
+    pthread_cond_signal(&writer_wake);
+    pthread_mutex_unlock(&writer_lock);
+    return 0;
+}
+
+int joblog_set_sync(proc_t* proc, joblog_sync_t sync, int n) {
+    joblog_handle_t* h;
+
+    if (!proc || (sync != JOBLOG_SYNC_NONE && sync != JOBLOG_SYNC_INTERVAL
+        && sync != JOBLOG_SYNC_RECORDS && sync != JOBLOG_SYNC_EVERY)
+        || ((sync == JOBLOG_SYNC_INTERVAL || sync == JOBLOG_SYNC_RECORDS) 
+            && n < 1)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(h = open_handle(proc))) return -1;
+
+    if (!flush_handle(h, false)) return -1;
+
+    pthread_mutex_lock(&writer_lock);
+    h->sync = sync;
+    h->sync_n = n;
+    h->unsynced = 0;
+    h->synced_ms = now_ms();
+    pthread_mutex_unlock(&writer_lock);
+
+    /* the mode applies to entries written from now, so sync those before */
+    return sync == JOBLOG_SYNC_NONE || fdatasync(h->fd) == 0 ? 0 : -1;
+}
+
+int joblog_set_segment_size(proc_t* proc, size_t size) {
+    joblog_handle_t* h;
+    char name[JOBLOG_NAME_SIZE];
+
+    if (!proc) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(h = open_handle(proc))) return -1;
+    if (!flush_handle(h, false)) return -1;
+
+    /* segments are whole entries, at least one */
+    if (size > 0 && size < ENTRY_SIZE) size = ENTRY_SIZE;
+    size = size / ENTRY_SIZE * ENTRY_SIZE;
+
+    /* an index of the one segment makes the log segmented */
+    if (!h->segmented && size > 0) {
+        int64_t first = 0;
+        if (!index_name(proc->type_label, proc->id, name)) return -1;
+        int ifd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (ifd < 0) return -1;
+        bool ok = write_all(ifd, (const char*) &first, INDEX_RECORD);
+        close(ifd);
+        if (!ok) return -1;
+        h->segmented = true;
+    }
+
+    pthread_mutex_lock(&writer_lock);
+    h->seg_cap = size;
+    pthread_mutex_unlock(&writer_lock);
     return 0;
 }
 
+int joblog_set_compression(proc_t* proc, bool compress) {
+    joblog_handle_t* h;
+
+    if (!proc) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(h = open_handle(proc))) return -1;
+
+    pthread_mutex_lock(&writer_lock);
+    if (compress && !start_writer()) {
+        pthread_mutex_unlock(&writer_lock);
+        return -1;
+    }
+    h->compress = compress;
+    pthread_mutex_unlock(&writer_lock);
+    return 0;
+}
+
+int joblog_delete_segments(proc_t* proc, int entry_num) {
+    char name[JOBLOG_NAME_SIZE];
+
+    if (!proc) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    /* not under the writer compressing one of the segments */
+    wait_for_compression(proc->type_label, proc->id);
+
+    int saved_errno = errno;
+    int ifd = open_index(proc);
+    if (ifd < 0) {
+        if (errno != ENOENT) return -1;
+        errno = saved_errno;
+        return 0;
+    }
+
+    /* a segment goes if the next one starts at or before entry_num */
+    int deleted = 0;
+    int segments = index_segments(ifd);
+    for (int s = 0; s < segments - 1; s++) {
+        int next_first = index_first(ifd, s + 1);
+        if (next_first < 0 || next_first > entry_num) break;
+        bool text = segment_name(proc->type_label, proc->id, s, TEXT_EXT, 
+            name) && unlink(name) == 0;
+        bool compressed = segment_name(proc->type_label, proc->id, s, 
+            COMPRESSED_EXT, name) && unlink(name) == 0;
+        if (text || compressed) deleted++;
+    }
+    close(ifd);
+
+    errno = saved_errno;
+    return deleted;
+}
+
+int joblog_compress_segments(proc_t* proc, int entry_num) {
+    char name[JOBLOG_NAME_SIZE];
+
+    if (!proc) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    wait_for_compression(proc->type_label, proc->id);
+
+    int saved_errno = errno;
+    int ifd = open_index(proc);
+    if (ifd < 0) {
+        if (errno != ENOENT) return -1;
+        errno = saved_errno;
+        return 0;
+    }
+
+    /* as for joblog_delete_segments, so never the last segment */
+    joblog_handle_t* h = find_handle(proc);
+    bool sync = h && h->sync != JOBLOG_SYNC_NONE;
+    int compressed = 0;
+    int segments = index_segments(ifd);
+    for (int s = 0; s < segments - 1; s++) {
+        int next_first = index_first(ifd, s + 1);
+        if (next_first < 0 || next_first > entry_num) break;
+        if (segment_name(proc->type_label, proc->id, s, TEXT_EXT, name)
+            && access(name, F_OK) == 0) {
+            if (!compress_segment(proc->type_label, proc->id, s, sync)) {
+                saved_errno = errno;
+                compressed = -1;
+                break;
+            }
+            compressed++;
+        }
+    }
+    close(ifd);
+
+    errno = saved_errno;
+    return compressed;
+}
+
+long joblog_unsynced(proc_t* proc) {
+    if (!proc) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    joblog_handle_t* h = find_handle(proc);
+    if (!h) return 0;
+    if (!h->ring) return h->sync == JOBLOG_SYNC_NONE ? 0 : h->unsynced;
+
+    pthread_mutex_lock(&writer_lock);
+    long unsynced = h->sync == JOBLOG_SYNC_NONE ? 0 : h->unsynced;
+    pthread_mutex_unlock(&writer_lock);
+    return unsynced;
+}
+
+long joblog_dropped(proc_t* proc) {
+    if (!proc) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    joblog_handle_t* h = find_handle(proc);
+    return h && h->ring ? h->ring->dropped : 0;
+}
+
+int joblog_flush(proc_t* proc) {
+    if (!proc) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    joblog_handle_t* h = find_handle(proc);
+    bool ok = !h || flush_handle(h, true);
+    wait_for_compression(proc->type_label, proc->id);
+    return ok ? 0 : -1;
+}
+
+int joblog_close(proc_t* proc) {
+    if (!proc) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    joblog_handle_t* h = find_handle(proc);
+    if (!h) return 0;
+
+    bool ok = flush_handle(h, true);
+    release_handle(h, false);
+    wait_for_compression(proc->type_label, proc->id);
+    return ok ? 0 : -1;
+}
+
 void joblog_delete(proc_t* proc) {
-    if (proc == NULL) {
-        return;
+    if (!proc) return;
+
+    int saved_errno = errno;
+    char name[JOBLOG_NAME_SIZE];
+
+    /* buffered entries go with the log */
+    joblog_handle_t* h = find_handle(proc);
+    if (h) release_handle(h, false);
+
+    /* so that the writer does not compress a segment after it has gone */
+    wait_for_compression(proc->type_label, proc->id);
+
+    /* every segment of a segmented log, then its index */
+    int ifd = open_index(proc);
+    int segments = ifd >= 0 ? index_segments(ifd) : 1;
+    if (ifd >= 0) close(ifd);
+
+    for (int s = 0; s < segments; s++) {
+        if (segment_name(proc->type_label, proc->id, s, TEXT_EXT, name)) 
+            unlink(name);
+        if (segment_name(proc->type_label, proc->id, s, COMPRESSED_EXT, name)) 
+            unlink(name);
     }
+    if (ifd >= 0 && index_name(proc->type_label, proc->id, name)) 
+        unlink(name);
 
-    char *log_filename = get_log_filename(proc);
-    if (access(log_filename, F_OK) == 0) {
-        if (unlink(log_filename) == 0) {
-            printf("Log file %s deleted successfully.\n", log_filename);
-        } else {
-            perror("Error deleting log file");
+    errno = saved_errno;
+}
+
+/* 
+ * maps the whole entries of the file fd into seg, or the whole file if it
+ * is a compressed segment, false on failure
+ */
+static bool map_segment(int fd, struct joblog_maps* maps, int seg, 
+    bool compressed) {
+    struct stat sb;
+
+    if (fstat(fd, &sb) != 0) return false;
+    if (sb.st_size < (compressed ? JLZ_HEADER : ENTRY_SIZE)) {
+        if (!compressed) return true;
+        errno = EINVAL;
+        return false;
+    }
+
+    size_t size = compressed ? (size_t) sb.st_size 
+        : (size_t) (sb.st_size - sb.st_size % ENTRY_SIZE);
+    void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) return false;
+
+    /* the blocks are checked as they are decoded, only the header here */
+    const unsigned char* header = map;
+    uint32_t entries = compressed ? get_le32(header + 4) : size / ENTRY_SIZE;
+    uint32_t blocks = compressed ? get_le32(header + 8) : 0;
+    if (compressed && (memcmp(header, JLZ_MAGIC, 4) != 0 
+        || blocks != (entries + BLOCK_ENTRIES - 1) / BLOCK_ENTRIES
+        || JLZ_HEADER + ((size_t) blocks + 1) * 8 > size)) {
+        munmap(map, size);
+        errno = EINVAL;
+        return false;
+    }
+
+    madvise(map, size, MADV_SEQUENTIAL);
+    maps->segs[seg].map = map;
+    maps->segs[seg].size = size;
+    maps->segs[seg].entries = entries;
+    maps->segs[seg].compressed = compressed;
+    return true;
+}
+
+/* 
+ * maps the given compressed segment of proc's log into seg (see 
+ * map_segment), false on failure
+ */
+static bool map_compressed(proc_t* proc, int segment, 
+    struct joblog_maps* maps, int seg) {
+    char name[JOBLOG_NAME_SIZE];
+
+    if (!segment_name(proc->type_label, proc->id, segment, COMPRESSED_EXT, 
+        name)) return false;
+    int fd = open(name, O_RDONLY);
+    if (fd < 0) return false;
+
+    bool ok = map_segment(fd, maps, seg, true);
+    int saved_errno = errno;
+    close(fd);
+    errno = saved_errno;
+    return ok;
+}
+
+/*
+ * decodes the given block of the compressed segment seg of cur into the 
+ * text entries of the block buffer of cur, a malformed entry as an entry 
+ * of '?', false on failure
+ */
+static bool decode_entries(joblog_cursor_t* cur, int seg, int block) {
+    const unsigned char* map 
+        = (const unsigned char*) cur->maps->segs[seg].map;
+    size_t size = cur->maps->segs[seg].size;
+    job_t jobs[BLOCK_ENTRIES];
+    bool valid[BLOCK_ENTRIES];
+
+    if (!cur->block && !(cur->block = malloc(BLOCK_ENTRIES * ENTRY_SIZE)))
+        return false;
+
+    uint64_t off = get_le64(map + JLZ_HEADER + (size_t) block * 8);
+    uint64_t end = get_le64(map + JLZ_HEADER + (size_t) block * 8 + 8);
+    int n = off <= end && end <= size 
+        ? decode_block(map + off, end - off, jobs, valid) : -1;
+    if (n < 0) return false;
+
+    for (int i = 0; i < n; i++) {
+        char* entry = cur->block + (size_t) i * ENTRY_SIZE;
+        if (!valid[i] || !job_to_str(&jobs[i], entry))
+            memset(entry, '?', ENTRY_SIZE - 1);
+        entry[ENTRY_SIZE - 1] = '\n';
+    }
+    /* a short block is treated as malformed entries */
+    if (n < BLOCK_ENTRIES)
+        memset(cur->block + (size_t) n * ENTRY_SIZE, '?', 
+            (size_t) (BLOCK_ENTRIES - n) * ENTRY_SIZE);
+
+    cur->block_seg = seg;
+    cur->block_num = block;
+    return true;
+}
+
+static void unmap_segments(struct joblog_maps* maps) {
+    for (int s = 0; s < maps->count; s++) {
+        if (maps->segs[s].map)
+            munmap((void*) maps->segs[s].map, maps->segs[s].size);
+    }
+    free(maps);
+}
+
+int joblog_cursor_open(proc_t* proc, joblog_cursor_t* cur) {
+    if (!proc || !cur) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    joblog_handle_t* h = find_handle(proc);
+    if (h) flush_handle(h, false);
+
+    /* the index numbers the entries of each segment of a segmented log */
+    int ifd = h && !h->segmented ? -1 : open_index(proc);
+    if (ifd < 0 && (!h || h->segmented) && errno != ENOENT) return -1;
+    bool segmented = ifd >= 0;
+    int segments = segmented ? index_segments(ifd) : 1;
+
+    struct joblog_maps* maps = segments < 1 ? NULL 
+        : malloc(sizeof(struct joblog_maps) 
+            + segments * sizeof(maps->segs[0]));
+    if (!maps) {
+        int saved_errno = errno;
+        if (ifd >= 0) close(ifd);
+        errno = segments < 1 ? EINVAL : saved_errno;
+        return -1;
+    }
+    maps->count = 0;
+
+    /* the segments of a segmented log that have been deleted are empty */
+    int start = 0;
+    for (int s = 0; s < segments; s++) {
+        bool opened;
+        maps->segs[s].map = NULL;
+        maps->segs[s].size = 0;
+        maps->segs[s].start = start;
+        maps->segs[s].first = segmented ? index_first(ifd, s) : 0;
+        maps->segs[s].entries = 0;
+        maps->segs[s].compressed = false;
+        maps->count = s + 1;
+
+        int fd = maps->segs[s].first < 0 ? -1 
+            : segment_fd(proc, h, s, &opened);
+        bool ok = fd >= 0 ? map_segment(fd, maps, s, false) 
+            : segmented && maps->segs[s].first >= 0 && errno == ENOENT
+                && (map_compressed(proc, s, maps, s) || errno == ENOENT);
+        if (fd >= 0 && opened) {
+            int saved_errno = errno;
+            close(fd);
+            errno = saved_errno;
         }
-    } else {
-        printf("Log file %s does not exist.\n", log_filename);
+        if (!ok) {
+            int saved_errno = errno;
+            if (ifd >= 0) close(ifd);
+            unmap_segments(maps);
+            errno = saved_errno;
+            return -1;
+        }
+        start += maps->segs[s].entries;
+    }
+    if (ifd >= 0) close(ifd);
+
+    cur->maps = maps;
+    cur->owner = true;
+    cur->seg = 0;
+    cur->next = 0;
+    cur->end = start;
+    cur->skipped = 0;
+    cur->block = NULL;
+    cur->block_seg = cur->block_num = -1;
+    return 0;
+}
+
+joblog_cursor_t* joblog_cursor_range(joblog_cursor_t* cur, int first, 
+    int count, joblog_cursor_t* range) {
+    if (!cur || !range || first < 0 || count < 0) return NULL;
+
+    int remaining = cur->end - cur->next;
+    if (first > remaining) first = remaining;
+    if (count > remaining - first) count = remaining - first;
+
+    range->maps = cur->maps;
+    range->owner = false;
+    range->seg = cur->seg;
+    range->next = cur->next + first;
+    range->end = range->next + count;
+    range->skipped = 0;
+    range->block = NULL;
+    range->block_seg = range->block_num = -1;
+    return range;
+}
+
+int joblog_cursor_count(joblog_cursor_t* cur) {
+    return cur ? cur->end - cur->next : 0;
+}
+
+job_t* joblog_cursor_next(joblog_cursor_t* cur, job_t* job) {
+    char entry[ENTRY_SIZE];
+    const char* str;
+    job_t parsed;
+
+    while ((str = joblog_cursor_next_str(cur))) {
+        if (str[ENTRY_SIZE - 1] == '\n') {
+            memcpy(entry, str, ENTRY_SIZE - 1);
+            entry[ENTRY_SIZE - 1] = '\0';
+
+            if (str_to_job(entry, &parsed))
+                return job_copy(&parsed, job);
+        }
+        cur->skipped++;
     }
+
+    return NULL;
+}
+
+/* 
+ * moves cur to the segment of its next entry, which is before cur->end, 
+ * returning the index of the entry in the segment
+ */
+static int seek_segment(joblog_cursor_t* cur) {
+    struct joblog_maps* maps = cur->maps;
+    while (cur->next - maps->segs[cur->seg].start 
+        >= maps->segs[cur->seg].entries)
+        cur->seg++;
+    return cur->next - maps->segs[cur->seg].start;
+}
+
+int joblog_cursor_entry(joblog_cursor_t* cur) {
+    if (!cur || cur->next >= cur->end) return -1;
+
+    int index = seek_segment(cur);
+    return cur->maps->segs[cur->seg].first + index;
+}
+
+const char* joblog_cursor_next_str(joblog_cursor_t* cur) {
+    if (!cur || cur->next >= cur->end) return NULL;
+
+    struct joblog_maps* maps = cur->maps;
+    int index = seek_segment(cur);
+    cur->next++;
+    if (!maps->segs[cur->seg].compressed)
+        return maps->segs[cur->seg].map + (size_t) index * ENTRY_SIZE;
+
+    /* a block that cannot be decoded is skipped as malformed entries */
+    int block = index / BLOCK_ENTRIES;
+    if ((cur->block_seg != cur->seg || cur->block_num != block)
+        && !decode_entries(cur, cur->seg, block)) {
+        if (!cur->block) return NULL;
+        memset(cur->block, '?', BLOCK_ENTRIES * ENTRY_SIZE);
+        cur->block_seg = cur->seg;
+        cur->block_num = block;
+    }
+    return cur->block + (size_t) (index % BLOCK_ENTRIES) * ENTRY_SIZE;
+}
+
+void joblog_cursor_close(joblog_cursor_t* cur) {
+    if (!cur) return;
+
+    if (cur->owner && cur->maps) unmap_segments(cur->maps);
+    free(cur->block);
+    cur->block = NULL;
+    cur->block_seg = cur->block_num = -1;
+    cur->maps = NULL;
+    cur->seg = 0;
+    cur->next = cur->end = 0;
 }
@@ -3,6 +3,222 @@
 #define _JOBLOG_H
 #include "job.h"
 #include "proc.h"
+#include "label_table.h"
+
+/*
+ * Introduction
+ *
+ * A joblog is a text file per process in JOBLOG_PATH, with an entry per 
+ * line for each job the process has logged (see joblog_write).
+ *
+ * LOG HANDLES
+ *
+ * A process keeps the log files it writes open, so that joblog_write makes 
+ * a single write to the file per entry rather than opening and closing the
+ * file for every entry. By default each entry is written to the file before
+ * joblog_write returns. A process can instead buffer the entries of a log:
+ *      joblog_set_buffer(proc_t* proc, size_t size)
+ *      joblog_flush(proc_t* proc)
+ *      joblog_close(proc_t* proc)
+ * With a buffer of size bytes, entries are written to the file when the 
+ * buffer is full, when joblog_flush or joblog_close is called, when the 
+ * process reads the log with joblog_read and when the process exits 
+ * normally (by exit or returning from main). Entries still in the buffer 
+ * are lost if the process is terminated by a signal or calls _exit.
+ * A child process does not write the buffered entries of its parent.
+ *
+ * A log must only be removed with joblog_delete (or joblog_init) while a 
+ * process has it open, otherwise the process goes on writing to the 
+ * removed file.
+ *
+ * ASYNCHRONOUS LOGS
+ *
+ * A log can instead be written by a writer thread of the process, so that 
+ * joblog_write only copies the job to a ring of jobs for the log:
+ *      joblog_set_async(proc_t* proc, int entries, int interval_ms, 
+ *          joblog_full_t full)
+ *      joblog_dropped(proc_t* proc)
+ * The writer thread converts the jobs in the ring to entries and writes 
+ * them to the log in batches, when the ring is half full or interval_ms 
+ * after it last wrote. The full policy says what joblog_write does when the
+ * ring is full because the writer has fallen behind: wait for the writer 
+ * (JOBLOG_FULL_BLOCK) or drop the job (JOBLOG_FULL_DROP), so the memory 
+ * of an asynchronous log is bounded by the size of its ring. Entries in the 
+ * ring are written as buffered entries are (see above) and lost in the 
+ * same cases. Only one thread of a process should write to a given log.
+ *
+ * DURABILITY
+ *
+ * Entries written to a log file may still be lost if the system crashes. 
+ * A process can choose when the entries of a log are synced to the disk 
+ * (with fdatasync), trading the throughput of joblog_write against the 
+ * entries that can be lost:
+ *      joblog_set_sync(proc_t* proc, joblog_sync_t sync, int n)
+ *      joblog_unsynced(proc_t* proc)
+ * With any mode but JOBLOG_SYNC_NONE, joblog_flush and joblog_close also 
+ * sync the log. Modes apply to entries once they are written to the file, 
+ * so buffered entries are not durable until the buffer is written, and 
+ * for an asynchronous log the writer thread syncs the log after it writes 
+ * a batch, so that joblog_write does not wait for the disk. The writer 
+ * also wakes when the interval of an asynchronous log synced by 
+ * JOBLOG_SYNC_INTERVAL has passed, so its entries are synced within the 
+ * interval even if nothing more is written. A log that is not asynchronous
+ * has no thread to do this, so its interval is only checked when it is 
+ * written, flushed or closed.
+ *
+ * SEGMENTED LOGS
+ *
+ * So that a long-running process does not write a single ever-growing 
+ * file, a log can be rolled over to a new file (a segment) each time the
+ * current segment reaches a given size:
+ *      joblog_set_segment_size(proc_t* proc, size_t size)
+ *      joblog_delete_segments(proc_t* proc, int entry_num)
+ * Segment 0 is the log file (e.g. ./out/bwait_cons0000000.txt) and 
+ * segment k > 0 is numbered in its name (./out/bwait_cons0000000.000003.txt).
+ * A segmented log has an index (./out/bwait_cons0000000.idx) of the number
+ * of the first entry in each segment, as a 64-bit integer per segment in 
+ * the byte order of the host, so joblog_read finds the segment of an entry
+ * with a binary search of the index. Entries are numbered from the start 
+ * of the log across segments, and old segments can be deleted without 
+ * renumbering the entries of the others. joblog_read, joblog_count and 
+ * cursors work on segmented logs as on other logs, with the entries of 
+ * deleted segments missing.
+ *
+ * COMPRESSED SEGMENTS
+ *
+ * Segments that are no longer written to can be compressed, replacing the
+ * text file of the segment with a binary file of the same name with the 
+ * extension .jlz (./out/bwait_cons0000000.000003.jlz):
+ *      joblog_set_compression(proc_t* proc, bool compress)
+ *      joblog_compress_segments(proc_t* proc, int entry_num)
+ * A compressed segment has a header (the characters "JLZ1", then the 
+ * number of entries and the number of blocks as 32-bit little-endian 
+ * integers), the 64-bit little-endian offsets in the file of each block 
+ * and of the end of the last block, and then blocks of up to 256 entries. 
+ * The entries of a block are stored by column, so that each column 
+ * compresses well: a dictionary of the labels of the block and the index of
+ * the label of each entry, the differences of the pids and of the ids from
+ * those of the entry before as zigzag-encoded variable-length integers, and 
+ * the priorities as variable-length integers. Each block can be decoded on
+ * its own, so joblog_read decodes only the block of an entry. Entries read 
+ * from a compressed segment are the same jobs as were read from its text, 
+ * except that the text of malformed entries is not kept (they are still 
+ * malformed). The last segment of a log is never compressed.
+ *
+ * With compression set, a segment is compressed by the writer thread (see
+ * ASYNCHRONOUS LOGS) after the log rolls over from it, so joblog_write 
+ * does not wait for it. joblog_flush and joblog_close wait until the 
+ * segments queued for the log are compressed. Segments still queued when 
+ * the process is killed stay text, and can be compressed later with 
+ * joblog_compress_segments.
+ *
+ * LOG CURSORS
+ *
+ * To scan a log, a cursor (joblog_cursor_t) maps the log into memory and 
+ * yields its entries in order, as jobs or as pointers to the text of the
+ * entries in the mapping, without reading the log into buffers:
+ *      joblog_cursor_open(proc_t* proc, joblog_cursor_t* cur)
+ *      joblog_cursor_range(joblog_cursor_t* cur, int first, int count, 
+ *          joblog_cursor_t* range)
+ *      joblog_cursor_count(joblog_cursor_t* cur)
+ *      joblog_cursor_entry(joblog_cursor_t* cur)
+ *      joblog_cursor_next(joblog_cursor_t* cur, job_t* job)
+ *      joblog_cursor_next_str(joblog_cursor_t* cur)
+ *      joblog_cursor_close(joblog_cursor_t* cur)
+ * A cursor sees the entries that were in the log when it was opened. Every
+ * cursor that is opened, and every range made from it, must be closed with
+ * joblog_cursor_close, even after its last entry: closing unmaps the log 
+ * and frees the buffer that a cursor allocates to decode the entries of 
+ * compressed segments. Cursors made by joblog_cursor_range share the 
+ * mapping of their cursor and cover disjoint ranges of its entries, so 
+ * that threads can scan a log in parallel, each with its own range:
+ *      joblog_cursor_t cur, range[4];
+ *      joblog_cursor_open(proc, &cur);
+ *      int n = joblog_cursor_count(&cur);
+ *      for (int t = 0; t < 4; t++)
+ *          joblog_cursor_range(&cur, t * n / 4, (t + 1) * n / 4 - t * n / 4,
+ *              &range[t]);
+ *      ...                     // thread t scans range[t]
+ *      for (int t = 0; t < 4; t++) 
+ *          joblog_cursor_close(&range[t]);
+ *      joblog_cursor_close(&cur);  // after the threads are done
+ */
+
+/*
+ * Definition of enum joblog_full - what joblog_write does with a job for an
+ * asynchronous log whose ring is full.
+ *
+ * Type alias:
+ * An enum joblog_full can also be referred to as joblog_full_t
+ *
+ * Values:
+ * JOBLOG_FULL_BLOCK - wait until the writer thread has made room for the job
+ * JOBLOG_FULL_DROP - drop the job and count it (see joblog_dropped)
+ */
+typedef enum joblog_full {
+    JOBLOG_FULL_BLOCK,
+    JOBLOG_FULL_DROP
+} joblog_full_t;
+
+/*
+ * Definition of enum joblog_sync - when the entries of a log are synced to
+ * the disk.
+ *
+ * Type alias:
+ * An enum joblog_sync can also be referred to as joblog_sync_t
+ *
+ * Values:
+ * JOBLOG_SYNC_NONE - never, the system writes them back when it chooses
+ * JOBLOG_SYNC_INTERVAL - after a write when n ms have passed since the last 
+ *      sync and, for an asynchronous log, by the writer thread as soon as n 
+ *      ms have passed since the last sync with entries unsynced
+ * JOBLOG_SYNC_RECORDS - after a write when n entries have been written 
+ *      since the last sync
+ * JOBLOG_SYNC_EVERY - after every write, and the log is not buffered, so 
+ *      each entry is synced before joblog_write returns (for a synchronous 
+ *      log)
+ */
+typedef enum joblog_sync {
+    JOBLOG_SYNC_NONE,
+    JOBLOG_SYNC_INTERVAL,
+    JOBLOG_SYNC_RECORDS,
+    JOBLOG_SYNC_EVERY
+} joblog_sync_t;
+
+/*
+ * Definition of struct joblog_cursor - a position in a range of the entries
+ * of a mapped log.
+ *
+ * Type alias:
+ * A struct joblog_cursor can also be referred to as joblog_cursor_t
+ *
+ * Fields:
+ * maps - the mappings of the segments of the log (see SEGMENTED LOGS)
+ * owner - whether the cursor unmaps the mappings when it is closed (false 
+ *      for a cursor made by joblog_cursor_range)
+ * seg - the segment of the next entry of the cursor
+ * next - the index of the next entry of the cursor
+ * end - the index after the last entry of the cursor
+ * skipped - the number of malformed entries skipped by joblog_cursor_next
+ * block - the text of the entries of the decoded block of a compressed 
+ *      segment, allocated when the cursor first reaches such a segment
+ * block_seg - the segment of the decoded block, -1 if none
+ * block_num - the number of the decoded block in its segment, -1 if none
+ *
+ * Note fields of the struct should only be accessed in the implementation 
+ * file joblog.c. Use joblog_cursor functions to operate on a cursor.
+ */
+typedef struct joblog_cursor {
+    struct joblog_maps* maps;
+    bool owner;
+    int seg;
+    int next;
+    int end;
+    int skipped;
+    char* block;
+    int block_seg;
+    int block_num;
+} joblog_cursor_t;
 
 /*
  * joblog_init(proc_t* proc)
@@ -45,9 +261,15 @@ int joblog_init(proc_t* proc);
  * indexed by entry_num like an array from 0 to N - 1.
  * 
  * Each entry in the log is a line of text representing a job terminated by 
- * a new line. The text is a string specified by the JOB_STR_FMT defined in 
+ * a new line. The text is a string specified by the JOB_STR_FMT defined in
  * job.h. See joblog_write for more information.
  *
+ * Because every entry is exactly JOB_STR_SIZE bytes, the entry is read
+ * directly from offset entry_num * JOB_STR_SIZE of the log, so reading an
+ * entry takes the same time wherever it is in the log. An entry that is not
+ * a well-formed job string followed by a new line is not converted and NULL
+ * is returned for it.
+ *
  * If there is an entry for the given entry_num, then it is read as a string
  * from the log and converted to a job_t struct at the address specified by 
  * the job parameter. If the job parameter is NULL, a new dynamically allocated
@@ -125,6 +347,65 @@ int joblog_init(proc_t* proc);
  */
 job_t* joblog_read(proc_t* proc, int entry_num, job_t* job);
 
+/*
+ * joblog_count(proc_t* proc)
+ *
+ * Count the entries in the given process' log, from the size of the log 
+ * file (every entry is JOB_STR_SIZE bytes), or for a segmented log from the
+ * first entry and size of the last segment. Entries that this process has
+ * buffered are written to the log first. A partial entry at the end of the
+ * log is not counted. The entries of deleted segments are counted.
+ *
+ * Usage:
+ *      int n = joblog_count(proc);
+ *      for (int i = 0; i < n; i++) {
+ *          job_t* jptr = joblog_read(proc, i, &job);
+ *          ...
+ *      }
+ *
+ * Return:
+ * On success: the number of entries in the log.
+ * On failure: -1, and errno is set to EINVAL if proc is NULL, or by the
+ * system library functions used to open and stat the log (e.g. ENOENT if 
+ * there is no log).
+ */
+int joblog_count(proc_t* proc);
+
+/*
+ * joblog_read_range(proc_t* proc, int first, int count, job_t* out)
+ *
+ * Read up to count entries of the given process' log from entry_num first
+ * into the array out, so that out[i] is the entry first + i. Rather than 
+ * opening the log and reading an entry per call as joblog_read does, the 
+ * log (each segment of the range, for a segmented log) is opened once and 
+ * read sequentially in large reads, with hints to the system to read ahead
+ * (posix_fadvise), and the blocks of a compressed segment are read at once.
+ * Entries that this process has buffered are written to the log first. The
+ * range ends early at the end of the log, at a malformed entry (see 
+ * joblog_read) and at a deleted segment, so that the entries read are 
+ * always consecutive.
+ *
+ * Usage:
+ *      // check every entry of the log, 1024 entries at a time
+ *      job_t jobs[1024];
+ *      int first = 0;
+ *      int n;
+ *      while ((n = joblog_read_range(proc, first, 1024, jobs)) > 0) {
+ *          ...                 // jobs[0] to jobs[n - 1]
+ *          first += n;
+ *      }
+ *
+ * Return:
+ * On success: the number of entries read into out, less than count if the
+ * range ended early (0 if first is the number of entries in the log or
+ * more, or the entry first is malformed).
+ * On failure: -1, and errno is set to EINVAL if proc or out is NULL, or 
+ * first or count is negative, or by the system library functions used to
+ * open and read the log (e.g. ENOENT if there is no log, or if entry first 
+ * is in a deleted segment).
+ */
+int joblog_read_range(proc_t* proc, int first, int count, job_t* out);
+
 /*
  * joblog_write(proc_t* proc, job_t* job)
  *
@@ -206,10 +487,30 @@ job_t* joblog_read(proc_t* proc, int entry_num, job_t* job);
  */
 void joblog_write(proc_t* proc, job_t* job);
 
+/*
+ * joblog_write_compact(proc_t* proc, label_table_t* lt, compact_job_t* cjob)
+ *
+ * As joblog_write for the job of which cjob is the compact form, with its 
+ * label expanded from lt (see label_table.h). This is how a consumer of a 
+ * queue with compact slots logs the jobs it takes from the queue in compact
+ * form, for example:
+ *      compact_job_t cj;
+ *      if (ipc_jobqueue_dequeue_compact(ijq, &cj))
+ *          joblog_write_compact(proc, ipc_jobqueue_labels(ijq), &cj);
+ *
+ * Errors:
+ * As for joblog_write. In addition, nothing is written if lt or cjob is NULL
+ * or the label of cjob is not in lt.
+ */
+void joblog_write_compact(proc_t* proc, label_table_t* lt, 
+    compact_job_t* cjob);
+
 /*
  * joblog_delete(proc_t* proc)
  *
- * Delete the given process' log.
+ * Delete the given process' log, with every segment and the index of a 
+ * segmented log. If this process has the log open, it is closed and any 
+ * buffered entries are discarded with the log.
  *
  * Usage:
  *      joblog_delete(proc);
@@ -230,4 +531,321 @@ void joblog_write(proc_t* proc, job_t* job);
  */
 void joblog_delete(proc_t* proc);
 
+/*
+ * joblog_set_buffer(proc_t* proc, size_t size)
+ *
+ * Buffer the entries written to the given process' log in a buffer of size
+ * bytes (see LOG HANDLES above), opening the log if it is not already open.
+ * Any entries already buffered are written to the log first. A size of 0 
+ * turns buffering off, so that each entry is written by joblog_write, and a
+ * size of less than JOB_STR_SIZE is rounded up to JOB_STR_SIZE (one entry).
+ *
+ * Usage:
+ *      joblog_set_buffer(proc, 64 * JOB_STR_SIZE);  // 64 entries per write
+ *      ...
+ *      joblog_write(proc, job);
+ *      ...
+ *      joblog_flush(proc);                         // entries now in the log
+ *
+ * Return:
+ * On success: 0
+ * On failure: -1, and errno is set to EINVAL if proc is NULL or by the 
+ * system library functions used to open and write the log or to allocate 
+ * the buffer.
+ */
+int joblog_set_buffer(proc_t* proc, size_t size);
+
+/*
+ * joblog_flush(proc_t* proc)
+ *
+ * Write any buffered entries of the given process' log to the log file, 
+ * and sync the log unless its sync mode is JOBLOG_SYNC_NONE (see 
+ * joblog_set_sync). Also wait until the writer thread has compressed the
+ * segments queued for the log (see joblog_set_compression).
+ *
+ * Return:
+ * On success (including when the log is not open or there are no buffered
+ * entries): 0
+ * On failure: -1, and errno is set to EINVAL if proc is NULL or by write 
+ * or fdatasync. 
+ * The entries that could not be written are discarded.
+ */
+int joblog_flush(proc_t* proc);
+
+/*
+ * joblog_close(proc_t* proc)
+ *
+ * Flush and close the given process' log. The next joblog_write reopens the
+ * log without buffering or syncing.
+ *
+ * Return:
+ * As for joblog_flush.
+ */
+int joblog_close(proc_t* proc);
+
+/*
+ * joblog_set_async(proc_t* proc, int entries, int interval_ms, 
+ *      joblog_full_t full)
+ *
+ * Make the given process' log asynchronous with a ring of at least the 
+ * given number of entries (rounded up to a power of 2), written at least 
+ * every interval_ms milliseconds while there are jobs in the ring, and the
+ * given full policy (see the Introduction). Entries that this process has 
+ * buffered are written first, and the ring replaces the buffer of the log. 
+ * An entries of 0 makes the log synchronous again, after writing the jobs
+ * in the ring. joblog_set_buffer also makes the log synchronous again.
+ *
+ * The writer thread is started by the first call for an asynchronous log.
+ *
+ * Usage:
+ *      joblog_set_async(proc, 4096, 10, JOBLOG_FULL_BLOCK);
+ *      ...                     // joblog_write(proc, job) etc.
+ *      joblog_close(proc);     // writes the jobs still in the ring
+ *
+ * Return:
+ * On success: 0
+ * On failure: -1, and errno is set to EINVAL if proc is NULL, entries is 
+ * negative, entries is positive and interval_ms is less than 1, or full is 
+ * not a joblog_full_t value, or by the system library functions used to 
+ * open and write the log, allocate the ring or create the writer thread.
+ */
+int joblog_set_async(proc_t* proc, int entries, int interval_ms, 
+    joblog_full_t full);
+
+/*
+ * joblog_set_sync(proc_t* proc, joblog_sync_t sync, int n)
+ *
+ * Set when the given process' log is synced to the disk (see joblog_sync_t
+ * for the modes and the meaning of n, which is ignored by JOBLOG_SYNC_NONE 
+ * and JOBLOG_SYNC_EVERY). Entries that this process has buffered are 
+ * written first and, unless sync is JOBLOG_SYNC_NONE, the log is synced.
+ * A log is not synced until this function is called for it, and the mode 
+ * is forgotten when the log is closed.
+ *
+ * Usage:
+ *      // lose at most 50 ms of entries in a crash
+ *      joblog_set_sync(proc, JOBLOG_SYNC_INTERVAL, 50);
+ *
+ * Return:
+ * On success: 0
+ * On failure: -1, and errno is set to EINVAL if proc is NULL, sync is not a
+ * joblog_sync_t value, or n is less than 1 for JOBLOG_SYNC_INTERVAL or 
+ * JOBLOG_SYNC_RECORDS, or by the system library functions used to open, 
+ * write and sync the log.
+ */
+int joblog_set_sync(proc_t* proc, joblog_sync_t sync, int n);
+
+/*
+ * joblog_unsynced(proc_t* proc)
+ *
+ * Return:
+ * The number of entries written to the given process' log file since the
+ * log was last synced, which a system crash could lose (0 if the log is not
+ * open or its mode is JOBLOG_SYNC_NONE), or -1 with errno set to EINVAL if 
+ * proc is NULL. Entries still buffered, or in the ring of an asynchronous
+ * log, are not counted.
+ */
+long joblog_unsynced(proc_t* proc);
+
+/*
+ * joblog_set_segment_size(proc_t* proc, size_t size)
+ *
+ * Roll the given process' log over to a new segment whenever the current 
+ * segment would grow beyond size bytes (rounded down to whole entries, and
+ * at least one entry), making the log segmented if it is not (see the 
+ * Introduction). Entries that this process has buffered are written first.
+ * A size of 0 stops the log rolling over, but a segmented log stays 
+ * segmented. The size is forgotten when the log is closed, and a process 
+ * that opens a segmented log again writes to its last segment.
+ *
+ * Usage:
+ *      joblog_set_segment_size(proc, 64 << 20);   // 64 MiB segments
+ *
+ * Return:
+ * On success: 0
+ * On failure: -1, and errno is set to EINVAL if proc is NULL, or by the
+ * system library functions used to open and write the log and its index.
+ */
+int joblog_set_segment_size(proc_t* proc, size_t size);
+
+/*
+ * joblog_delete_segments(proc_t* proc, int entry_num)
+ *
+ * Delete the segments of the given process' segmented log that only have
+ * entries before entry_num. The last segment, which is written to, is never
+ * deleted, and the index keeps the numbering of the entries.
+ *
+ * Usage:
+ *      // keep the segments with the last 1000000 entries
+ *      joblog_delete_segments(proc, joblog_count(proc) - 1000000);
+ *
+ * Return:
+ * On success: the number of segment files deleted (0 if the log is not 
+ * segmented).
+ * On failure: -1, and errno is set to EINVAL if proc is NULL, or by the
+ * system library functions used to read the index.
+ */
+int joblog_delete_segments(proc_t* proc, int entry_num);
+
+/*
+ * joblog_set_compression(proc_t* proc, bool compress)
+ *
+ * Compress each segment of the given process' segmented log when the log
+ * rolls over from it (see COMPRESSED SEGMENTS), if compress is true. The
+ * segment is queued for the writer thread, which is started if it is not 
+ * running, and compressed between its writes. A segment that cannot be 
+ * compressed, or that finds the queue full, is kept as text. With any sync
+ * mode but JOBLOG_SYNC_NONE, a compressed segment is synced before its 
+ * text is removed. The setting is forgotten when the log is closed.
+ *
+ * Usage:
+ *      joblog_set_segment_size(proc, 64 << 20);
+ *      joblog_set_compression(proc, true);
+ *
+ * Return:
+ * On success: 0
+ * On failure: -1, and errno is set to EINVAL if proc is NULL, or by the
+ * system library functions used to open the log or start the writer 
+ * thread.
+ */
+int joblog_set_compression(proc_t* proc, bool compress);
+
+/*
+ * joblog_compress_segments(proc_t* proc, int entry_num)
+ *
+ * Compress the text segments of the given process' segmented log that only
+ * have entries before entry_num (see joblog_delete_segments). The last 
+ * segment is never compressed. It first waits for the writer thread to 
+ * compress the segments queued for the log. This should not be called 
+ * while another process with compression set (see joblog_set_compression)
+ * rolls the log over.
+ *
+ * Usage:
+ *      // compress all but the last segment
+ *      joblog_compress_segments(proc, joblog_count(proc));
+ *
+ * Return:
+ * On success: the number of segments compressed (0 if the log is not 
+ * segmented).
+ * On failure: -1, and errno is set to EINVAL if proc is NULL, or by the
+ * system library functions used to read the index and to read, write and 
+ * rename the segments. Segments compressed before the failure stay 
+ * compressed.
+ */
+int joblog_compress_segments(proc_t* proc, int entry_num);
+
+/*
+ * joblog_dropped(proc_t* proc)
+ *
+ * Return:
+ * The number of jobs dropped because the ring of the given process' 
+ * asynchronous log was full (0 if the log is not asynchronous), or -1 with
+ * errno set to EINVAL if proc is NULL.
+ */
+long joblog_dropped(proc_t* proc);
+
+/*
+ * joblog_cursor_open(proc_t* proc, joblog_cursor_t* cur)
+ *
+ * Open a cursor at the first entry of the given process' log, mapping the
+ * log (every segment of a segmented log) read-only. Entries that this 
+ * process has buffered are written to the log first. A partial entry at 
+ * the end of the log, and the entries of deleted segments, are not part of
+ * the cursor, so the index of an entry of the cursor is only its entry_num
+ * for a log with no deleted segments (see joblog_cursor_entry). Compressed
+ * segments are mapped as 
+ * they are and decoded a block at a time as the cursor reaches them.
+ *
+ * Return:
+ * On success: 0
+ * On failure: -1, and errno is set to EINVAL if proc or cur is NULL, or by
+ * the system library functions used to open, stat and map the log (e.g. 
+ * ENOENT if there is no log).
+ */
+int joblog_cursor_open(proc_t* proc, joblog_cursor_t* cur);
+
+/*
+ * joblog_cursor_range(joblog_cursor_t* cur, int first, int count, 
+ *      joblog_cursor_t* range)
+ *
+ * Set range to a cursor over count entries of cur from the entry at index 
+ * first of cur's range, limited to the entries of cur. range shares the 
+ * mapping of cur and must not be used after cur is closed. Closing range 
+ * has no effect on cur, but range must be closed when it is no longer 
+ * used (before cur), to free the entries it has decoded, and before it is
+ * set to another range.
+ *
+ * Return:
+ * range, or NULL if cur or range is NULL, or first or count is negative.
+ */
+joblog_cursor_t* joblog_cursor_range(joblog_cursor_t* cur, int first, 
+    int count, joblog_cursor_t* range);
+
+/*
+ * joblog_cursor_count(joblog_cursor_t* cur)
+ *
+ * Return:
+ * The number of entries that remain for the cursor, or 0 if cur is NULL.
+ */
+int joblog_cursor_count(joblog_cursor_t* cur);
+
+/*
+ * joblog_cursor_entry(joblog_cursor_t* cur)
+ *
+ * The entry number (see joblog_read) of the next entry of the cursor, 
+ * which differs from its index in the cursor once segments of the log 
+ * have been deleted (see joblog_delete_segments). joblog_cursor_next_str 
+ * returns this entry next, whereas joblog_cursor_next may skip malformed 
+ * entries first.
+ *
+ * Usage:
+ *      int entry_num = joblog_cursor_entry(&cur);
+ *      const char* str = joblog_cursor_next_str(&cur);   // entry_num
+ *
+ * Return:
+ * The entry number, or -1 if cur is NULL or there are no more entries.
+ */
+int joblog_cursor_entry(joblog_cursor_t* cur);
+
+/*
+ * joblog_cursor_next(joblog_cursor_t* cur, job_t* job)
+ *
+ * Convert the next entry of the cursor to a job and advance the cursor. 
+ * Malformed entries (see joblog_read) are skipped and counted in the 
+ * skipped field of the cursor. If job is NULL, a new job is dynamically
+ * allocated (see job_new).
+ *
+ * Return:
+ * A pointer to the job, or NULL if cur is NULL, there are no more entries 
+ * or a job cannot be allocated.
+ */
+job_t* joblog_cursor_next(joblog_cursor_t* cur, job_t* job);
+
+/*
+ * joblog_cursor_next_str(joblog_cursor_t* cur)
+ *
+ * Advance the cursor past its next entry without converting it.
+ *
+ * Return:
+ * A pointer to the text of the entry in the mapping of the log: 
+ * JOB_STR_SIZE - 1 characters of a job string followed by a new line (the 
+ * text is not NUL terminated and must not be modified), or NULL if cur is 
+ * NULL or there are no more entries. The entry is not checked. For an 
+ * entry of a compressed segment the text is that of the decoded entry, a 
+ * malformed entry is JOB_STR_SIZE '?' characters, and the pointer is only
+ * valid until the next call for the cursor.
+ */
+const char* joblog_cursor_next_str(joblog_cursor_t* cur);
+
+/*
+ * joblog_cursor_close(joblog_cursor_t* cur)
+ *
+ * Close the cursor, unmapping the log unless the cursor was made by 
+ * joblog_cursor_range, and freeing the buffer of its decoded entries. Every
+ * cursor must be closed, whether or not it has reached its last entry, or 
+ * the mapping and the buffer are leaked. If cur is NULL this function has 
+ * no effect.
+ */
+void joblog_cursor_close(joblog_cursor_t* cur);
+
 #endif
@@ -0,0 +1,167 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "label_table.h"
+
+#define LABEL_LEN (MAX_NAME_SIZE - 1)
+
+/* the number of entries of the hash index of a table of capacity labels */
+static uint32_t index_entries(int capacity) {
+    uint32_t n = 2;
+    while (n < 2 * (uint32_t) capacity) n <<= 1;
+    return n;
+}
+
+static uint32_t* index_of(label_table_t* lt) {
+    return (uint32_t*) ((char*) lt + lt->index_off);
+}
+
+/* offset of the index, after the labels, aligned for uint32_t */
+static size_t index_offset(int capacity) {
+    size_t off = sizeof(label_table_t) + (size_t) capacity * MAX_NAME_SIZE;
+    return (off + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+}
+
+/* label padded as job_set pads the label of a job */
+static void pad_label(const char* label, char* padded) {
+    if (!label || label[0] == '\0') {
+        memcpy(padded, PAD_STRING, LABEL_LEN);
+    } else {
+        size_t len = strnlen(label, LABEL_LEN);
+        memcpy(padded, label, len);
+        memset(padded + len, '*', LABEL_LEN - len);
+    }
+    padded[LABEL_LEN] = '\0';
+}
+
+/* FNV-1a hash of a padded label */
+static uint32_t hash_label(const char* padded) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < LABEL_LEN; i++) {
+        h ^= (unsigned char) padded[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/*
+ * the index entry of a padded label, or of the empty entry where it would
+ * be added if it is not in the table
+ */
+static uint32_t index_slot(label_table_t* lt, const char* padded) {
+    uint32_t* index = index_of(lt);
+    uint32_t e = hash_label(padded) & lt->index_mask;
+
+    while (index[e] != LABEL_NONE
+        && memcmp(lt->labels[index[e]], padded, LABEL_LEN) != 0)
+        e = (e + 1) & lt->index_mask;
+
+    return e;
+}
+
+label_table_t* label_table_new(int capacity) {
+    if (capacity < 1) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    label_table_t* lt = (label_table_t*) malloc(label_table_sizeof(capacity));
+    return label_table_init(lt, capacity);
+}
+
+size_t label_table_sizeof(int capacity) {
+    if (capacity < 1) return 0;
+    return index_offset(capacity)
+        + index_entries(capacity) * sizeof(uint32_t);
+}
+
+label_table_t* label_table_init(label_table_t* lt, int capacity) {
+    if (!lt || capacity < 1) return NULL;
+
+    lt->capacity = capacity;
+    lt->count = 0;
+    lt->index_mask = index_entries(capacity) - 1;
+    lt->index_off = index_offset(capacity);
+
+    uint32_t* index = index_of(lt);
+    for (uint32_t e = 0; e <= lt->index_mask; e++)
+        index[e] = LABEL_NONE;
+
+    return lt;
+}
+
+uint32_t label_table_intern(label_table_t* lt, const char* label) {
+    if (!lt) return LABEL_NONE;
+
+    char padded[MAX_NAME_SIZE];
+    pad_label(label, padded);
+
+    uint32_t e = index_slot(lt, padded);
+    uint32_t* index = index_of(lt);
+
+    if (index[e] != LABEL_NONE) return index[e];
+    if (lt->count == lt->capacity) return LABEL_NONE;
+
+    memcpy(lt->labels[lt->count], padded, MAX_NAME_SIZE);
+    index[e] = (uint32_t) lt->count++;
+    return index[e];
+}
+
+uint32_t label_table_find(label_table_t* lt, const char* label) {
+    if (!lt) return LABEL_NONE;
+
+    char padded[MAX_NAME_SIZE];
+    pad_label(label, padded);
+
+    return index_of(lt)[index_slot(lt, padded)];
+}
+
+const char* label_table_label(label_table_t* lt, uint32_t id) {
+    if (!lt || id >= (uint32_t) lt->count) return NULL;
+    return lt->labels[id];
+}
+
+int label_table_count(label_table_t* lt) {
+    return lt ? lt->count : 0;
+}
+
+compact_job_t* label_table_compact(label_table_t* lt, job_t* job,
+    compact_job_t* dst) {
+    if (!lt || !job || !dst
+        || strnlen(job->label, MAX_NAME_SIZE) != LABEL_LEN)
+        return NULL;
+
+    uint32_t label = label_table_intern(lt, job->label);
+    if (label == LABEL_NONE) return NULL;
+
+    dst->pid = job->pid;
+    dst->id = job->id;
+    dst->priority = job->priority;
+    dst->label = label;
+    return dst;
+}
+
+job_t* label_table_expand(label_table_t* lt, compact_job_t* cjob, job_t* dst) {
+    if (!cjob) return NULL;
+
+    const char* label = label_table_label(lt, cjob->label);
+    if (!label) return NULL;
+
+    if (!dst) return job_new(cjob->pid, cjob->id, cjob->priority, label);
+
+    dst->pid = cjob->pid;
+    dst->id = cjob->id;
+    dst->priority = cjob->priority;
+    memcpy(dst->label, label, MAX_NAME_SIZE);
+    return dst;
+}
+
+char* label_table_to_str(label_table_t* lt, compact_job_t* cjob, char* str) {
+    job_t job;
+    if (!label_table_expand(lt, cjob, &job)) return NULL;
+    return job_to_str(&job, str);
+}
+
+void label_table_delete(label_table_t* lt) {
+    free(lt);
+}
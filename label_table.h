@@ -0,0 +1,217 @@
+#ifndef _LABEL_TABLE_H
+#define _LABEL_TABLE_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "job.h"
+
+/* the default number of distinct labels a table can hold */
+#define LABEL_TABLE_SIZE 256
+
+/* the id returned for a label that cannot be interned */
+#define LABEL_NONE UINT32_MAX
+
+/*
+ * Introduction
+ *
+ * This header defines a label table (label_table_t) that interns job labels,
+ * mapping each distinct label to a 32-bit id, and a compact job
+ * (compact_job_t) that holds the id of its label in place of the label.
+ * A compact job is 16 bytes instead of the 44 bytes of a job_t, so an array
+ * of compact jobs takes about a third of the memory of the same jobs and
+ * copying or comparing compact jobs does not touch their labels.
+ *
+ * The functions:
+ *      label_table_new(int capacity)
+ *      label_table_sizeof(int capacity)
+ *      label_table_init(label_table_t* lt, int capacity)
+ *      label_table_intern(label_table_t* lt, const char* label)
+ *      label_table_find(label_table_t* lt, const char* label)
+ *      label_table_label(label_table_t* lt, uint32_t id)
+ *      label_table_count(label_table_t* lt)
+ *      label_table_compact(label_table_t* lt, job_t* job,
+ *          compact_job_t* dst)
+ *      label_table_expand(label_table_t* lt, compact_job_t* cjob,
+ *          job_t* dst)
+ *      label_table_to_str(label_table_t* lt, compact_job_t* cjob, char* str)
+ *      label_table_delete(label_table_t* lt)
+ * create and initialise a table, intern and look up labels, convert jobs to
+ * and from compact jobs, convert a compact job to the string representation
+ * of its job (see JOB_STR_FMT in job.h) and deallocate a table.
+ *
+ * LABELS
+ *
+ * Labels are interned in the form that job_set gives them: padded with '*'
+ * to MAX_NAME_SIZE - 1 characters, with PAD_STRING for an empty or NULL
+ * label. So "a" and "a" padded with '*' are the same label and have the same
+ * id. Ids are given in order from 0 and a label is never removed from a
+ * table, so the id of a label does not change for the lifetime of the table
+ * and a compact job stays valid for as long as its table.
+ *
+ * TABLE MEMORY
+ *
+ * Like a pri_jobqueue (see pri_jobqueue.h), a table occupies a single block
+ * of label_table_sizeof(capacity) bytes that contains no pointers, so a
+ * table can be placed in shared memory and used by processes that map it at
+ * different addresses. The table does no locking: processes that share a
+ * table must serialise label_table_intern with each other (for example, by
+ * interning under the lock that protects a queue of compact jobs). Lookups
+ * of ids that a process has already been given need no lock.
+ */
+
+/*
+ * Definition of struct label_table - a set of interned labels and a hash
+ * index of them.
+ *
+ * Type alias:
+ * A struct label_table can also be referred to as label_table_t
+ *
+ * Fields:
+ * capacity - the maximum number of distinct labels in the table
+ * count - the number of labels in the table, which is also the next id
+ * index_mask - the number of entries of the hash index less one (the number
+ *      of entries is a power of 2 that is at least twice the capacity)
+ * index_off - the offset, from the start of the table, of the hash index,
+ *      an array of the ids of labels (LABEL_NONE for an empty entry)
+ * labels - the labels of the table, indexed by id
+ */
+typedef struct label_table {
+    int capacity;
+    int count;
+    uint32_t index_mask;
+    size_t index_off;
+    char labels[][MAX_NAME_SIZE];
+} label_table_t;
+
+/*
+ * Definition of struct compact_job - a job whose label is held as the id of
+ * the label in a label table.
+ *
+ * Type alias:
+ * A struct compact_job can also be referred to as compact_job_t
+ *
+ * Fields:
+ * pid, id, priority - as for a job_t (see job.h)
+ * label - the id of the job's label in a label table
+ */
+typedef struct compact_job {
+    pid_t pid;
+    unsigned int id;
+    unsigned int priority;
+    uint32_t label;
+} compact_job_t;
+
+/*
+ * label_table_new(int capacity)
+ *
+ * Creates a new label table, on the heap, for up to capacity labels.
+ *
+ * Return:
+ * A pointer to the new table, or NULL if capacity is less than 1 (errno is
+ * set to EINVAL) or memory cannot be allocated.
+ */
+label_table_t* label_table_new(int capacity);
+
+/*
+ * label_table_sizeof(int capacity)
+ *
+ * Return:
+ * The size in bytes of the block of memory for a table of capacity labels,
+ * or 0 if capacity is less than 1.
+ */
+size_t label_table_sizeof(int capacity);
+
+/*
+ * label_table_init(label_table_t* lt, int capacity)
+ *
+ * Initialises a table of capacity labels in a block of memory of at least
+ * label_table_sizeof(capacity) bytes to be empty.
+ *
+ * Return:
+ * lt, or NULL if lt is NULL or capacity is less than 1.
+ */
+label_table_t* label_table_init(label_table_t* lt, int capacity);
+
+/*
+ * label_table_intern(label_table_t* lt, const char* label)
+ *
+ * Adds label to the table, if it is not already in the table, in expected
+ * constant time.
+ *
+ * Return:
+ * The id of label, or LABEL_NONE if lt is NULL or label is not in the table
+ * and the table is full.
+ */
+uint32_t label_table_intern(label_table_t* lt, const char* label);
+
+/*
+ * label_table_find(label_table_t* lt, const char* label)
+ *
+ * Return:
+ * The id of label, or LABEL_NONE if lt is NULL or label is not in the table.
+ */
+uint32_t label_table_find(label_table_t* lt, const char* label);
+
+/*
+ * label_table_label(label_table_t* lt, uint32_t id)
+ *
+ * Return:
+ * The label with the given id (a string of length MAX_NAME_SIZE - 1 in the
+ * table, which must not be modified), or NULL if lt is NULL or there is no
+ * such label.
+ */
+const char* label_table_label(label_table_t* lt, uint32_t id);
+
+/*
+ * label_table_count(label_table_t* lt)
+ *
+ * Return:
+ * The number of labels in the table, or 0 if lt is NULL.
+ */
+int label_table_count(label_table_t* lt);
+
+/*
+ * label_table_compact(label_table_t* lt, job_t* job, compact_job_t* dst)
+ *
+ * Sets dst to the compact form of job, interning the label of job.
+ *
+ * Return:
+ * dst, or NULL if any argument is NULL, the label of job is not a string of
+ * length MAX_NAME_SIZE - 1 or it cannot be interned.
+ */
+compact_job_t* label_table_compact(label_table_t* lt, job_t* job,
+    compact_job_t* dst);
+
+/*
+ * label_table_expand(label_table_t* lt, compact_job_t* cjob, job_t* dst)
+ *
+ * Sets dst to the job of which cjob is the compact form. If dst is NULL a
+ * new job is allocated (see job_new).
+ *
+ * Return:
+ * A pointer to the job, or NULL if lt or cjob is NULL, the label id of cjob
+ * is not in the table or a job cannot be allocated.
+ */
+job_t* label_table_expand(label_table_t* lt, compact_job_t* cjob, job_t* dst);
+
+/*
+ * label_table_to_str(label_table_t* lt, compact_job_t* cjob, char* str)
+ *
+ * Converts cjob to the string representation of its job, as job_to_str. If
+ * str is NULL a new string of JOB_STR_SIZE bytes is allocated.
+ *
+ * Return:
+ * A pointer to the string, or NULL if lt or cjob is NULL, the label id of
+ * cjob is not in the table or the conversion fails.
+ */
+char* label_table_to_str(label_table_t* lt, compact_job_t* cjob, char* str);
+
+/*
+ * label_table_delete(label_table_t* lt)
+ *
+ * Deallocates a table created by label_table_new. If lt is NULL this
+ * function has no effect.
+ */
+void label_table_delete(label_table_t* lt);
+
+#endif
@@ -5,111 +5,1016 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <errno.h>
 #include "pri_jobqueue.h"
+#include "pri_search.h"
+
+/* per-slot arrays of the queue, located by offset from the struct */
+#define PJQ_ARRAY(pjq, type, off) ((type*) ((char*) (pjq) + (pjq)->off))
+#define PRIOS(pjq) PJQ_ARRAY(pjq, unsigned int, prios_off)
+#define STAMPS(pjq) PJQ_ARRAY(pjq, unsigned int, stamps_off)
+#define KEYS(pjq) PJQ_ARRAY(pjq, uint64_t, keys_off)
+#define DEADLINES(pjq) PJQ_ARRAY(pjq, uint64_t, deadlines_off)
+#define OCCUPIED(pjq) PJQ_ARRAY(pjq, uint64_t, occupied_off)
+
+#define WORD_BITS 64
+#define OCCUPIED_WORDS(capacity) (((capacity) + WORD_BITS - 1) / WORD_BITS)
+#define HEAP(pjq) PJQ_ARRAY(pjq, int, heap_off)
+#define NEXT(pjq) PJQ_ARRAY(pjq, int, next_off)
+#define PREV(pjq) PJQ_ARRAY(pjq, int, prev_off)
+#define POS(pjq) PJQ_ARRAY(pjq, int, pos_off)
+#define INDEX(pjq) PJQ_ARRAY(pjq, int, index_off)
+#define LABELS(pjq) PJQ_ARRAY(pjq, label_table_t, labels_off)
+
+/* the slots of a queue with a label table are compact jobs */
+#define CJOBS(pjq) ((compact_job_t*) (pjq)->jobs)
+
+static bool valid_levels(int levels) {
+    return levels >= 1 && levels <= PRI_JOBQUEUE_MAX_LEVELS;
+}
+
+static bool valid_capacity(int capacity) {
+    return capacity >= 1 && capacity <= PRI_JOBQUEUE_MAX_CAPACITY;
+}
+
+static bool valid_labels(int labels) {
+    return labels >= 1 && labels <= PRI_JOBQUEUE_MAX_LABELS;
+}
+
+/* the number of entries of the (pid, id) index, a power of 2 >= 2 * capacity */
+static size_t index_entries(int capacity) {
+    size_t entries = 2;
+    while (entries < 2 * (size_t) capacity)
+        entries *= 2;
+    return entries;
+}
+
+/* 
+ * lay out the per-slot arrays after the jobs buffer, and a label table of
+ * labels labels after them if labels is not 0 (compact slots), setting their
+ * offsets in pjq if it is not NULL, and return the total size of the queue
+ */
+static size_t place_arrays(pri_jobqueue_t* pjq, int capacity, int labels) {
+    size_t n = (size_t) capacity;
+    size_t slot_size = labels ? sizeof(compact_job_t) : sizeof(job_t);
+    size_t off = offsetof(pri_jobqueue_t, jobs) + n * slot_size;
+
+    /* the 64-bit arrays come first, aligned as the struct itself is */
+    off = (off + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+    size_t deadlines_off = off;
+    off += n * sizeof(uint64_t);
+    size_t occupied_off = off;
+    off += OCCUPIED_WORDS(n) * sizeof(uint64_t);
+    size_t keys_off = off;
+    off += n * sizeof(uint64_t);
+    size_t prios_off = off;
+    off += n * sizeof(unsigned int);
+    size_t stamps_off = off;
+    off += n * sizeof(unsigned int);
+    size_t heap_off = off;
+    off += n * sizeof(int);
+    size_t next_off = off;
+    off += n * sizeof(int);
+    size_t prev_off = off;
+    off += n * sizeof(int);
+    size_t pos_off = off;
+    off += n * sizeof(int);
+    size_t index_off = off;
+    off += index_entries(capacity) * sizeof(int);
+    size_t labels_off = 0;
+    if (labels) {
+        off = (off + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+        labels_off = off;
+        off += label_table_sizeof(labels);
+    }
+
+    if (pjq) {
+        pjq->prios_off = prios_off;
+        pjq->stamps_off = stamps_off;
+        pjq->keys_off = keys_off;
+        pjq->deadlines_off = deadlines_off;
+        pjq->occupied_off = occupied_off;
+        pjq->heap_off = heap_off;
+        pjq->next_off = next_off;
+        pjq->prev_off = prev_off;
+        pjq->pos_off = pos_off;
+        pjq->index_off = index_off;
+        pjq->labels_off = labels_off;
+        pjq->index_mask = (unsigned int) index_entries(capacity) - 1;
+    }
+
+    return off;
+}
+
+static bool is_compact(pri_jobqueue_t* pjq) {
+    return pjq->labels_off != 0;
+}
+
+/* the pid, id and priority of the job held in a slot, of either slot type */
+static pid_t slot_pid(pri_jobqueue_t* pjq, int slot) {
+    return is_compact(pjq) ? CJOBS(pjq)[slot].pid : pjq->jobs[slot].pid;
+}
+
+static unsigned int slot_id(pri_jobqueue_t* pjq, int slot) {
+    return is_compact(pjq) ? CJOBS(pjq)[slot].id : pjq->jobs[slot].id;
+}
+
+static unsigned int held_priority(pri_jobqueue_t* pjq, int slot) {
+    if (is_compact(pjq)) return CJOBS(pjq)[slot].priority;
+    return pjq->jobs[slot].priority;
+}
+
+static void set_held_priority(pri_jobqueue_t* pjq, int slot, 
+    unsigned int priority) {
+    if (is_compact(pjq))
+        CJOBS(pjq)[slot].priority = priority;
+    else
+        pjq->jobs[slot].priority = priority;
+}
+
+/* 
+ * copy job to a slot, false if its label is not valid or, for compact slots,
+ * cannot be interned because the label table is full (errno is ENOSPC)
+ */
+static bool store_slot(pri_jobqueue_t* pjq, int slot, job_t* job) {
+    if (!is_compact(pjq)) return job_copy(job, &pjq->jobs[slot]);
+
+    if (label_table_compact(LABELS(pjq), job, &CJOBS(pjq)[slot])) return true;
+    if (strnlen(job->label, MAX_NAME_SIZE) == MAX_NAME_SIZE - 1) 
+        errno = ENOSPC;
+    return false;
+}
+
+/* copy the job in a slot to dst, or to a new job if dst is NULL */
+static job_t* load_slot(pri_jobqueue_t* pjq, int slot, job_t* dst) {
+    if (is_compact(pjq))
+        return label_table_expand(LABELS(pjq), &CJOBS(pjq)[slot], dst);
+
+    job_t* job = &pjq->jobs[slot];
+    if (!dst) return job_new(job->pid, job->id, job->priority, job->label);
+    job_copy(job, dst);
+    return dst;
+}
+
+static void clear_slot(pri_jobqueue_t* pjq, int slot) {
+    if (is_compact(pjq))
+        CJOBS(pjq)[slot] = (compact_job_t) { 0, 0, 0, LABEL_NONE };
+    else
+        job_init(&pjq->jobs[slot]);
+}
+
+static unsigned int slot_priority(pri_jobqueue_t* pjq, int slot) {
+    if (pjq->layout == PRI_JOBQUEUE_AOS) return held_priority(pjq, slot);
+    return PRIOS(pjq)[slot];
+}
+
+static bool is_aging(pri_jobqueue_t* pjq) {
+    return pjq->aging != PRI_JOBQUEUE_AGE_NONE;
+}
+
+static bool by_deadline(pri_jobqueue_t* pjq) {
+    return pjq->order == PRI_JOBQUEUE_BY_DEADLINE;
+}
+
+/* the current value of the aging clock of the queue, from its last reset */
+static uint64_t age_clock(pri_jobqueue_t* pjq) {
+    if (pjq->aging == PRI_JOBQUEUE_AGE_DEQUEUES) return pjq->dequeues;
+    return job_clock_ms() - pjq->age_base;
+}
+
+/* 
+ * the aging key of a job of the given priority enqueued now, which cannot 
+ * wrap: priority * age_step is below 2^64 - 2^33, and the key saturates
+ * if the clock passes 2^33 units on a queue with such keys
+ */
+static uint64_t age_key(pri_jobqueue_t* pjq, unsigned int priority) {
+    uint64_t key = (uint64_t) priority * pjq->age_step;
+    uint64_t clock = age_clock(pjq);
+    return key > UINT64_MAX - clock ? UINT64_MAX : key + clock;
+}
+
+/* true if the job in slot a is dequeued before the job in slot b */
+static bool slot_before(pri_jobqueue_t* pjq, int a, int b) {
+    if (by_deadline(pjq)) {
+        uint64_t* deadlines = DEADLINES(pjq);
+        if (deadlines[a] != deadlines[b]) return deadlines[a] < deadlines[b];
+    }
+
+    if (is_aging(pjq)) {
+        uint64_t* keys = KEYS(pjq);
+        if (keys[a] != keys[b]) return keys[a] < keys[b];
+    } else {
+        unsigned int pa = slot_priority(pjq, a);
+        unsigned int pb = slot_priority(pjq, b);
+        if (pa != pb) return pa < pb;
+    }
+
+    /* stamps wrap, so compare them by their signed distance */
+    unsigned int* stamps = STAMPS(pjq);
+    return (int) (stamps[a] - stamps[b]) < 0;
+}
+
+/* swap two heap entries, keeping the heap position of each slot */
+static void heap_swap(pri_jobqueue_t* pjq, int i, int j) {
+    int* heap = HEAP(pjq);
+    int* pos = POS(pjq);
+    int t = heap[i];
+
+    heap[i] = heap[j];
+    heap[j] = t;
+    pos[heap[i]] = i;
+    pos[heap[j]] = j;
+}
+
+static void heap_sift_up(pri_jobqueue_t* pjq, int i) {
+    int* heap = HEAP(pjq);
+
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!slot_before(pjq, heap[i], heap[parent])) break;
+        heap_swap(pjq, i, parent);
+        i = parent;
+    }
+}
+
+static void heap_sift_down(pri_jobqueue_t* pjq, int i, int n) {
+    int* heap = HEAP(pjq);
+
+    for (;;) {
+        int least = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+
+        if (left < n && slot_before(pjq, heap[left], heap[least]))
+            least = left;
+        if (right < n && slot_before(pjq, heap[right], heap[least]))
+            least = right;
+        if (least == i) break;
+
+        heap_swap(pjq, i, least);
+        i = least;
+    }
+}
+
+/* true if slot holds a job that is on the queue (not free or borrowed) */
+static bool slot_queued_aos(pri_jobqueue_t* pjq, int slot) {
+    if (held_priority(pjq, slot) == 0) return false;
+    return pjq->borrowed == 0 || PRIOS(pjq)[slot] != 0;
+}
+
+static int scan_top_aos(pri_jobqueue_t* pjq) {
+    int top = -1;
+
+    for (int i = 0; i < pjq->buf_size; i++) {
+        if (slot_queued_aos(pjq, i) && (top < 0 || slot_before(pjq, i, top)))
+            top = i;
+    }
+
+    return top;
+}
+
+/* 
+ * as scan_top_aos but searches the dense priorities for the highest priority
+ * and then only compares the stamps of the slots with that priority
+ */
+static int scan_top_soa(pri_jobqueue_t* pjq) {
+    unsigned int* prios = PRIOS(pjq);
+    unsigned int* stamps = STAMPS(pjq);
+    int n = pjq->buf_size;
+
+    unsigned int pri = pri_search_min(prios, n);
+    if (pri == 0) return -1;
+
+    int top = pri_search_find(prios, n, 0, pri);
+    for (int i = pri_search_find(prios, n, top + 1, pri); i >= 0;
+         i = pri_search_find(prios, n, i + 1, pri)) {
+        if ((int) (stamps[i] - stamps[top]) < 0)
+            top = i;
+    }
+
+    return top;
+}
+
+/* 
+ * with aging or deadlines the order does not follow priorities, so every 
+ * queued slot (one with a dense priority, whatever the layout) is compared
+ */
+static int scan_top_ordered(pri_jobqueue_t* pjq) {
+    unsigned int* prios = PRIOS(pjq);
+    int top = -1;
+
+    for (int i = 0; i < pjq->buf_size; i++) {
+        if (prios[i] != 0 && (top < 0 || slot_before(pjq, i, top)))
+            top = i;
+    }
+
+    return top;
+}
+
+static int scan_top(pri_jobqueue_t* pjq) {
+    if (is_aging(pjq) || by_deadline(pjq)) return scan_top_ordered(pjq);
+    if (pjq->layout == PRI_JOBQUEUE_AOS) return scan_top_aos(pjq);
+    return scan_top_soa(pjq);
+}
+
+static void heap_push(pri_jobqueue_t* pjq, int slot) {
+    HEAP(pjq)[pjq->heap_size] = slot;
+    POS(pjq)[slot] = pjq->heap_size;
+    heap_sift_up(pjq, pjq->heap_size++);
+}
+
+/* remove the entry at index i from anywhere in the heap */
+static void heap_remove(pri_jobqueue_t* pjq, int i) {
+    int* heap = HEAP(pjq);
+    int last = --pjq->heap_size;
+
+    if (i == last) return;
+
+    heap[i] = heap[last];
+    POS(pjq)[heap[i]] = i;
+    heap_sift_down(pjq, i, last);
+    heap_sift_up(pjq, i);
+}
+
+/* 
+ * the level list of a job of the PRI_JOBQUEUE_BUCKET engine, or -1 if its 
+ * priority is above the levels of the queue or the queue is ordered by 
+ * deadline and it belongs on the heap
+ */
+static int level_of(pri_jobqueue_t* pjq, int slot) {
+    if (pjq->engine != PRI_JOBQUEUE_BUCKET || by_deadline(pjq)) return -1;
+
+    unsigned int priority = slot_priority(pjq, slot);
+    return priority <= (unsigned int) pjq->levels ? (int) priority - 1 : -1;
+}
+
+/* 
+ * append a slot to its level list, lists are FIFO so that jobs of a level 
+ * are dequeued in the order of their stamps
+ */
+static void level_push(pri_jobqueue_t* pjq, int level, int slot) {
+    NEXT(pjq)[slot] = -1;
+    PREV(pjq)[slot] = pjq->level_tail[level];
+
+    if (pjq->level_head[level] < 0)
+        pjq->level_head[level] = slot;
+    else
+        NEXT(pjq)[pjq->level_tail[level]] = slot;
+
+    pjq->level_tail[level] = slot;
+    pjq->level_map |= (uint64_t) 1 << level;
+}
+
+/* unlink a slot from anywhere in its level list */
+static void level_remove(pri_jobqueue_t* pjq, int level, int slot) {
+    int* next = NEXT(pjq);
+    int* prev = PREV(pjq);
+
+    if (prev[slot] < 0)
+        pjq->level_head[level] = next[slot];
+    else
+        next[prev[slot]] = next[slot];
+
+    if (next[slot] < 0)
+        pjq->level_tail[level] = prev[slot];
+    else
+        prev[next[slot]] = prev[slot];
+
+    if (pjq->level_head[level] < 0)
+        pjq->level_map &= ~((uint64_t) 1 << level);
+}
+
+/* the lowest non-empty level, the map must not be empty */
+static int first_level(pri_jobqueue_t* pjq) {
+    return __builtin_ctzll(pjq->level_map);
+}
+
+/* 
+ * the level whose head is dequeued next, or -1 if it is the top of the heap.
+ * Without aging, listed jobs always have higher priority than those on the 
+ * heap. With aging, the head of each list has the least key of its level, 
+ * so the heads of the non-empty levels and the top of the heap are compared.
+ */
+static int top_level(pri_jobqueue_t* pjq) {
+    if (!pjq->level_map) return -1;
+    if (!is_aging(pjq)) return first_level(pjq);
+
+    int top = pjq->heap_size > 0 ? HEAP(pjq)[0] : -1;
+    int level = -1;
+
+    for (uint64_t map = pjq->level_map; map; map &= map - 1) {
+        int l = __builtin_ctzll(map);
+        int head = pjq->level_head[l];
+        if (top < 0 || slot_before(pjq, head, top)) {
+            top = head;
+            level = l;
+        }
+    }
+
+    return level;
+}
+
+/* the slot of the highest priority job, or -1 if there is none */
+static int top_slot(pri_jobqueue_t* pjq) {
+    if (pjq->engine == PRI_JOBQUEUE_SCAN) return scan_top(pjq);
+
+    if (pjq->engine == PRI_JOBQUEUE_BUCKET) {
+        int level = top_level(pjq);
+        if (level >= 0) return pjq->level_head[level];
+    }
+
+    return pjq->heap_size > 0 ? HEAP(pjq)[0] : -1;
+}
+
+static void insert_slot(pri_jobqueue_t* pjq, int slot) {
+    if (pjq->engine == PRI_JOBQUEUE_SCAN) return;
+
+    int level = level_of(pjq, slot);
+
+    if (level >= 0)
+        level_push(pjq, level, slot);
+    else
+        heap_push(pjq, slot);
+}
+
+/* take a queued slot off the engine's ordering */
+static void unlink_slot(pri_jobqueue_t* pjq, int slot) {
+    if (pjq->engine == PRI_JOBQUEUE_SCAN) return;
+
+    int level = level_of(pjq, slot);
+
+    if (level >= 0)
+        level_remove(pjq, level, slot);
+    else
+        heap_remove(pjq, POS(pjq)[slot]);
+}
+
+/* 
+ * the (pid, id) index is an open addressing hash table of slots with linear
+ * probing. Deletion shifts later entries of a probe sequence back into the
+ * gap, so there are no tombstones and a probe ends at the first empty entry.
+ */
+static unsigned int index_home(pri_jobqueue_t* pjq, pid_t pid, 
+    unsigned int id) {
+    unsigned int h = (unsigned int) pid * 0x9e3779b1u ^ id * 0x85ebca77u;
+    h ^= h >> 16;
+    return h & pjq->index_mask;
+}
+
+static unsigned int slot_home(pri_jobqueue_t* pjq, int slot) {
+    return index_home(pjq, slot_pid(pjq, slot), slot_id(pjq, slot));
+}
+
+static void index_insert(pri_jobqueue_t* pjq, int slot) {
+    int* index = INDEX(pjq);
+    unsigned int i = slot_home(pjq, slot);
+
+    while (index[i] >= 0)
+        i = (i + 1) & pjq->index_mask;
+
+    index[i] = slot;
+}
+
+/* 
+ * the index entry of the queued job with the given pid and id, or -1. Of 
+ * jobs with the same pid and id, which are all in the one probe sequence, 
+ * it is the one with the oldest stamp (enqueued or reprioritised first).
+ */
+static int index_find(pri_jobqueue_t* pjq, pid_t pid, unsigned int id) {
+    int* index = INDEX(pjq);
+    unsigned int* stamps = STAMPS(pjq);
+    int found = -1;
+
+    for (unsigned int i = index_home(pjq, pid, id); index[i] >= 0; 
+         i = (i + 1) & pjq->index_mask) {
+        if (slot_pid(pjq, index[i]) == pid && slot_id(pjq, index[i]) == id 
+            && (found < 0 
+            || (int) (stamps[index[i]] - stamps[index[found]]) < 0))
+            found = (int) i;
+    }
+
+    return found;
+}
+
+static void index_delete(pri_jobqueue_t* pjq, unsigned int i) {
+    int* index = INDEX(pjq);
+    unsigned int mask = pjq->index_mask;
+
+    for (unsigned int j = (i + 1) & mask; index[j] >= 0; j = (j + 1) & mask) {
+        unsigned int home = slot_home(pjq, index[j]);
+
+        /* an entry stays if its home is cyclically in (i, j] */
+        bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+        if (stays) continue;
+
+        index[i] = index[j];
+        i = j;
+    }
+
+    index[i] = -1;
+}
+
+static void index_remove(pri_jobqueue_t* pjq, int slot) {
+    int* index = INDEX(pjq);
+    unsigned int i = slot_home(pjq, slot);
+
+    while (index[i] != slot)
+        i = (i + 1) & pjq->index_mask;
+
+    index_delete(pjq, i);
+}
+
+/* a queued slot leaves the queue, its job is still in the slot */
+static void remove_slot(pri_jobqueue_t* pjq, int slot) {
+    unlink_slot(pjq, slot);
+    index_remove(pjq, slot);
+}
+
+/* 
+ * a slot leaves the queue by dequeue or borrow, which advances the 
+ * PRI_JOBQUEUE_AGE_DEQUEUES clock
+ */
+static void take_slot(pri_jobqueue_t* pjq, int slot) {
+    pjq->dequeues++;
+    remove_slot(pjq, slot);
+}
+
+static void mark_free(pri_jobqueue_t* pjq, int slot) {
+    int word = slot / WORD_BITS;
+
+    OCCUPIED(pjq)[word] &= ~((uint64_t) 1 << (slot % WORD_BITS));
+    if (word < pjq->free_hint)
+        pjq->free_hint = word;
+}
+
+/* the lowest unused slot, or -1 if every slot is in use */
+static int find_free(pri_jobqueue_t* pjq) {
+    uint64_t* occupied = OCCUPIED(pjq);
+    int words = OCCUPIED_WORDS(pjq->buf_size);
+
+    for (int w = pjq->free_hint; w < words; w++) {
+        if (~occupied[w]) {
+            pjq->free_hint = w;
+            return w * WORD_BITS + __builtin_ctzll(~occupied[w]);
+        }
+    }
+
+    pjq->free_hint = words;
+    return -1;
+}
+
+static void mark_used(pri_jobqueue_t* pjq, int slot) {
+    OCCUPIED(pjq)[slot / WORD_BITS] |= (uint64_t) 1 << (slot % WORD_BITS);
+}
+
+/* return the slot of a dequeued or committed job to the unused state */
+static void release_slot(pri_jobqueue_t* pjq, int slot) {
+    clear_slot(pjq, slot);
+    PRIOS(pjq)[slot] = 0;
+    mark_free(pjq, slot);
+}
+
+/* true if no slot is in use, so that the slots can be reset */
+static bool is_idle(pri_jobqueue_t* pjq) {
+    return pjq->size == 0 && pjq->borrowed == 0;
+}
+
+static void reset_slots(pri_jobqueue_t* pjq) {
+    uint64_t* occupied = OCCUPIED(pjq);
+    int words = OCCUPIED_WORDS(pjq->buf_size);
+
+    pjq->seq = 0;
+    pjq->dequeues = 0;
+    pjq->age_base = job_clock_ms();
+    pjq->heap_size = 0;
+    pjq->borrowed = 0;
+    pjq->level_map = 0;
+
+    for (int l = 0; l < PRI_JOBQUEUE_MAX_LEVELS; l++) {
+        pjq->level_head[l] = -1;
+        pjq->level_tail[l] = -1;
+    }
+
+    for (unsigned int i = 0; i <= pjq->index_mask; i++)
+        INDEX(pjq)[i] = -1;
+
+    /* bits past the last slot are marked used so they are never found */
+    for (int w = 0; w < words; w++)
+        occupied[w] = 0;
+    if (pjq->buf_size % WORD_BITS)
+        occupied[words - 1] = ~(uint64_t) 0 << (pjq->buf_size % WORD_BITS);
+    pjq->free_hint = 0;
+}
 
 pri_jobqueue_t* pri_jobqueue_new() {
-    pri_jobqueue_t* pjq = (pri_jobqueue_t*)malloc(sizeof(pri_jobqueue_t));
+    return pri_jobqueue_new_sized(JOB_BUFFER_SIZE);
+}
+
+pri_jobqueue_t* pri_jobqueue_new_sized(int capacity) {
+    if (!valid_capacity(capacity)) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    size_t size = place_arrays(NULL, capacity, 0);
+    pri_jobqueue_t* pjq = (pri_jobqueue_t*)malloc(size);
     if (!pjq) return NULL;
 
-    pri_jobqueue_init(pjq);
+    pri_jobqueue_init_sized(pjq, capacity);
     return pjq;
 }
 
+size_t pri_jobqueue_sizeof(int capacity) {
+    return valid_capacity(capacity) ? place_arrays(NULL, capacity, 0) : 0;
+}
+
 void pri_jobqueue_init(pri_jobqueue_t* pjq) {
-    if (!pjq) return;
+    pri_jobqueue_init_sized(pjq, JOB_BUFFER_SIZE);
+}
 
-    pjq->buf_size = JOB_BUFFER_SIZE;
+/* initialise a queue of capacity slots, compact if labels is not 0 */
+static void init_queue(pri_jobqueue_t* pjq, int capacity, int labels) {
+
+    pjq->buf_size = capacity;
     pjq->size = 0;
+    pjq->engine = PRI_JOBQUEUE_HEAP;
+    pjq->levels = PRI_JOBQUEUE_LEVELS;
+    pjq->layout = PRI_JOBQUEUE_SOA;
+    pjq->aging = PRI_JOBQUEUE_AGE_NONE;
+    pjq->age_step = 0;
+    pjq->order = PRI_JOBQUEUE_BY_PRIORITY;
+    place_arrays(pjq, capacity, labels);
 
-    for (int i = 0; i < pjq->buf_size; i++) {
-        job_init(&pjq->jobs[i]);
+    if (labels) {
+        label_table_init(LABELS(pjq), labels);
+        for (int i = 0; i < capacity; i++)
+            clear_slot(pjq, i);
+    } else {
+        job_init_n(pjq->jobs, capacity);
     }
+    memset(PRIOS(pjq), 0, capacity * sizeof(PRIOS(pjq)[0]));
+    memset(STAMPS(pjq), 0, capacity * sizeof(STAMPS(pjq)[0]));
+    memset(KEYS(pjq), 0, capacity * sizeof(KEYS(pjq)[0]));
+    /* JOB_NO_DEADLINE is all ones */
+    memset(DEADLINES(pjq), 0xff, capacity * sizeof(DEADLINES(pjq)[0]));
+
+    reset_slots(pjq);
 }
 
-job_t* pri_jobqueue_dequeue(pri_jobqueue_t* pjq, job_t* dst) {
-    if (!pjq || pri_jobqueue_is_empty(pjq)) return NULL;
+int pri_jobqueue_init_sized(pri_jobqueue_t* pjq, int capacity) {
+    if (!pjq || !valid_capacity(capacity)) return -1;
 
-    int highest_priority_index = -1;
-    unsigned int highest_priority = ~0U;
+    init_queue(pjq, capacity, 0);
+    return 0;
+}
 
-    for (int i = 0; i < pjq->buf_size; i++) {
-        if (pjq->jobs[i].priority > 0 && pjq->jobs[i].priority < highest_priority) {
-            highest_priority = pjq->jobs[i].priority;
-            highest_priority_index = i;
-        }
+pri_jobqueue_t* pri_jobqueue_new_compact(int capacity, int labels) {
+    if (!valid_capacity(capacity) || !valid_labels(labels)) {
+        errno = EINVAL;
+        return NULL;
     }
 
+    size_t size = place_arrays(NULL, capacity, labels);
+    pri_jobqueue_t* pjq = (pri_jobqueue_t*)malloc(size);
+    if (!pjq) return NULL;
+
+    init_queue(pjq, capacity, labels);
+    return pjq;
+}
+
+size_t pri_jobqueue_sizeof_compact(int capacity, int labels) {
+    if (!valid_capacity(capacity) || !valid_labels(labels)) return 0;
+    return place_arrays(NULL, capacity, labels);
+}
+
+int pri_jobqueue_init_compact(pri_jobqueue_t* pjq, int capacity, int labels) {
+    if (!pjq || !valid_capacity(capacity) || !valid_labels(labels)) 
+        return -1;
+
+    init_queue(pjq, capacity, labels);
+    return 0;
+}
+
+label_table_t* pri_jobqueue_labels(pri_jobqueue_t* pjq) {
+    if (!pjq || !is_compact(pjq)) return NULL;
+    return LABELS(pjq);
+}
+
+bool pri_jobqueue_set_engine(pri_jobqueue_t* pjq,
+    pri_jobqueue_engine_t engine) {
+    if (!pjq || !is_idle(pjq)) return false;
+    if (engine != PRI_JOBQUEUE_HEAP && engine != PRI_JOBQUEUE_SCAN
+        && engine != PRI_JOBQUEUE_BUCKET)
+        return false;
+
+    pjq->engine = engine;
+    reset_slots(pjq);
+    return true;
+}
+
+bool pri_jobqueue_set_levels(pri_jobqueue_t* pjq, int levels) {
+    if (!pjq || !is_idle(pjq) || !valid_levels(levels))
+        return false;
+
+    pjq->levels = levels;
+    reset_slots(pjq);
+    return true;
+}
+
+bool pri_jobqueue_set_layout(pri_jobqueue_t* pjq,
+    pri_jobqueue_layout_t layout) {
+    if (!pjq || !is_idle(pjq)) return false;
+    if (layout != PRI_JOBQUEUE_SOA && layout != PRI_JOBQUEUE_AOS) return false;
+
+    pjq->layout = layout;
+    return true;
+}
+
+bool pri_jobqueue_set_aging(pri_jobqueue_t* pjq, pri_jobqueue_aging_t aging,
+    unsigned int step) {
+    if (!pjq || !is_idle(pjq)) return false;
+    if (aging != PRI_JOBQUEUE_AGE_NONE && aging != PRI_JOBQUEUE_AGE_DEQUEUES
+        && aging != PRI_JOBQUEUE_AGE_MSEC)
+        return false;
+    if (aging != PRI_JOBQUEUE_AGE_NONE && step == 0) return false;
+
+    pjq->aging = aging;
+    pjq->age_step = aging == PRI_JOBQUEUE_AGE_NONE ? 0 : step;
+    reset_slots(pjq);
+    return true;
+}
+
+bool pri_jobqueue_set_order(pri_jobqueue_t* pjq, pri_jobqueue_order_t order) {
+    if (!pjq || !is_idle(pjq)) return false;
+    if (order != PRI_JOBQUEUE_BY_PRIORITY && order != PRI_JOBQUEUE_BY_DEADLINE)
+        return false;
+
+    pjq->order = order;
+    reset_slots(pjq);
+    return true;
+}
+
+job_t* pri_jobqueue_dequeue(pri_jobqueue_t* pjq, job_t* dst) {
+    if (!pjq || pri_jobqueue_is_empty(pjq)) return NULL;
+
+    int highest_priority_index = top_slot(pjq);
+
     if (highest_priority_index == -1) return NULL;
 
-    job_t* highest_priority_job = &pjq->jobs[highest_priority_index];
-    if (!dst) {
-        dst = job_new(highest_priority_job->pid, highest_priority_job->id,
-                      highest_priority_job->priority, highest_priority_job->label);
-        if (!dst) return NULL;
-    } else {
-        job_copy(highest_priority_job, dst);
-    }
+    dst = load_slot(pjq, highest_priority_index, dst);
+    if (!dst) return NULL;
+
+    take_slot(pjq, highest_priority_index);
+    release_slot(pjq, highest_priority_index);
+    pjq->size--;
+    return dst;
+}
+
+compact_job_t* pri_jobqueue_dequeue_compact(pri_jobqueue_t* pjq, 
+    compact_job_t* dst) {
+    if (!pjq || !dst || !is_compact(pjq) || pri_jobqueue_is_empty(pjq)) 
+        return NULL;
+
+    int slot = top_slot(pjq);
+    if (slot == -1) return NULL;
 
-    job_init(highest_priority_job);
-    pjq->size--; 
+    *dst = CJOBS(pjq)[slot];
+    take_slot(pjq, slot);
+    release_slot(pjq, slot);
+    pjq->size--;
     return dst;
 }
 
+const job_t* pri_jobqueue_borrow(pri_jobqueue_t* pjq) {
+    /* a compact slot is not a job_t that can be read in place */
+    if (!pjq || is_compact(pjq) || pri_jobqueue_is_empty(pjq)) return NULL;
+
+    int slot = top_slot(pjq);
+    if (slot == -1) return NULL;
+
+    /* 
+     * off the engine's ordering and out of the scans (its dense priority is 
+     * 0), but still marked in use so that enqueue cannot reuse it
+     */
+    take_slot(pjq, slot);
+    PRIOS(pjq)[slot] = 0;
+    pjq->size--;
+    pjq->borrowed++;
+    return &pjq->jobs[slot];
+}
+
+bool pri_jobqueue_commit(pri_jobqueue_t* pjq, const job_t* job) {
+    if (!pjq || !job || is_compact(pjq) || pjq->borrowed == 0) return false;
+
+    const job_t* first = pjq->jobs;
+    if (job < first || job >= first + pjq->buf_size) return false;
+
+    int slot = (int) (job - first);
+    if (job->priority == 0 || PRIOS(pjq)[slot] != 0) return false;
+
+    release_slot(pjq, slot);
+    pjq->borrowed--;
+    return true;
+}
+
+/* copy a job to a free slot, false if the queue is full or job is invalid */
+static bool enqueue_job(pri_jobqueue_t* pjq, job_t* job, uint64_t deadline) {
+    if (pri_jobqueue_is_full(pjq) || job->priority == 0) return false;
+
+    int slot = find_free(pjq);
+    if (slot < 0 || !store_slot(pjq, slot, job)) return false;
+
+    mark_used(pjq, slot);
+    PRIOS(pjq)[slot] = job->priority;
+    STAMPS(pjq)[slot] = pjq->seq++;
+    DEADLINES(pjq)[slot] = deadline;
+    if (is_aging(pjq))
+        KEYS(pjq)[slot] = age_key(pjq, job->priority);
+
+    insert_slot(pjq, slot);
+    index_insert(pjq, slot);
+    pjq->size++;
+    return true;
+}
+
 void pri_jobqueue_enqueue(pri_jobqueue_t* pjq, job_t* job) {
-    if (!pjq || !job || pri_jobqueue_is_full(pjq) || job->priority == 0) return;
+    if (!pjq || !job) return;
+    enqueue_job(pjq, job, JOB_NO_DEADLINE);
+}
+
+bool pri_jobqueue_enqueue_deadline(pri_jobqueue_t* pjq, deadline_job_t* job) {
+    if (!pjq || !job) return false;
+    return enqueue_job(pjq, &job->job, job->deadline);
+}
+
+static deadline_job_t* copy_slot(pri_jobqueue_t* pjq, int slot,
+    deadline_job_t* dst) {
+    load_slot(pjq, slot, &dst->job);
+    dst->deadline = DEADLINES(pjq)[slot];
+    return dst;
+}
+
+deadline_job_t* pri_jobqueue_dequeue_deadline(pri_jobqueue_t* pjq, 
+    deadline_job_t* dst) {
+    if (!pjq || !dst || pri_jobqueue_is_empty(pjq)) return NULL;
+
+    int slot = top_slot(pjq);
+    if (slot == -1) return NULL;
+
+    copy_slot(pjq, slot, dst);
+    take_slot(pjq, slot);
+    release_slot(pjq, slot);
+    pjq->size--;
+    return dst;
+}
+
+/* 
+ * the heap index of the first entry, in the subtree at index i, whose 
+ * deadline is not before now. When the heap is ordered by deadline, an entry
+ * that is reachable is first in its subtree, so only the subtrees of missed
+ * entries are searched.
+ */
+static int heap_reachable(pri_jobqueue_t* pjq, int i, uint64_t now) {
+    if (i >= pjq->heap_size) return -1;
+
+    int* heap = HEAP(pjq);
+    if (DEADLINES(pjq)[heap[i]] >= now) return i;
+
+    int left = heap_reachable(pjq, 2 * i + 1, now);
+    int right = heap_reachable(pjq, 2 * i + 2, now);
+
+    if (left < 0) return right;
+    if (right < 0) return left;
+    return slot_before(pjq, heap[left], heap[right]) ? left : right;
+}
+
+/* the first queued slot whose deadline is not before now, or -1 */
+static int reachable_slot(pri_jobqueue_t* pjq, uint64_t now) {
+    if (by_deadline(pjq) && pjq->engine != PRI_JOBQUEUE_SCAN) {
+        int i = heap_reachable(pjq, 0, now);
+        return i < 0 ? -1 : HEAP(pjq)[i];
+    }
+
+    unsigned int* prios = PRIOS(pjq);
+    uint64_t* deadlines = DEADLINES(pjq);
+    int top = -1;
 
     for (int i = 0; i < pjq->buf_size; i++) {
-        if (pjq->jobs[i].priority == 0) {
-            job_copy(job, &pjq->jobs[i]); 
-            pjq->size++;
-            return;
-        }
+        if (prios[i] != 0 && deadlines[i] >= now 
+            && (top < 0 || slot_before(pjq, i, top)))
+            top = i;
     }
+
+    return top;
+}
+
+deadline_job_t* pri_jobqueue_peek_reachable(pri_jobqueue_t* pjq, uint64_t now,
+    deadline_job_t* dst) {
+    if (!pjq || !dst || pri_jobqueue_is_empty(pjq)) return NULL;
+
+    int slot = reachable_slot(pjq, now);
+    if (slot == -1) return NULL;
+
+    return copy_slot(pjq, slot, dst);
+}
+
+deadline_job_t* pri_jobqueue_dequeue_reachable(pri_jobqueue_t* pjq, 
+    uint64_t now, deadline_job_t* dst) {
+    if (!pjq || !dst || pri_jobqueue_is_empty(pjq)) return NULL;
+
+    int slot = reachable_slot(pjq, now);
+    if (slot == -1) return NULL;
+
+    copy_slot(pjq, slot, dst);
+    take_slot(pjq, slot);
+    release_slot(pjq, slot);
+    pjq->size--;
+    return dst;
+}
+
+bool pri_jobqueue_cancel(pri_jobqueue_t* pjq, pid_t pid, unsigned int id) {
+    if (!pjq) return false;
+
+    int i = index_find(pjq, pid, id);
+    if (i < 0) return false;
+
+    int slot = INDEX(pjq)[i];
+    unlink_slot(pjq, slot);
+    index_delete(pjq, i);
+    release_slot(pjq, slot);
+    pjq->size--;
+    return true;
+}
+
+bool pri_jobqueue_reprioritise(pri_jobqueue_t* pjq, pid_t pid, unsigned int id,
+    unsigned int priority) {
+    if (!pjq || priority == 0) return false;
+
+    int i = index_find(pjq, pid, id);
+    if (i < 0) return false;
+
+    /* the job is ordered as if it had just been enqueued */
+    int slot = INDEX(pjq)[i];
+    unlink_slot(pjq, slot);
+
+    set_held_priority(pjq, slot, priority);
+    PRIOS(pjq)[slot] = priority;
+    STAMPS(pjq)[slot] = pjq->seq++;
+    if (is_aging(pjq))
+        KEYS(pjq)[slot] = age_key(pjq, priority);
+
+    insert_slot(pjq, slot);
+    return true;
+}
+
+int pri_jobqueue_dequeue_n(pri_jobqueue_t* pjq, job_t* dst, int n) {
+    if (!pjq || !dst) return 0;
+
+    int i = 0;
+    while (i < n && pri_jobqueue_dequeue(pjq, &dst[i]))
+        i++;
+
+    return i;
+}
+
+int pri_jobqueue_enqueue_n(pri_jobqueue_t* pjq, job_t* jobs, int n) {
+    if (!pjq || !jobs) return 0;
+
+    int i = 0;
+    while (i < n && enqueue_job(pjq, &jobs[i], JOB_NO_DEADLINE))
+        i++;
+
+    return i;
 }
 
 bool pri_jobqueue_is_empty(pri_jobqueue_t* pjq) {
-    if (!pjq) return true; 
+    if (!pjq) return true;
     return (pjq->size == 0);
 }
 
 bool pri_jobqueue_is_full(pri_jobqueue_t* pjq) {
-    if (!pjq) return false; 
-    return (pjq->size == pjq->buf_size);
+    if (!pjq) return true;
+    return (pjq->size + pjq->borrowed == pjq->buf_size);
 }
 
 job_t* pri_jobqueue_peek(pri_jobqueue_t* pjq, job_t* dst) {
     if (!pjq || pri_jobqueue_is_empty(pjq)) return NULL;
 
-    int highest_priority_index = -1;
-    unsigned int highest_priority = ~0U;
-
-    for (int i = 0; i < pjq->buf_size; i++) {
-        if (pjq->jobs[i].priority > 0 && pjq->jobs[i].priority < highest_priority) {
-            highest_priority = pjq->jobs[i].priority;
-            highest_priority_index = i;
-        }
-    }
+    int highest_priority_index = top_slot(pjq);
 
     if (highest_priority_index == -1) return NULL;
 
-    job_t* highest_priority_job = &pjq->jobs[highest_priority_index];
-    if (!dst) {
-        return job_new(highest_priority_job->pid, highest_priority_job->id,
-                       highest_priority_job->priority, highest_priority_job->label);
-    } else {
-        job_copy(highest_priority_job, dst);
-        return dst;
-    }
+    return load_slot(pjq, highest_priority_index, dst);
 }
 
 int pri_jobqueue_size(pri_jobqueue_t* pjq) {
-    if (!pjq) return 0; 
+    if (!pjq) return 0;
     return pjq->size;
 }
 
 int pri_jobqueue_space(pri_jobqueue_t* pjq) {
     if (!pjq) return 0;
-    return (pjq->buf_size - pjq->size);
+    return (pjq->buf_size - pjq->size - pjq->borrowed);
 }
 
 void pri_jobqueue_delete(pri_jobqueue_t* pjq) {
@@ -3,10 +3,20 @@
 #define _PRI_jobqueue_H
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "sim_config.h"
 #include "job.h"
+#include "label_table.h"
 
-#define JOB_BUFFER_SIZE 128     // the size of the jobs buffer used by a queue
+#define JOB_BUFFER_SIZE 128     // the default number of job slots of a queue
+
+/* 
+ * PRI_JOBQUEUE_LEVELS - the default number of priority levels with their own
+ * list for the PRI_JOBQUEUE_BUCKET engine, which can have up to 
+ * PRI_JOBQUEUE_MAX_LEVELS levels
+ */
+#define PRI_JOBQUEUE_LEVELS 16
+#define PRI_JOBQUEUE_MAX_LEVELS 64
 
 /* 
  * Introduction
@@ -14,9 +24,20 @@
  * This header defines a pri_jobqueue struct (pri_jobqueue_t) and associated
  * functions that together provide a priority of queue of jobs. The queue uses
  * a fixed sized array of job structs as a buffer (see the jobs field of the 
- * pri_jobqueue_t). The size of the buffer is defined by JOB_BUFFER_SIZE. That 
- * is, queue is full when all JOB_BUFFER_SIZE slots of the jobs array are 
- * in use with a valid job.
+ * pri_jobqueue_t). The size of the buffer (the capacity of the queue) is 
+ * chosen when the queue is created and is JOB_BUFFER_SIZE by default. That 
+ * is, queue is full when all buf_size slots of the jobs array are in use 
+ * with a valid job.
+ *
+ * QUEUE MEMORY
+ *
+ * A queue occupies a single contiguous block of memory: the pri_jobqueue_t
+ * struct, whose jobs field is a flexible array member, followed by the 
+ * per-slot state that the queue engines use. The size of the block for a 
+ * given capacity is given by pri_jobqueue_sizeof. The block contains no 
+ * pointers (per-slot state is located by offsets from the start of the 
+ * struct), so a queue can be placed in shared memory that is mapped at 
+ * different addresses by different processes (see ipc_jobqueue.h).
  *
  * PRIORITY QUEUING
  *
@@ -43,6 +64,118 @@
  * other order. The priority queueing constraint simply means that jobs must be
  * dequeued in priority order.
  *
+ * To preserve FIFO order between jobs of the same priority level, each 
+ * enqueued job is given a sequence stamp (see the seq and stamps_off fields of
+ * pri_jobqueue_t). Of two jobs with the same priority, the job with the 
+ * older stamp is dequeued first.
+ *
+ * QUEUE ENGINES
+ *
+ * The order in which jobs are dequeued is maintained by a queue engine:
+ *      PRI_JOBQUEUE_HEAP - a binary min-heap of slot indices ordered by 
+ *          priority and then by sequence stamp. Enqueue and dequeue are 
+ *          O(log n) in the number of jobs on the queue and peek is O(1).
+ *          This is the default engine.
+ *      PRI_JOBQUEUE_SCAN - no ordering is maintained between jobs. Dequeue 
+ *          and peek scan every slot of the buffer for the highest priority 
+ *          job and are O(buf_size). Enqueue is O(1).
+ *      PRI_JOBQUEUE_BUCKET - for applications that use a small number of 
+ *          priority levels. Each of the first levels priority levels (see 
+ *          pri_jobqueue_set_levels) has its own FIFO list of jobs and a 
+ *          bitmap records which levels are not empty. Enqueue, dequeue and
+ *          peek are O(1) for jobs of those levels. Jobs with a priority 
+ *          greater than levels are held in a binary heap as for
+ *          PRI_JOBQUEUE_HEAP and are dequeued once the lists are empty.
+ * All engines have identical priority queueing semantics. Use 
+ * pri_jobqueue_set_engine to select the engine of an empty queue.
+ *
+ * SLOT LAYOUT
+ *
+ * The priority of the job in each slot is also held in a dense array of 
+ * priorities (0 for an unused slot) and its sequence stamp in an array of 
+ * stamps, apart from the pid, id and label of the job in the jobs buffer. 
+ * With the default PRI_JOBQUEUE_SOA layout, engines read only those arrays 
+ * when they compare or scan slots, so that a scan of the queue touches 4 
+ * bytes per slot rather than a whole job, and is vectorised where the CPU 
+ * allows (see pri_search.h). With the PRI_JOBQUEUE_AOS layout, engines read 
+ * priorities from the jobs buffer. Both layouts keep the jobs buffer complete
+ * and valid. Use pri_jobqueue_set_layout to select the layout of an empty 
+ * queue.
+ *
+ * COMPACT SLOTS
+ *
+ * A queue created by pri_jobqueue_new_compact (or initialised by 
+ * pri_jobqueue_init_compact) holds its jobs as compact jobs (see 
+ * compact_job_t in label_table.h), 16 bytes per slot rather than the 44 
+ * bytes of a job_t, with a label table of its own at the end of its block 
+ * of memory. Enqueue interns the label of each job in the table and 
+ * dequeue, peek and the deadline functions expand the label again, so the 
+ * queue has the same semantics as any other. A consumer that logs or prints
+ * jobs can instead take them in compact form with 
+ * pri_jobqueue_dequeue_compact and expand them, or convert them to strings,
+ * with the queue's table (pri_jobqueue_labels) when they are used.
+ *
+ * The table holds every distinct label enqueued since the queue was 
+ * initialised and labels are never removed from it, so a compact queue is 
+ * for applications with a bounded set of labels: a job whose label is not 
+ * in a full table is not enqueued, and the enqueue functions set errno to 
+ * ENOSPC (pri_jobqueue_enqueue_deadline and pri_jobqueue_enqueue_n also 
+ * report the job as not queued). The per-slot engine state is unchanged, 
+ * so a compact slot takes about 64 bytes of the block instead of about 92, 
+ * plus label_table_sizeof(labels) bytes for the table. Compact slots are 
+ * not job_t structs, so pri_jobqueue_borrow is not available on a compact
+ * queue.
+ *
+ * PRIORITY AGING
+ *
+ * Strict priority order means that, with a steady stream of high priority
+ * jobs, a low priority job may never be dequeued. A queue can instead age 
+ * its jobs (see pri_jobqueue_set_aging): a job's effective priority improves
+ * by one level for every step units of a clock that pass while it waits on
+ * the queue, where the clock is either the number of jobs dequeued from the
+ * queue (PRI_JOBQUEUE_AGE_DEQUEUES) or the monotonic time in milliseconds 
+ * (PRI_JOBQUEUE_AGE_MSEC). That is, a job of priority p enqueued at clock 
+ * value t is dequeued before a job of priority q enqueued at clock value u if 
+ * p * step + t < q * step + u, and, if those are equal, in FIFO order. Because
+ * the clock never goes back, jobs of the same priority are still dequeued in
+ * FIFO order, and a job of priority p waits at most about (p - 1) * step 
+ * clock units behind jobs of priority 1 that are enqueued after it. Aging is
+ * off (PRI_JOBQUEUE_AGE_NONE) by default. Dequeued jobs keep their original
+ * priority.
+ *
+ * EARLIEST DEADLINE FIRST
+ *
+ * Each slot also holds the deadline of its job (see deadline_job_t in job.h),
+ * given by pri_jobqueue_enqueue_deadline, or JOB_NO_DEADLINE for jobs 
+ * enqueued by the other enqueue functions. By default 
+ * (PRI_JOBQUEUE_BY_PRIORITY) deadlines have no effect on the order of jobs.
+ * With the PRI_JOBQUEUE_BY_DEADLINE order (see pri_jobqueue_set_order) jobs
+ * are dequeued in order of their deadlines and jobs with the same deadline
+ * are dequeued in priority order as described above (including aging, if 
+ * it is on). In this order, the PRI_JOBQUEUE_BUCKET engine holds every job
+ * on its heap, as for PRI_JOBQUEUE_HEAP. 
+ *
+ * A consumer that only wants jobs that can still meet their deadlines uses
+ * pri_jobqueue_peek_reachable and pri_jobqueue_dequeue_reachable, which find
+ * the first job in queue order whose deadline is not before a given time. 
+ * Jobs that have missed their deadlines stay on the queue until they are 
+ * dequeued by the other functions. With the PRI_JOBQUEUE_BY_DEADLINE order 
+ * and the heap, the search visits only the heap entries of missed jobs and 
+ * their children. Otherwise it is O(buf_size).
+ *
+ * CANCEL AND REPRIORITISE
+ *
+ * A queued job can be removed without dequeuing it (pri_jobqueue_cancel), or
+ * given a new priority (pri_jobqueue_reprioritise), by its pid and id. The
+ * queue keeps a hash index from (pid, id) to slot in its memory, with the 
+ * heap position of each slot and links in both directions between the jobs
+ * of each level list, so that both operations are O(1) with the 
+ * PRI_JOBQUEUE_SCAN and PRI_JOBQUEUE_BUCKET engines (for jobs on the level
+ * lists) and O(log n) for jobs on a heap. If more than one queued job has 
+ * the same pid and id, both functions act on the one that was enqueued (or 
+ * last reprioritised) first, so applications that queue such jobs can 
+ * cancel them in FIFO order.
+ *
  * VALIDITY OF JOBS AND QUEUE STATE
  * 
  * A job in the priority queue is considered valid and available for dequeuing
@@ -57,9 +190,42 @@
  *
  * The functions:
  *      pri_jobqueue_new()
+ *      pri_jobqueue_new_sized(int capacity)
+ *      pri_jobqueue_sizeof(int capacity)
  *      pri_jobqueue_init(pri_jobqueue_t* pjq)
+ *      pri_jobqueue_init_sized(pri_jobqueue_t* pjq, int capacity)
+ *      pri_jobqueue_new_compact(int capacity, int labels)
+ *      pri_jobqueue_sizeof_compact(int capacity, int labels)
+ *      pri_jobqueue_init_compact(pri_jobqueue_t* pjq, int capacity, 
+ *          int labels)
+ *      pri_jobqueue_labels(pri_jobqueue_t* pjq)
+ *      pri_jobqueue_dequeue_compact(pri_jobqueue_t* pjq, compact_job_t* dst)
+ *      pri_jobqueue_set_engine(pri_jobqueue_t* pjq, 
+ *          pri_jobqueue_engine_t engine)
+ *      pri_jobqueue_set_levels(pri_jobqueue_t* pjq, int levels)
+ *      pri_jobqueue_set_layout(pri_jobqueue_t* pjq, 
+ *          pri_jobqueue_layout_t layout)
+ *      pri_jobqueue_set_aging(pri_jobqueue_t* pjq, 
+ *          pri_jobqueue_aging_t aging, unsigned int step)
+ *      pri_jobqueue_set_order(pri_jobqueue_t* pjq, 
+ *          pri_jobqueue_order_t order)
  *      pri_jobqueue_dequeue(pri_jobqueue_t* pjq, job_t* dst)
  *      pri_jobqueue_enqueue(pri_jobqueue_t* pjq, job_t* dst)
+ *      pri_jobqueue_dequeue_n(pri_jobqueue_t* pjq, job_t* dst, int n)
+ *      pri_jobqueue_enqueue_n(pri_jobqueue_t* pjq, job_t* jobs, int n)
+ *      pri_jobqueue_borrow(pri_jobqueue_t* pjq)
+ *      pri_jobqueue_commit(pri_jobqueue_t* pjq, const job_t* job)
+ *      pri_jobqueue_enqueue_deadline(pri_jobqueue_t* pjq, 
+ *          deadline_job_t* job)
+ *      pri_jobqueue_dequeue_deadline(pri_jobqueue_t* pjq, 
+ *          deadline_job_t* dst)
+ *      pri_jobqueue_peek_reachable(pri_jobqueue_t* pjq, uint64_t now,
+ *          deadline_job_t* dst)
+ *      pri_jobqueue_dequeue_reachable(pri_jobqueue_t* pjq, uint64_t now,
+ *          deadline_job_t* dst)
+ *      pri_jobqueue_cancel(pri_jobqueue_t* pjq, pid_t pid, unsigned int id)
+ *      pri_jobqueue_reprioritise(pri_jobqueue_t* pjq, pid_t pid, 
+ *          unsigned int id, unsigned int priority)
  *      pri_jobqueue_is_empty(pri_jobqueue_t* pjq)
  *      pri_jobqueue_is_full(pri_jobqueue_t* pjq)
  *      pri_jobqueue_peek(pri_jobqueue_t* pjq, job_t* dst)
@@ -80,11 +246,11 @@
  * and erroneous behaviour.
  * 2. pri_jobqueue_new both dynamically allocates a pri_jobqueue on the heap
  * and initialises the queue. If you do not wish to create the queue on the
- * heap, simply declare a pri_jobqueue_t variable (for example on the stack) 
- * and pass a pointer to it to pri_jobqueue_init to initialise the queue. For
- * example:
- *      pri_jobqueue_t pq;
- *      pri_jobqueue_init(&pq);
+ * heap, provide a block of memory of pri_jobqueue_sizeof(capacity) bytes
+ * and pass a pointer to it to pri_jobqueue_init_sized (or to 
+ * pri_jobqueue_init if capacity is JOB_BUFFER_SIZE) to initialise the queue.
+ * Because the jobs buffer is a flexible array member, a pri_jobqueue_t 
+ * variable declared on the stack has no room for jobs.
  */
 
 /* 
@@ -96,8 +262,57 @@
  *
  * Fields:
  * buf_size - the size of the job buffer
- * jobs - the fixed sized buffer of job descriptions (job_t types) 
  * size - the number of jobs in the queue (not the size of the buffer)
+ * engine - the queue engine that orders jobs (see pri_jobqueue_engine_t)
+ * layout - where engines read the priorities of slots from (see 
+ *      pri_jobqueue_layout_t)
+ * seq - the sequence stamp to give the next enqueued job
+ * aging - the clock by which jobs are aged (see pri_jobqueue_aging_t)
+ * age_step - the number of clock units in which a job gains one level
+ * order - whether jobs are ordered by deadline (see pri_jobqueue_order_t)
+ * dequeues - the number of jobs dequeued (or borrowed) since the slots of 
+ *      the queue were last reset, the clock of PRI_JOBQUEUE_AGE_DEQUEUES
+ * age_base - the monotonic time in milliseconds when the slots of the queue
+ *      were last reset, from which PRI_JOBQUEUE_AGE_MSEC is counted
+ * borrowed - the number of slots held by pri_jobqueue_borrow that have not 
+ *      been committed
+ * free_hint - the index of the first word of the occupancy bitmap that may
+ *      have a bit clear, no word before it has an unused slot
+ * heap_size - the number of slot indices in the heap
+ * levels - the number of priority levels with a FIFO list for the 
+ *      PRI_JOBQUEUE_BUCKET engine
+ * level_map - bit l - 1 is set if the list of priority level l is not empty
+ * level_head, level_tail - the first and last slots of the list of each 
+ *      priority level (-1 if the list is empty)
+ * prios_off - offset in bytes from the start of the struct of the array of
+ *      buf_size priorities, one for the job in each slot of the buffer
+ * stamps_off - offset of the array of buf_size sequence stamps, one for the 
+ *      job in each slot of the buffer
+ * keys_off - offset of the array of buf_size 64-bit aging keys, 
+ *      priority * age_step plus the clock when the job in each slot was 
+ *      enqueued, which order jobs ahead of their priorities when aging is on
+ * deadlines_off - offset of the array of buf_size 64-bit deadlines, one for
+ *      the job in each slot of the buffer
+ * occupied_off - offset of the occupancy bitmap, an array of 64-bit words 
+ *      in which bit i % 64 of word i / 64 is set if slot i is in use. The 
+ *      number of bits set is always size + borrowed. Bits past the last slot 
+ *      are set.
+ * heap_off - offset of the array of buf_size slot indices used by the 
+ *      PRI_JOBQUEUE_HEAP engine to hold used slots in binary min-heap order
+ * next_off - offset of the array of buf_size slot indices that link the
+ *      priority level lists of the PRI_JOBQUEUE_BUCKET engine
+ * prev_off - offset of the array of buf_size slot indices that link the 
+ *      level lists backwards
+ * pos_off - offset of the array of buf_size heap indices, the position in 
+ *      the heap of the job in each slot that is on the heap
+ * index_off - offset of the (pid, id) index of queued jobs, a hash table of
+ *      index_mask + 1 slot indices (-1 for an unused entry)
+ * index_mask - the number of entries of the index less 1, the number of 
+ *      entries is a power of 2 and at least twice buf_size
+ * labels_off - offset of the label table of a queue with compact slots, or
+ *      0 if the slots of the queue are job_t structs
+ * jobs - the buffer of buf_size job descriptions (job_t types), or of 
+ *      buf_size compact jobs (compact_job_t types) if labels_off is not 0
  *
  * Note fields of the struct should only be accessed in the implementation 
  * file pri_jobqueue.c. Use pri_jobqueue functions to operate on a 
@@ -112,16 +327,90 @@
 typedef struct pri_jobqueue {
     int buf_size;
     int size;
-    job_t jobs[JOB_BUFFER_SIZE];
+    int engine;
+    int layout;
+    unsigned int seq;
+    int aging;
+    unsigned int age_step;
+    int order;
+    int borrowed;
+    int free_hint;
+    int heap_size;
+    int levels;
+    unsigned int index_mask;
+    uint64_t level_map;
+    uint64_t dequeues;
+    uint64_t age_base;
+    int level_head[PRI_JOBQUEUE_MAX_LEVELS];
+    int level_tail[PRI_JOBQUEUE_MAX_LEVELS];
+    size_t prios_off;
+    size_t stamps_off;
+    size_t keys_off;
+    size_t deadlines_off;
+    size_t occupied_off;
+    size_t heap_off;
+    size_t next_off;
+    size_t prev_off;
+    size_t pos_off;
+    size_t index_off;
+    size_t labels_off;
+    job_t jobs[];
 } pri_jobqueue_t;
 
+/* 
+ * PRI_JOBQUEUE_MAX_CAPACITY - the largest capacity of a queue. This keeps 
+ * slot indices and the size of a queue's memory within range of an int.
+ */
+#define PRI_JOBQUEUE_MAX_CAPACITY (1 << 24)
+
+/* 
+ * PRI_JOBQUEUE_MAX_LABELS - the largest number of distinct labels of a queue
+ * with compact slots, which keeps the size of its label table within range 
+ * of an int.
+ */
+#define PRI_JOBQUEUE_MAX_LABELS (1 << 20)
+
+/*
+ * Enumeration of the queue engines that can order the jobs of a 
+ * pri_jobqueue. See the introduction to this header file.
+ */
+typedef enum pri_jobqueue_engine {
+    PRI_JOBQUEUE_HEAP, PRI_JOBQUEUE_SCAN, PRI_JOBQUEUE_BUCKET
+} pri_jobqueue_engine_t;
+
+/*
+ * Enumeration of the slot layouts of a pri_jobqueue. See the introduction to 
+ * this header file.
+ */
+typedef enum pri_jobqueue_layout {
+    PRI_JOBQUEUE_SOA, PRI_JOBQUEUE_AOS
+} pri_jobqueue_layout_t;
+
+/*
+ * Enumeration of the clocks by which a pri_jobqueue can age its jobs, or 
+ * PRI_JOBQUEUE_AGE_NONE for strict priority order. See the introduction to 
+ * this header file.
+ */
+typedef enum pri_jobqueue_aging {
+    PRI_JOBQUEUE_AGE_NONE, PRI_JOBQUEUE_AGE_DEQUEUES, PRI_JOBQUEUE_AGE_MSEC
+} pri_jobqueue_aging_t;
+
+/*
+ * Enumeration of the orders in which a pri_jobqueue can dequeue its jobs. See
+ * the introduction to this header file.
+ */
+typedef enum pri_jobqueue_order {
+    PRI_JOBQUEUE_BY_PRIORITY, PRI_JOBQUEUE_BY_DEADLINE
+} pri_jobqueue_order_t;
+
 /*
  * pri_jobqueue_new()
  *
- * Dynamically allocates and initialise a pri_jobqueue. The returned queue is 
- * in an initial state defined by the function pri_jobqueue_init that means 
- * that the queue is empty and every slot in the queue is unused (its job is in 
- * an initialised/unused state).
+ * Dynamically allocates and initialise a pri_jobqueue with a buffer of 
+ * JOB_BUFFER_SIZE jobs. The returned queue is in an initial state defined by
+ * the function pri_jobqueue_init that means that the queue is empty and 
+ * every slot in the queue is unused (its job is in an initialised/unused 
+ * state). 
  *
  * Usage:
  *      pri_jobqueue_t* pjq = pri_jobqueue_new();   // allocate a new job queue
@@ -140,42 +429,101 @@ typedef struct pri_jobqueue {
  * set as specified by system library dynamic memory allocation functions.
  * 
  * Note:
- * It is possible to allocate a pri_jobqueue on the stack or as a global 
- * or static variable of type pri_jobqueue_t. In this case, do not use 
- * pri_jobqueue_new to create the queue. Just declare a pri_jobqueue_t variable
- * and pass a pointer to the pri_jobqueue_t to pri_jobqueue_init to initialise
- * the queue. For example:
- *      pri_jobqueue_t pq;
- *      pri_jobqueue_init(&pq);
+ * It is possible to place a pri_jobqueue in memory that is not allocated by 
+ * pri_jobqueue_new. In this case, the memory must be at least
+ * pri_jobqueue_sizeof(JOB_BUFFER_SIZE) bytes and must be passed to 
+ * pri_jobqueue_init to initialise the queue. For example:
+ *      pri_jobqueue_t* pq = malloc(pri_jobqueue_sizeof(JOB_BUFFER_SIZE));
+ *      pri_jobqueue_init(pq);
  *      
  * See also:
+ * pri_jobqueue_new_sized - to create a queue of a different capacity
  * pri_jobqueue_init - for a description of initialisation of a pri_jobqueue
  * job.h - for a description of the job type
  * man pages for malloc
  */
 pri_jobqueue_t* pri_jobqueue_new();
 
+/*
+ * pri_jobqueue_new_sized(int capacity)
+ *
+ * As pri_jobqueue_new but the buffer of the returned queue holds capacity
+ * jobs. The queue is initialised by pri_jobqueue_init_sized.
+ *
+ * Usage:
+ *      pri_jobqueue_t* pjq = pri_jobqueue_new_sized(4096);
+ *      ...
+ *      pri_jobqueue_delete(pjq);
+ *
+ * Parameters:
+ * capacity - the number of jobs the queue can hold, from 1 to 
+ *      PRI_JOBQUEUE_MAX_CAPACITY
+ *
+ * Return:
+ * On success: a new non-null pointer to a dynamically allocated pri_jobqueue.
+ *      Use pri_jobqueue_delete to free memory allocated to the pri_jobqueue.
+ * On failure: NULL, and errno is set as specified in Errors.
+ *
+ * Errors:
+ * If the call fails, the NULL pointer will be returned and errno will be 
+ * set as follows:
+ *      EINVAL - capacity is < 1 or > PRI_JOBQUEUE_MAX_CAPACITY
+ *      Other values as specified by system library dynamic memory allocation
+ *      functions.
+ */
+pri_jobqueue_t* pri_jobqueue_new_sized(int capacity);
+
+/*
+ * pri_jobqueue_sizeof(int capacity)
+ *
+ * Returns the number of bytes of memory occupied by a queue with a buffer 
+ * of capacity jobs, including the per-slot state of the queue engines. This
+ * is the amount of memory to provide to pri_jobqueue_init_sized, for example
+ * when a queue is placed in shared memory.
+ *
+ * Parameters:
+ * capacity - the number of jobs the queue can hold
+ *
+ * Return:
+ * The size in bytes of the queue, or 0 if capacity is < 1 or 
+ * > PRI_JOBQUEUE_MAX_CAPACITY.
+ */
+size_t pri_jobqueue_sizeof(int capacity);
+
 /*
  * pri_jobqueue_init(pri_jobqueue_t* pjq)
  *
- * Initialise a pri_jobqueue as follows:
+ * Initialise a pri_jobqueue of capacity JOB_BUFFER_SIZE as follows:
  *      buf_size to JOB_BUFFER_SIZE
  *      size to 0
+ *      engine to PRI_JOBQUEUE_HEAP
+ *      levels to PRI_JOBQUEUE_LEVELS
+ *      layout to PRI_JOBQUEUE_SOA
+ *      aging to PRI_JOBQUEUE_AGE_NONE
+ *      order to PRI_JOBQUEUE_BY_PRIORITY
  *      each job in the buffer to an initial state defined by job_init 
  *      (see job.h)
+ *      every slot of the buffer to free
  *
  * pri_jobqueue_init is a utility function to either set up a new queue in an 
  * initialised state or to empty an existing queue. That is, after calling 
  * pri_jobqueue_init, the queue will be empty and each job slot in the queue
  * will represent and initialised/unused job. pri_jobqueue_new ensures 
- * the queue it returns is initialised. Other queues e.g. declared on the 
- * stack or in shared memory (see ipc_pri_jobqueue) can be passed to 
- * pri_jobqueue_init to ensure initialisation. 
+ * the queue it returns is initialised. Other queues, in a block of memory 
+ * of pri_jobqueue_sizeof(JOB_BUFFER_SIZE) bytes e.g. in shared memory (see 
+ * ipc_pri_jobqueue), can be passed to pri_jobqueue_init to ensure 
+ * initialisation. A pri_jobqueue_t declared on the stack has no room for 
+ * jobs and must not be passed to it (see note 2 above and 
+ * pri_jobqueue_init_sized).
  * 
  * Calling pri_jobqueue_init on a queue that is in use will empty the queue.
  * That is, the function can be used to both initialise and re-initialise a
  * queue.
  *
+ * The memory pointed to by pjq must be at least 
+ * pri_jobqueue_sizeof(JOB_BUFFER_SIZE) bytes. To re-initialise a queue with
+ * a different capacity, use pri_jobqueue_init_sized.
+ *
  * Calling a pri_jobqueue_init with a NULL queue will cause a memory error.
  *
  * Usage:
@@ -192,6 +540,261 @@ pri_jobqueue_t* pri_jobqueue_new();
  */
 void pri_jobqueue_init(pri_jobqueue_t* pjq);
 
+/*
+ * pri_jobqueue_init_sized(pri_jobqueue_t* pjq, int capacity)
+ *
+ * As pri_jobqueue_init but buf_size is set to capacity. The memory pointed to
+ * by pjq must be at least pri_jobqueue_sizeof(capacity) bytes.
+ *
+ * Usage:
+ *      size_t bytes = pri_jobqueue_sizeof(4096);
+ *      pri_jobqueue_t* pjq = (pri_jobqueue_t*) some_alloc(bytes);
+ *      pri_jobqueue_init_sized(pjq, 4096);
+ *
+ * Parameters:
+ * pjq - a non-null pointer to the memory for a pri_jobqueue
+ * capacity - the number of jobs the queue can hold, from 1 to 
+ *      PRI_JOBQUEUE_MAX_CAPACITY
+ *
+ * Return:
+ * 0 on success, or -1 if pjq is NULL or capacity is invalid, in which case
+ * the memory pointed to by pjq is not changed.
+ */
+int pri_jobqueue_init_sized(pri_jobqueue_t* pjq, int capacity);
+
+/*
+ * pri_jobqueue_new_compact(int capacity, int labels)
+ *
+ * As pri_jobqueue_new_sized but the slots of the returned queue are compact
+ * jobs and the queue has a label table for up to labels distinct labels 
+ * (see COMPACT SLOTS in the introduction to this file). The queue is 
+ * initialised by pri_jobqueue_init_compact.
+ *
+ * Important note:
+ * Labels are never removed from the table. Once labels distinct labels have
+ * been enqueued, a job with any other label is not enqueued and errno is 
+ * set to ENOSPC, until the queue is initialised again.
+ *
+ * Usage:
+ *      pri_jobqueue_t* pjq = pri_jobqueue_new_compact(4096, 64);
+ *      ...
+ *      pri_jobqueue_delete(pjq);
+ *
+ * Parameters:
+ * capacity - the number of jobs the queue can hold, from 1 to 
+ *      PRI_JOBQUEUE_MAX_CAPACITY
+ * labels - the number of distinct labels the queue can hold, from 1 to
+ *      PRI_JOBQUEUE_MAX_LABELS
+ *
+ * Return:
+ * On success: a new non-null pointer to a dynamically allocated pri_jobqueue.
+ *      Use pri_jobqueue_delete to free memory allocated to the pri_jobqueue.
+ * On failure: NULL, and errno is set as specified in Errors.
+ *
+ * Errors:
+ * If the call fails, the NULL pointer will be returned and errno will be 
+ * set as follows:
+ *      EINVAL - capacity or labels is out of range
+ *      Other values as specified by system library dynamic memory allocation
+ *      functions.
+ */
+pri_jobqueue_t* pri_jobqueue_new_compact(int capacity, int labels);
+
+/*
+ * pri_jobqueue_sizeof_compact(int capacity, int labels)
+ *
+ * As pri_jobqueue_sizeof for a queue with compact slots and a label table 
+ * of labels labels, the amount of memory to provide to 
+ * pri_jobqueue_init_compact.
+ *
+ * Return:
+ * The size in bytes of the queue, or 0 if capacity or labels is out of 
+ * range.
+ */
+size_t pri_jobqueue_sizeof_compact(int capacity, int labels);
+
+/*
+ * pri_jobqueue_init_compact(pri_jobqueue_t* pjq, int capacity, int labels)
+ *
+ * As pri_jobqueue_init_sized for a queue with compact slots. Each slot is 
+ * set to an unused compact job (with priority 0) and the label table of the
+ * queue is emptied. The memory pointed to by pjq must be at least 
+ * pri_jobqueue_sizeof_compact(capacity, labels) bytes. As for 
+ * pri_jobqueue_new_compact, a job with a label that does not fit in the 
+ * full table is not enqueued and errno is set to ENOSPC.
+ *
+ * Usage:
+ *      size_t bytes = pri_jobqueue_sizeof_compact(4096, 64);
+ *      pri_jobqueue_t* pjq = (pri_jobqueue_t*) some_alloc(bytes);
+ *      pri_jobqueue_init_compact(pjq, 4096, 64);
+ *
+ * Return:
+ * 0 on success, or -1 if pjq is NULL or capacity or labels is out of range,
+ * in which case the memory pointed to by pjq is not changed.
+ */
+int pri_jobqueue_init_compact(pri_jobqueue_t* pjq, int capacity, int labels);
+
+/*
+ * pri_jobqueue_labels(pri_jobqueue_t* pjq)
+ *
+ * Returns the label table of a queue with compact slots, with which the 
+ * compact jobs returned by pri_jobqueue_dequeue_compact are expanded (see
+ * label_table_expand and label_table_to_str in label_table.h). The table is
+ * in the queue's memory, so ids stay valid until the queue is initialised 
+ * again. Only look up labels in it: the queue interns them.
+ *
+ * Usage:
+ *      compact_job_t cj;
+ *      char str[JOB_STR_SIZE];
+ *      if (pri_jobqueue_dequeue_compact(pjq, &cj))
+ *          label_table_to_str(pri_jobqueue_labels(pjq), &cj, str);
+ *
+ * Return:
+ * The label table of the queue, or NULL if pjq is NULL or its slots are 
+ * not compact.
+ */
+label_table_t* pri_jobqueue_labels(pri_jobqueue_t* pjq);
+
+/*
+ * pri_jobqueue_dequeue_compact(pri_jobqueue_t* pjq, compact_job_t* dst)
+ *
+ * As pri_jobqueue_dequeue for a queue with compact slots, but the highest 
+ * priority job is copied to dst in compact form, without expanding its 
+ * label.
+ *
+ * Parameters:
+ * pjq - a non-null pointer to a pri_jobqueue with compact slots
+ * dst - a non-null pointer to a compact job to copy to
+ *
+ * Return:
+ * dst, or NULL if pjq or dst is NULL, the queue is empty or its slots are 
+ * not compact.
+ */
+compact_job_t* pri_jobqueue_dequeue_compact(pri_jobqueue_t* pjq, 
+    compact_job_t* dst);
+
+/*
+ * pri_jobqueue_set_engine(pri_jobqueue_t* pjq, pri_jobqueue_engine_t engine)
+ *
+ * Select the queue engine used to order the jobs of the given queue. The 
+ * engine can only be changed while the queue is empty. 
+ *
+ * Usage:
+ *      pri_jobqueue_t* pjq = pri_jobqueue_new();
+ *      pri_jobqueue_set_engine(pjq, PRI_JOBQUEUE_SCAN);
+ *      ...
+ *
+ * Parameters:
+ * pjq - a non-null pointer to an initialised pri_jobqueue
+ * engine - the engine to use (see pri_jobqueue_engine_t)
+ *
+ * Return:
+ * True if the queue's engine is now the given engine, false if pjq is NULL,
+ * the engine is not valid or the queue is not empty. If false is returned 
+ * the queue is unchanged.
+ */
+bool pri_jobqueue_set_engine(pri_jobqueue_t* pjq, pri_jobqueue_engine_t engine);
+
+/*
+ * pri_jobqueue_set_levels(pri_jobqueue_t* pjq, int levels)
+ *
+ * Set the number of priority levels that have their own FIFO list when the
+ * queue uses the PRI_JOBQUEUE_BUCKET engine. Jobs with priorities 1 to levels
+ * are queued on the list for their level, jobs with greater priorities are
+ * queued on the heap. The number of levels can only be changed while the 
+ * queue is empty. It has no effect on the ordering of other engines.
+ *
+ * Usage:
+ *      pri_jobqueue_t* pjq = pri_jobqueue_new();
+ *      pri_jobqueue_set_engine(pjq, PRI_JOBQUEUE_BUCKET);
+ *      pri_jobqueue_set_levels(pjq, 8);    // priorities 1 to 8 are O(1)
+ *
+ * Parameters:
+ * pjq - a non-null pointer to an initialised pri_jobqueue
+ * levels - the number of levels, from 1 to PRI_JOBQUEUE_MAX_LEVELS
+ *
+ * Return:
+ * True if the queue now has the given number of levels, false if pjq is 
+ * NULL, levels is out of range or the queue is not empty. If false is 
+ * returned the queue is unchanged.
+ */
+bool pri_jobqueue_set_levels(pri_jobqueue_t* pjq, int levels);
+
+/*
+ * pri_jobqueue_set_layout(pri_jobqueue_t* pjq, pri_jobqueue_layout_t layout)
+ *
+ * Select whether the engine of the queue reads priorities from the dense 
+ * array of priorities (PRI_JOBQUEUE_SOA) or from the jobs buffer 
+ * (PRI_JOBQUEUE_AOS). The layout can only be changed while the queue is 
+ * empty. The layout has no effect on the order in which jobs are dequeued.
+ *
+ * Parameters:
+ * pjq - a non-null pointer to an initialised pri_jobqueue
+ * layout - one of the values of pri_jobqueue_layout_t
+ *
+ * Return:
+ * True if the queue now has the given layout, false if pjq is NULL, layout 
+ * is not valid or the queue is not empty. If false is returned the queue is 
+ * unchanged.
+ */
+bool pri_jobqueue_set_layout(pri_jobqueue_t* pjq, pri_jobqueue_layout_t layout);
+
+/*
+ * pri_jobqueue_set_aging(pri_jobqueue_t* pjq, pri_jobqueue_aging_t aging,
+ *      unsigned int step)
+ *
+ * Select the clock by which the jobs of the queue are aged and the number of
+ * units of that clock in which a waiting job gains one priority level. Aging 
+ * can only be changed while the queue is empty. It applies to every engine.
+ *
+ * Keys are 64-bit, so any priority and step order jobs exactly as described
+ * in the introduction, unless the clock passes 2^33 units (about 99 days 
+ * for PRI_JOBQUEUE_AGE_MSEC) on a queue with priority * step near 2^64, 
+ * when keys saturate and jobs that reach the largest key are dequeued in 
+ * FIFO order.
+ *
+ * Usage:
+ *      pri_jobqueue_t* pjq = pri_jobqueue_new();
+ *      // a job gains a level for every 64 jobs dequeued while it waits
+ *      pri_jobqueue_set_aging(pjq, PRI_JOBQUEUE_AGE_DEQUEUES, 64);
+ *
+ * Parameters:
+ * pjq - a non-null pointer to an initialised pri_jobqueue
+ * aging - one of the values of pri_jobqueue_aging_t
+ * step - the clock units per level, at least 1 unless aging is 
+ *      PRI_JOBQUEUE_AGE_NONE, in which case it is ignored
+ *
+ * Return:
+ * True if the queue now ages jobs as given, false if pjq is NULL, aging or
+ * step is not valid or the queue is not empty. If false is returned the 
+ * queue is unchanged.
+ */
+bool pri_jobqueue_set_aging(pri_jobqueue_t* pjq, pri_jobqueue_aging_t aging,
+    unsigned int step);
+
+/*
+ * pri_jobqueue_set_order(pri_jobqueue_t* pjq, pri_jobqueue_order_t order)
+ *
+ * Select whether the jobs of the queue are dequeued in priority order 
+ * (PRI_JOBQUEUE_BY_PRIORITY) or earliest deadline first with priority as the 
+ * tie-break (PRI_JOBQUEUE_BY_DEADLINE). The order can only be changed while 
+ * the queue is empty. It applies to every engine.
+ *
+ * Usage:
+ *      pri_jobqueue_t* pjq = pri_jobqueue_new();
+ *      pri_jobqueue_set_order(pjq, PRI_JOBQUEUE_BY_DEADLINE);
+ *
+ * Parameters:
+ * pjq - a non-null pointer to an initialised pri_jobqueue
+ * order - one of the values of pri_jobqueue_order_t
+ *
+ * Return:
+ * True if the queue now has the given order, false if pjq is NULL, order is
+ * not valid or the queue is not empty. If false is returned the queue is 
+ * unchanged.
+ */
+bool pri_jobqueue_set_order(pri_jobqueue_t* pjq, pri_jobqueue_order_t order);
+
 /* 
  * pri_jobqueue_dequeue(pri_jobqueue_t* pjq, job_t* dst)
  *
@@ -286,7 +889,9 @@ job_t* pri_jobqueue_dequeue(pri_jobqueue_t* pjq, job_t* dst);
  * If the queue pjq is full, this function has no effect on the state of the 
  * the queue. If pjq or job pointers are NULL, this function has
  * no effect. If job has an invalid priority as defined in job.h, the job is 
- * not queued and this function has not effect.
+ * not queued and this function has not effect. For a queue with compact 
+ * slots, a job whose label does not fit in the full label table is not 
+ * queued and errno is set to ENOSPC (see COMPACT SLOTS).
  *
  * Important note:
  * This function gives no indication that the queue is full. It silently
@@ -337,6 +942,216 @@ job_t* pri_jobqueue_dequeue(pri_jobqueue_t* pjq, job_t* dst);
  */
 void pri_jobqueue_enqueue(pri_jobqueue_t* pjq, job_t* job);
 
+/*
+ * pri_jobqueue_dequeue_n(pri_jobqueue_t* pjq, job_t* dst, int n)
+ *
+ * Dequeues up to n jobs in one call, copying them to the array dst in 
+ * the order in which pri_jobqueue_dequeue would return them. Fewer than n 
+ * jobs are dequeued if the queue becomes empty.
+ *
+ * Usage:
+ *      job_t batch[16];
+ *      int got = pri_jobqueue_dequeue_n(pjq, batch, 16);
+ *      for (int i = 0; i < got; i++)
+ *          ...                         // process batch[i]
+ *
+ * Parameters:
+ * pjq - a non-null pointer to a pri_jobqueue
+ * dst - a non-null pointer to an array of at least n jobs to copy to
+ * n - the maximum number of jobs to dequeue
+ *
+ * Return:
+ * The number of jobs dequeued, 0 if the queue is empty, n is not positive 
+ * or pjq or dst is NULL. Elements of dst from the returned index on are 
+ * unchanged.
+ */
+int pri_jobqueue_dequeue_n(pri_jobqueue_t* pjq, job_t* dst, int n);
+
+/*
+ * pri_jobqueue_enqueue_n(pri_jobqueue_t* pjq, job_t* jobs, int n)
+ *
+ * Enqueues up to n jobs from the array jobs, in array order, as if by n calls
+ * of pri_jobqueue_enqueue. Enqueuing stops early if the queue becomes full 
+ * or at the first job that is not queued (e.g. for an invalid priority or 
+ * label, or ENOSPC for a compact queue), so that the return value is also 
+ * the index of the first job that was not queued.
+ *
+ * Usage:
+ *      job_t burst[32];
+ *      ...
+ *      int sent = pri_jobqueue_enqueue_n(pjq, burst, 32);
+ *      // burst[sent] onwards were not queued
+ *
+ * Parameters:
+ * pjq - a non-null pointer to a pri_jobqueue
+ * jobs - a non-null pointer to an array of at least n jobs to copy to the 
+ *      queue
+ * n - the maximum number of jobs to enqueue
+ *
+ * Return:
+ * The number of jobs enqueued, 0 if pjq or jobs is NULL or n is not positive.
+ */
+int pri_jobqueue_enqueue_n(pri_jobqueue_t* pjq, job_t* jobs, int n);
+
+/*
+ * pri_jobqueue_borrow(pri_jobqueue_t* pjq)
+ *
+ * Dequeues the highest priority job without copying it. A pointer to the job
+ * in its slot of the queue's buffer is returned, and the slot is held for the
+ * caller until it is released with pri_jobqueue_commit.
+ *
+ * Once borrowed, a job is no longer on the queue: it is not counted by 
+ * pri_jobqueue_size and cannot be peeked at, dequeued or borrowed again.
+ * Its slot is not free either: it is not counted by pri_jobqueue_space, 
+ * and a queue whose free slots are all borrowed is full. The job in a 
+ * borrowed slot is unchanged until it is committed.
+ *
+ * Usage:
+ *      const job_t* j = pri_jobqueue_borrow(pjq);
+ *      if (j) {
+ *          ...                         // read *j in place
+ *          pri_jobqueue_commit(pjq, j);
+ *      }
+ *
+ * Parameters:
+ * pjq - a non-null pointer to a pri_jobqueue
+ *
+ * Return:
+ * A pointer to the borrowed job, or NULL if the queue is empty, pjq is NULL
+ * or the slots of the queue are compact (see pri_jobqueue_new_compact).
+ * The pointer must not be used after the job is committed.
+ */
+const job_t* pri_jobqueue_borrow(pri_jobqueue_t* pjq);
+
+/*
+ * pri_jobqueue_commit(pri_jobqueue_t* pjq, const job_t* job)
+ *
+ * Releases the slot of a job that was borrowed with pri_jobqueue_borrow. 
+ * The job in the slot is initialised and the slot becomes free, as if the 
+ * job had been dequeued. Borrowed jobs can be committed in any order.
+ *
+ * Parameters:
+ * pjq - a non-null pointer to a pri_jobqueue
+ * job - a pointer returned by pri_jobqueue_borrow for pjq
+ *
+ * Return:
+ * True if the slot was released, false if pjq or job is NULL or job is not a
+ * borrowed job of pjq, in which case the queue is unchanged.
+ */
+bool pri_jobqueue_commit(pri_jobqueue_t* pjq, const job_t* job);
+
+/*
+ * pri_jobqueue_enqueue_deadline(pri_jobqueue_t* pjq, deadline_job_t* job)
+ *
+ * As pri_jobqueue_enqueue for job->job, with job->deadline as the deadline
+ * of the enqueued job.
+ *
+ * Usage:
+ *      deadline_job_t dj;
+ *      job_set(&dj.job, getpid(), 1, 2, "report");
+ *      dj.deadline = job_clock_ms() + 500;
+ *      pri_jobqueue_enqueue_deadline(pjq, &dj);
+ *
+ * Return:
+ * True if the job was enqueued, false if pjq or job is NULL, the queue is 
+ * full or the job is not valid (its priority is 0).
+ */
+bool pri_jobqueue_enqueue_deadline(pri_jobqueue_t* pjq, deadline_job_t* job);
+
+/*
+ * pri_jobqueue_dequeue_deadline(pri_jobqueue_t* pjq, deadline_job_t* dst)
+ *
+ * As pri_jobqueue_dequeue, but the dequeued job and its deadline are copied 
+ * to dst, which must not be NULL.
+ *
+ * Return:
+ * dst, or NULL if pjq or dst is NULL or the queue is empty.
+ */
+deadline_job_t* pri_jobqueue_dequeue_deadline(pri_jobqueue_t* pjq, 
+    deadline_job_t* dst);
+
+/*
+ * pri_jobqueue_peek_reachable(pri_jobqueue_t* pjq, uint64_t now, 
+ *      deadline_job_t* dst)
+ *
+ * Copies to dst the first job in the order of the queue whose deadline is 
+ * not before now, that is, the job that pri_jobqueue_dequeue_reachable would
+ * dequeue. Jobs without a deadline are always reachable. The queue is not
+ * changed.
+ *
+ * Parameters:
+ * pjq - a pointer to an initialised pri_jobqueue
+ * now - a time of job_clock_ms, e.g. the current time plus the time it 
+ *      takes to do a job
+ * dst - a non-null pointer to the job to copy to
+ *
+ * Return:
+ * dst, or NULL if pjq or dst is NULL or no job on the queue has a reachable
+ * deadline.
+ */
+deadline_job_t* pri_jobqueue_peek_reachable(pri_jobqueue_t* pjq, uint64_t now,
+    deadline_job_t* dst);
+
+/*
+ * pri_jobqueue_dequeue_reachable(pri_jobqueue_t* pjq, uint64_t now, 
+ *      deadline_job_t* dst)
+ *
+ * Dequeues the first job in the order of the queue whose deadline is not 
+ * before now and copies it to dst. Jobs before it in the order of the queue,
+ * which have missed their deadlines, are left on the queue.
+ *
+ * Usage:
+ *      deadline_job_t dj;
+ *      // the most urgent job that can still be done in 20ms
+ *      if (pri_jobqueue_dequeue_reachable(pjq, job_clock_ms() + 20, &dj)) {
+ *          ...
+ *      }
+ *
+ * Return:
+ * dst, or NULL if pjq or dst is NULL or no job on the queue has a reachable
+ * deadline, in which case the queue is not changed.
+ */
+deadline_job_t* pri_jobqueue_dequeue_reachable(pri_jobqueue_t* pjq, 
+    uint64_t now, deadline_job_t* dst);
+
+/*
+ * pri_jobqueue_cancel(pri_jobqueue_t* pjq, pid_t pid, unsigned int id)
+ *
+ * Removes the queued job with the given pid and id from the queue without 
+ * dequeuing it. Its slot is free once the function returns. Borrowed jobs 
+ * are not on the queue and cannot be cancelled. If more than one queued job
+ * has the pid and id, the one enqueued (or last reprioritised) first is 
+ * removed.
+ *
+ * Usage:
+ *      pri_jobqueue_enqueue(pjq, job_set(&j, getpid(), 7, 3, "report"));
+ *      ...
+ *      pri_jobqueue_cancel(pjq, getpid(), 7);      // no longer needed
+ *
+ * Return:
+ * True if a job was removed, false if pjq is NULL or no queued job has the
+ * pid and id.
+ */
+bool pri_jobqueue_cancel(pri_jobqueue_t* pjq, pid_t pid, unsigned int id);
+
+/*
+ * pri_jobqueue_reprioritise(pri_jobqueue_t* pjq, pid_t pid, unsigned int id,
+ *      unsigned int priority)
+ *
+ * Changes the priority of the queued job with the given pid and id. The job
+ * keeps its slot and deadline but is ordered as if it had just been 
+ * enqueued with the new priority: behind the jobs of that priority that are
+ * already on the queue, and with its aging restarted if the queue ages jobs.
+ * If more than one queued job has the pid and id, the one enqueued (or 
+ * last reprioritised) first is changed.
+ *
+ * Return:
+ * True if the priority was changed, false if pjq is NULL, priority is 0 or
+ * no queued job has the pid and id.
+ */
+bool pri_jobqueue_reprioritise(pri_jobqueue_t* pjq, pid_t pid, unsigned int id,
+    unsigned int priority);
+
 /*
  * pri_jobqueue_is_empty(pri_jobqueue_t* pjq)
  *
@@ -362,6 +1177,7 @@ bool pri_jobqueue_is_empty(pri_jobqueue_t* pjq);
  *
  * Returns true if the queue is full, the number of jobs in the queue has 
  * reached queue capacity, and false otherwise. A NULL queue is considered full.
+ * Slots held by pri_jobqueue_borrow count towards the capacity in use.
  *
  * Usage: see pri_jobqueue_enqueue
  *
@@ -472,8 +1288,8 @@ int pri_jobqueue_size(pri_jobqueue_t* pjq);
  *
  * Returns available space in the given queue (the number of empty slots in
  * the queue's buffer). A queue's space is the total capacity of the queue's 
- * buffer less the size of the queue. When a queue is full, its space will 
- * be 0.
+ * buffer less the size of the queue and the number of borrowed slots (see 
+ * pri_jobqueue_borrow). When a queue is full, its space will be 0.
  * 
  * A slot in the queue's buffer is considered available if its job has a 
  * priority level of 0 (i.e is unused).
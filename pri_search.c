@@ -0,0 +1,245 @@
+/*
+ * Replace the following string of 0s with your student number
+ * 230278000
+ */
+#include <stddef.h>
+#include "pri_search.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PRI_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+/* 
+ * The min kernels search for the lowest value of prios[i] - 1. An unused 
+ * slot (0) wraps to UINT_MAX, so it never wins over a used one and the result
+ * + 1 wraps back to 0 when every slot is unused.
+ */
+
+static unsigned int min_scalar(const unsigned int* prios, int n) {
+    unsigned int least = ~0u;
+
+    for (int i = 0; i < n; i++) {
+        unsigned int p = prios[i] - 1;
+        if (p < least) least = p;
+    }
+
+    return least + 1;
+}
+
+static int find_scalar(const unsigned int* prios, int n, int from,
+    unsigned int value) {
+    for (int i = from; i < n; i++) {
+        if (prios[i] == value) return i;
+    }
+
+    return -1;
+}
+
+#ifdef PRI_SEARCH_X86
+
+__attribute__((target("sse4.1")))
+static unsigned int min_sse41(const unsigned int* prios, int n) {
+    __m128i one = _mm_set1_epi32(1);
+    __m128i least = _mm_set1_epi32(-1);
+    int i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (prios + i));
+        least = _mm_min_epu32(least, _mm_sub_epi32(v, one));
+    }
+
+    least = _mm_min_epu32(least, _mm_shuffle_epi32(least, 0x4e));
+    least = _mm_min_epu32(least, _mm_shuffle_epi32(least, 0xb1));
+
+    unsigned int tail = min_scalar(prios + i, n - i) - 1;
+    unsigned int vmin = (unsigned int) _mm_cvtsi128_si32(least);
+    return (tail < vmin ? tail : vmin) + 1;
+}
+
+__attribute__((target("sse4.1")))
+static int find_sse41(const unsigned int* prios, int n, int from,
+    unsigned int value) {
+    __m128i target = _mm_set1_epi32((int) value);
+    int i = from;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (prios + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, 
+            target)));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+
+    return find_scalar(prios, n, i, value);
+}
+
+__attribute__((target("avx2")))
+static unsigned int min_avx2(const unsigned int* prios, int n) {
+    __m256i one = _mm256_set1_epi32(1);
+    __m256i least0 = _mm256_set1_epi32(-1);
+    __m256i least1 = least0;
+    int i = 0;
+
+    /* two accumulators to hide the latency of the min */
+    for (; i + 16 <= n; i += 16) {
+        __m256i v0 = _mm256_loadu_si256((const __m256i*) (prios + i));
+        __m256i v1 = _mm256_loadu_si256((const __m256i*) (prios + i + 8));
+        least0 = _mm256_min_epu32(least0, _mm256_sub_epi32(v0, one));
+        least1 = _mm256_min_epu32(least1, _mm256_sub_epi32(v1, one));
+    }
+
+    least0 = _mm256_min_epu32(least0, least1);
+    __m128i least = _mm_min_epu32(_mm256_castsi256_si128(least0),
+        _mm256_extracti128_si256(least0, 1));
+    least = _mm_min_epu32(least, _mm_shuffle_epi32(least, 0x4e));
+    least = _mm_min_epu32(least, _mm_shuffle_epi32(least, 0xb1));
+
+    unsigned int tail = min_scalar(prios + i, n - i) - 1;
+    unsigned int vmin = (unsigned int) _mm_cvtsi128_si32(least);
+    return (tail < vmin ? tail : vmin) + 1;
+}
+
+__attribute__((target("avx2")))
+static int find_avx2(const unsigned int* prios, int n, int from,
+    unsigned int value) {
+    __m256i target = _mm256_set1_epi32((int) value);
+    int i = from;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*) (prios + i));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(v, target)));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+
+    return find_scalar(prios, n, i, value);
+}
+
+__attribute__((target("avx512f")))
+static unsigned int min_avx512(const unsigned int* prios, int n) {
+    __m512i one = _mm512_set1_epi32(1);
+    __m512i least = _mm512_set1_epi32(-1);
+    int i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_loadu_si512((const void*) (prios + i));
+        least = _mm512_min_epu32(least, _mm512_sub_epi32(v, one));
+    }
+
+    /* the tail is loaded masked, unloaded lanes keep ~0 */
+    if (i < n) {
+        __mmask16 tail = (__mmask16) ((1u << (n - i)) - 1);
+        __m512i v = _mm512_maskz_loadu_epi32(tail, prios + i);
+        least = _mm512_mask_min_epu32(least, tail, least, 
+            _mm512_sub_epi32(v, one));
+    }
+
+    return _mm512_reduce_min_epu32(least) + 1;
+}
+
+__attribute__((target("avx512f")))
+static int find_avx512(const unsigned int* prios, int n, int from,
+    unsigned int value) {
+    __m512i target = _mm512_set1_epi32((int) value);
+    int i = from;
+
+    for (; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_loadu_si512((const void*) (prios + i));
+        __mmask16 mask = _mm512_cmpeq_epi32_mask(v, target);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+
+    return find_scalar(prios, n, i, value);
+}
+
+#endif
+
+typedef struct kernels {
+    unsigned int (*min)(const unsigned int*, int);
+    int (*find)(const unsigned int*, int, int, unsigned int);
+} kernels_t;
+
+static const kernels_t isa_kernels[] = {
+    [PRI_SEARCH_SCALAR] = { min_scalar, find_scalar },
+#ifdef PRI_SEARCH_X86
+    [PRI_SEARCH_SSE41] = { min_sse41, find_sse41 },
+    [PRI_SEARCH_AVX2] = { min_avx2, find_avx2 },
+    [PRI_SEARCH_AVX512] = { min_avx512, find_avx512 },
+#endif
+};
+
+static const char* isa_names[] = { "scalar", "sse4.1", "avx2", "avx512" };
+
+/* NULL until the first call of a kernel selects the widest isa */
+static const kernels_t* active = NULL;
+static pri_search_isa_t active_isa = PRI_SEARCH_SCALAR;
+
+static bool valid_isa(pri_search_isa_t isa) {
+    return isa >= PRI_SEARCH_SCALAR && isa <= PRI_SEARCH_AVX512;
+}
+
+bool pri_search_isa_supported(pri_search_isa_t isa) {
+    if (!valid_isa(isa)) return false;
+    if (isa == PRI_SEARCH_SCALAR) return true;
+
+#ifdef PRI_SEARCH_X86
+    __builtin_cpu_init();
+    switch (isa) {
+    case PRI_SEARCH_SSE41:
+        return __builtin_cpu_supports("sse4.1");
+    case PRI_SEARCH_AVX2:
+        return __builtin_cpu_supports("avx2");
+    case PRI_SEARCH_AVX512:
+        return __builtin_cpu_supports("avx512f");
+    default:
+        return false;
+    }
+#else
+    return false;
+#endif
+}
+
+static const kernels_t* kernels(void) {
+    if (!active) {
+        pri_search_isa_t isa = PRI_SEARCH_AVX512;
+        while (!pri_search_isa_supported(isa))
+            isa--;
+        active_isa = isa;
+        active = &isa_kernels[isa];
+    }
+
+    return active;
+}
+
+unsigned int pri_search_min(const unsigned int* prios, int n) {
+    if (!prios || n <= 0) return 0;
+    return kernels()->min(prios, n);
+}
+
+int pri_search_find(const unsigned int* prios, int n, int from,
+    unsigned int value) {
+    if (!prios || from < 0 || from >= n) return -1;
+    return kernels()->find(prios, n, from, value);
+}
+
+int pri_search_first_min(const unsigned int* prios, int n) {
+    unsigned int least = pri_search_min(prios, n);
+    return least ? pri_search_find(prios, n, 0, least) : -1;
+}
+
+pri_search_isa_t pri_search_isa(void) {
+    kernels();
+    return active_isa;
+}
+
+bool pri_search_set_isa(pri_search_isa_t isa) {
+    if (!pri_search_isa_supported(isa)) return false;
+
+    active_isa = isa;
+    active = &isa_kernels[isa];
+    return true;
+}
+
+const char* pri_search_isa_name(pri_search_isa_t isa) {
+    return valid_isa(isa) ? isa_names[isa] : "unknown";
+}
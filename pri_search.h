@@ -0,0 +1,102 @@
+#ifndef _PRI_SEARCH_H
+#define _PRI_SEARCH_H
+#include <stdbool.h>
+
+/* 
+ * Introduction
+ * 
+ * This header defines search kernels over dense arrays of job priorities, 
+ * as kept by pri_jobqueue for its PRI_JOBQUEUE_SOA layout (see 
+ * pri_jobqueue.h). A priority of 0 marks an unused slot, 1 is the highest 
+ * priority and so on (see job.h).
+ *
+ * The functions:
+ *      pri_search_min(const unsigned int* prios, int n)
+ *      pri_search_find(const unsigned int* prios, int n, int from, 
+ *          unsigned int value)
+ *      pri_search_first_min(const unsigned int* prios, int n)
+ *      pri_search_isa()
+ *      pri_search_set_isa(pri_search_isa_t isa)
+ *      pri_search_isa_supported(pri_search_isa_t isa)
+ *      pri_search_isa_name(pri_search_isa_t isa)
+ *
+ * On x86 processors the kernels are vectorised with SSE4.1, AVX2 or 
+ * AVX-512. On first use, the widest instruction set that the CPU supports is
+ * selected. On other processors, and on x86 processors without SSE4.1, 
+ * scalar kernels are used. All kernels give identical results.
+ */
+
+/*
+ * Enumeration of the instruction sets the kernels can use, from narrowest 
+ * to widest.
+ */
+typedef enum pri_search_isa {
+    PRI_SEARCH_SCALAR, PRI_SEARCH_SSE41, PRI_SEARCH_AVX2, PRI_SEARCH_AVX512
+} pri_search_isa_t;
+
+/*
+ * pri_search_min(const unsigned int* prios, int n)
+ *
+ * Returns the highest priority (the lowest non-zero value) in the first n 
+ * elements of prios, or 0 if they are all 0 or n is not positive.
+ */
+unsigned int pri_search_min(const unsigned int* prios, int n);
+
+/*
+ * pri_search_find(const unsigned int* prios, int n, int from, 
+ *      unsigned int value)
+ *
+ * Returns the lowest index i, from <= i < n, for which prios[i] is value, 
+ * or -1 if there is none.
+ *
+ * Usage:
+ *      // visit every slot with priority p
+ *      for (int i = pri_search_find(prios, n, 0, p); i >= 0; 
+ *           i = pri_search_find(prios, n, i + 1, p)) 
+ *          ...
+ */
+int pri_search_find(const unsigned int* prios, int n, int from, 
+    unsigned int value);
+
+/*
+ * pri_search_first_min(const unsigned int* prios, int n)
+ *
+ * Returns the lowest index of the highest priority in the first n elements
+ * of prios, or -1 if they are all 0 or n is not positive.
+ */
+int pri_search_first_min(const unsigned int* prios, int n);
+
+/*
+ * pri_search_isa()
+ *
+ * Returns the instruction set used by the kernels.
+ */
+pri_search_isa_t pri_search_isa(void);
+
+/*
+ * pri_search_set_isa(pri_search_isa_t isa)
+ *
+ * Selects the instruction set used by the kernels, for example to compare 
+ * the kernels with each other or to benchmark them.
+ *
+ * Return:
+ * True if the kernels now use isa, false if isa is not valid or the CPU does
+ * not support it, in which case the selection is unchanged.
+ */
+bool pri_search_set_isa(pri_search_isa_t isa);
+
+/*
+ * pri_search_isa_supported(pri_search_isa_t isa)
+ *
+ * Returns true if the CPU and build support kernels for isa.
+ */
+bool pri_search_isa_supported(pri_search_isa_t isa);
+
+/*
+ * pri_search_isa_name(pri_search_isa_t isa)
+ *
+ * Returns a name for isa, such as "avx2", or "unknown" if it is not valid.
+ */
+const char* pri_search_isa_name(pri_search_isa_t isa);
+
+#endif
@@ -1,113 +1,372 @@
-#include "sem_jobqueue.h"
+/*
+ * Replace the following string of 0s with your student number
+ * 230278000
+ */
 #include <stdlib.h>
-#include <semaphore.h>
-#include <stdio.h>
-#include <string.h>
+#include <errno.h>
+#include <fcntl.h>           /* For O_* constants */
+#include <sys/stat.h>        /* For mode constants */
+#include "sem_jobqueue.h"
+#include "shobject_name.h"
+
+static sem_t* new_sem(proc_t* proc, const char* label, unsigned int value) {
+    char name[MAX_NAME_SIZE];
+    shobject_name(label, name);
+
+    if (proc->is_init) {
+        sem_unlink(name);
+        return sem_open(name, O_CREAT, S_IRUSR | S_IWUSR, value);
+    }
 
-struct sem_jobqueue {
-    jobqueue_t* base_queue; // Base job queue
-    sem_t mutex;            // Semaphore for mutual exclusion
-    sem_t full;             // Semaphore for counting filled slots
-    sem_t empty;            // Semaphore for counting empty slots
-};
+    return sem_open(name, 0);
+}
+
+static void delete_sem(sem_t* sem, const char* label) {
+    if (!sem || sem == SEM_FAILED) return;
+
+    char name[MAX_NAME_SIZE];
+    sem_close(sem);
+    shobject_name(label, name);
+    sem_unlink(name);
+}
+
+static void delete_sems(sem_jobqueue_t* sjq) {
+    delete_sem(sjq->mutex, "sjq.mutex");
+    delete_sem(sjq->full, "sjq.full");
+    delete_sem(sjq->empty, "sjq.empty");
+}
 
 sem_jobqueue_t* sem_jobqueue_new(proc_t* proc) {
-    if (!proc) return NULL;
+    return sem_jobqueue_new_sized(proc, JOB_BUFFER_SIZE);
+}
+
+sem_jobqueue_t* sem_jobqueue_new_sized(proc_t* proc, int capacity) {
+    if (!proc) {
+        errno = EINVAL;
+        return NULL;
+    }
 
-    sem_jobqueue_t* sjq = malloc(sizeof(sem_jobqueue_t));
+    sem_jobqueue_t* sjq = (sem_jobqueue_t*) malloc(sizeof(sem_jobqueue_t));
     if (!sjq) return NULL;
 
-    sjq->base_queue = jobqueue_new(proc);
-    if (!sjq->base_queue) {
+    sjq->ijq = ipc_jobqueue_new_sized(proc, capacity);
+    if (!sjq->ijq) {
         free(sjq);
         return NULL;
     }
 
-    if (sem_init(&sjq->mutex, 1, 1) == -1 ||
-        sem_init(&sjq->full, 1, 0) == -1 ||
-        sem_init(&sjq->empty, 1, JOB_BUFFER_SIZE) == -1) {
-        jobqueue_delete(sjq->base_queue);
+    sjq->mutex = new_sem(proc, "sjq.mutex", 1);
+    sjq->full = new_sem(proc, "sjq.full", 0);
+    sjq->empty = new_sem(proc, "sjq.empty", capacity);
+
+    if (sjq->mutex == SEM_FAILED || sjq->full == SEM_FAILED
+        || sjq->empty == SEM_FAILED) {
+        int err = errno;
+        delete_sems(sjq);
+        ipc_jobqueue_delete(sjq->ijq);
         free(sjq);
+        errno = err;
         return NULL;
     }
 
     return sjq;
 }
 
-void sem_jobqueue_delete(sem_jobqueue_t* sjq) {
-    if (!sjq) return;
+job_t* sem_jobqueue_dequeue(sem_jobqueue_t* sjq, job_t* dst) {
+    if (!sjq) return NULL;
 
-    jobqueue_delete(sjq->base_queue);
-    sem_destroy(&sjq->mutex);
-    sem_destroy(&sjq->full);
-    sem_destroy(&sjq->empty);
-    free(sjq);
+    if (sem_wait(sjq->full) == -1) return NULL;
+
+    if (sem_wait(sjq->mutex) == -1) {
+        sem_post(sjq->full);
+        return NULL;
+    }
+
+    job_t* job = ipc_jobqueue_dequeue(sjq->ijq, dst);
+
+    sem_post(sjq->mutex);
+    sem_post(job ? sjq->empty : sjq->full);
+
+    return job;
 }
 
-jobqueue_t* sem_jobqueue_enqueue(sem_jobqueue_t* sjq, const job_t* job) {
-    if (!sjq || !job) return NULL;
+void sem_jobqueue_enqueue(sem_jobqueue_t* sjq, job_t* job) {
+    if (!sjq || !job || job->priority == 0) return;
+
+    if (sem_wait(sjq->empty) == -1) return;
 
-    // Wait for an empty slot
-    sem_wait(&sjq->empty);
+    if (sem_wait(sjq->mutex) == -1) {
+        sem_post(sjq->empty);
+        return;
+    }
 
-    // Acquire mutex lock
-    sem_wait(&sjq->mutex);
+    /* 
+     * a job the queue rejects (e.g. for its label) gives back its slot, 
+     * which ipc_jobqueue_enqueue would not report
+     */
+    bool enqueued = ipc_jobqueue_enqueue_n(sjq->ijq, job, 1) == 1;
 
-    // Enqueue the job
-    jobqueue_t* result = jobqueue_enqueue(sjq->base_queue, job);
+    sem_post(sjq->mutex);
+    sem_post(enqueued ? sjq->full : sjq->empty);
+}
 
-    // Release mutex lock
-    sem_post(&sjq->mutex);
+/* 
+ * wait for one unit of sem then take up to max - 1 more units without 
+ * blocking, returning the number of units taken or 0 if sem_wait fails
+ */
+static int sem_take(sem_t* sem, int max) {
+    if (sem_wait(sem) == -1) return 0;
 
-    // Signal a filled slot
-    sem_post(&sjq->full);
+    int taken = 1;
+    while (taken < max && sem_trywait(sem) == 0)
+        taken++;
 
-    return result;
+    return taken;
 }
 
-jobqueue_t* sem_jobqueue_dequeue(sem_jobqueue_t* sjq, job_t* job) {
-    if (!sjq || !job) return NULL;
+static void sem_give(sem_t* sem, int count) {
+    for (int i = 0; i < count; i++)
+        sem_post(sem);
+}
 
-    // Wait for a filled slot
-    sem_wait(&sjq->full);
+int sem_jobqueue_dequeue_n(sem_jobqueue_t* sjq, job_t* dst, int n) {
+    if (!sjq || !dst || n <= 0) return 0;
 
-    // Acquire mutex lock
-    sem_wait(&sjq->mutex);
+    int taken = sem_take(sjq->full, n);
+    if (taken == 0) return 0;
 
-    // Dequeue the job
-    jobqueue_t* result = jobqueue_dequeue(sjq->base_queue, job);
+    if (sem_wait(sjq->mutex) == -1) {
+        sem_give(sjq->full, taken);
+        return 0;
+    }
 
-    // Release mutex lock
-    sem_post(&sjq->mutex);
+    int count = ipc_jobqueue_dequeue_n(sjq->ijq, dst, taken);
 
-    // Signal an empty slot
-    sem_post(&sjq->empty);
+    sem_post(sjq->mutex);
+    sem_give(sjq->empty, count);
+    sem_give(sjq->full, taken - count);
 
-    return result;
+    return count;
+}
+
+int sem_jobqueue_enqueue_n(sem_jobqueue_t* sjq, job_t* jobs, int n) {
+    if (!sjq || !jobs) return 0;
+
+    /* only claim slots for the jobs that enqueue_n will accept */
+    int valid = 0;
+    while (valid < n && jobs[valid].priority != 0)
+        valid++;
+    if (valid == 0) return 0;
+
+    int taken = sem_take(sjq->empty, valid);
+    if (taken == 0) return 0;
+
+    if (sem_wait(sjq->mutex) == -1) {
+        sem_give(sjq->empty, taken);
+        return 0;
+    }
+
+    int count = ipc_jobqueue_enqueue_n(sjq->ijq, jobs, taken);
+
+    sem_post(sjq->mutex);
+    sem_give(sjq->full, count);
+    sem_give(sjq->empty, taken - count);
+
+    return count;
+}
+
+const job_t* sem_jobqueue_borrow(sem_jobqueue_t* sjq) {
+    if (!sjq) return NULL;
+
+    if (sem_wait(sjq->full) == -1) return NULL;
+
+    if (sem_wait(sjq->mutex) == -1) {
+        sem_post(sjq->full);
+        return NULL;
+    }
+
+    const job_t* job = ipc_jobqueue_borrow(sjq->ijq);
+
+    /* empty is posted by the commit, when the slot is free again */
+    sem_post(sjq->mutex);
+    if (!job) sem_post(sjq->full);
+
+    return job;
+}
+
+bool sem_jobqueue_commit(sem_jobqueue_t* sjq, const job_t* job) {
+    if (!sjq) return false;
+
+    if (sem_wait(sjq->mutex) == -1) return false;
+    bool committed = ipc_jobqueue_commit(sjq->ijq, job);
+    sem_post(sjq->mutex);
+
+    if (committed) sem_post(sjq->empty);
+
+    return committed;
+}
+
+bool sem_jobqueue_set_order(sem_jobqueue_t* sjq, pri_jobqueue_order_t order) {
+    if (!sjq) return false;
+
+    if (sem_wait(sjq->mutex) == -1) return false;
+    bool set = ipc_jobqueue_set_order(sjq->ijq, order);
+    sem_post(sjq->mutex);
+
+    return set;
+}
+
+bool sem_jobqueue_enqueue_deadline(sem_jobqueue_t* sjq, deadline_job_t* job) {
+    if (!sjq || !job || job->job.priority == 0) return false;
+
+    if (sem_wait(sjq->empty) == -1) return false;
+
+    if (sem_wait(sjq->mutex) == -1) {
+        sem_post(sjq->empty);
+        return false;
+    }
+
+    bool enqueued = ipc_jobqueue_enqueue_deadline(sjq->ijq, job);
+
+    sem_post(sjq->mutex);
+    sem_post(enqueued ? sjq->full : sjq->empty);
+
+    return enqueued;
+}
+
+deadline_job_t* sem_jobqueue_dequeue_deadline(sem_jobqueue_t* sjq, 
+    deadline_job_t* dst) {
+    if (!sjq || !dst) return NULL;
+
+    if (sem_wait(sjq->full) == -1) return NULL;
+
+    if (sem_wait(sjq->mutex) == -1) {
+        sem_post(sjq->full);
+        return NULL;
+    }
+
+    deadline_job_t* job = ipc_jobqueue_dequeue_deadline(sjq->ijq, dst);
+
+    sem_post(sjq->mutex);
+    sem_post(job ? sjq->empty : sjq->full);
+
+    return job;
+}
+
+deadline_job_t* sem_jobqueue_peek_reachable(sem_jobqueue_t* sjq, uint64_t now,
+    deadline_job_t* dst) {
+    if (!sjq) return NULL;
+
+    if (sem_wait(sjq->mutex) == -1) return NULL;
+    deadline_job_t* job = ipc_jobqueue_peek_reachable(sjq->ijq, now, dst);
+    sem_post(sjq->mutex);
+
+    return job;
+}
+
+deadline_job_t* sem_jobqueue_dequeue_reachable(sem_jobqueue_t* sjq, 
+    uint64_t now, deadline_job_t* dst) {
+    if (!sjq || !dst) return NULL;
+
+    if (sem_wait(sjq->full) == -1) return NULL;
+
+    if (sem_wait(sjq->mutex) == -1) {
+        sem_post(sjq->full);
+        return NULL;
+    }
+
+    deadline_job_t* job = ipc_jobqueue_dequeue_reachable(sjq->ijq, now, dst);
+
+    sem_post(sjq->mutex);
+    sem_post(job ? sjq->empty : sjq->full);
+
+    return job;
+}
+
+bool sem_jobqueue_cancel(sem_jobqueue_t* sjq, pid_t pid, unsigned int id) {
+    if (!sjq) return false;
+
+    /* the unit of the job to cancel, unless consumers have claimed them all */
+    if (sem_trywait(sjq->full) == -1) return false;
+
+    if (sem_wait(sjq->mutex) == -1) {
+        sem_post(sjq->full);
+        return false;
+    }
+
+    bool cancelled = ipc_jobqueue_cancel(sjq->ijq, pid, id);
+
+    sem_post(sjq->mutex);
+    sem_post(cancelled ? sjq->empty : sjq->full);
+
+    return cancelled;
+}
+
+bool sem_jobqueue_reprioritise(sem_jobqueue_t* sjq, pid_t pid, unsigned int id,
+    unsigned int priority) {
+    if (!sjq) return false;
+
+    if (sem_wait(sjq->mutex) == -1) return false;
+    bool changed = ipc_jobqueue_reprioritise(sjq->ijq, pid, id, priority);
+    sem_post(sjq->mutex);
+
+    return changed;
 }
 
 bool sem_jobqueue_is_empty(sem_jobqueue_t* sjq) {
     if (!sjq) return true;
 
-    // Check if the base queue is empty
-    bool is_empty;
-
-    sem_wait(&sjq->mutex); // Lock mutex
-    is_empty = jobqueue_is_empty(sjq->base_queue);
-    sem_post(&sjq->mutex); // Unlock mutex
+    if (sem_wait(sjq->mutex) == -1) return true;
+    bool is_empty = ipc_jobqueue_is_empty(sjq->ijq);
+    sem_post(sjq->mutex);
 
     return is_empty;
 }
 
 bool sem_jobqueue_is_full(sem_jobqueue_t* sjq) {
-    if (!sjq) return false;
-
-    // Check if the base queue is full
-    bool is_full;
+    if (!sjq) return true;
 
-    sem_wait(&sjq->mutex); // Lock mutex
-    is_full = jobqueue_is_full(sjq->base_queue);
-    sem_post(&sjq->mutex); // Unlock mutex
+    if (sem_wait(sjq->mutex) == -1) return true;
+    bool is_full = ipc_jobqueue_is_full(sjq->ijq);
+    sem_post(sjq->mutex);
 
     return is_full;
 }
+
+job_t* sem_jobqueue_peek(sem_jobqueue_t* sjq, job_t* dst) {
+    if (!sjq) return NULL;
+
+    if (sem_wait(sjq->mutex) == -1) return NULL;
+    job_t* job = ipc_jobqueue_peek(sjq->ijq, dst);
+    sem_post(sjq->mutex);
+
+    return job;
+}
+
+int sem_jobqueue_size(sem_jobqueue_t* sjq) {
+    if (!sjq) return 0;
+
+    if (sem_wait(sjq->mutex) == -1) return -1;
+    int size = ipc_jobqueue_size(sjq->ijq);
+    sem_post(sjq->mutex);
+
+    return size;
+}
+
+int sem_jobqueue_space(sem_jobqueue_t* sjq) {
+    if (!sjq) return 0;
+
+    if (sem_wait(sjq->mutex) == -1) return -1;
+    int space = ipc_jobqueue_space(sjq->ijq);
+    sem_post(sjq->mutex);
+
+    return space;
+}
+
+void sem_jobqueue_delete(sem_jobqueue_t* sjq) {
+    if (!sjq) return;
+
+    delete_sems(sjq);
+    ipc_jobqueue_delete(sjq->ijq);
+    free(sjq);
+}
@@ -11,8 +11,26 @@
  * 
  * This header file defines a sem_jobqueue type and its interface:
  *      sem_jobqueue_new(proc_t* proc);
+ *      sem_jobqueue_new_sized(proc_t* proc, int capacity);
  *      sem_jobqueue_dequeue(sem_jobqueue_t* sjq, job_t* dst);
  *      sem_jobqueue_enqueue(sem_jobqueue_t* sjq, job_t* job);
+ *      sem_jobqueue_dequeue_n(sem_jobqueue_t* sjq, job_t* dst, int n);
+ *      sem_jobqueue_enqueue_n(sem_jobqueue_t* sjq, job_t* jobs, int n);
+ *      sem_jobqueue_borrow(sem_jobqueue_t* sjq);
+ *      sem_jobqueue_commit(sem_jobqueue_t* sjq, const job_t* job);
+ *      sem_jobqueue_set_order(sem_jobqueue_t* sjq, 
+ *          pri_jobqueue_order_t order);
+ *      sem_jobqueue_enqueue_deadline(sem_jobqueue_t* sjq, 
+ *          deadline_job_t* job);
+ *      sem_jobqueue_dequeue_deadline(sem_jobqueue_t* sjq, 
+ *          deadline_job_t* dst);
+ *      sem_jobqueue_peek_reachable(sem_jobqueue_t* sjq, uint64_t now,
+ *          deadline_job_t* dst);
+ *      sem_jobqueue_dequeue_reachable(sem_jobqueue_t* sjq, uint64_t now,
+ *          deadline_job_t* dst);
+ *      sem_jobqueue_cancel(sem_jobqueue_t* sjq, pid_t pid, unsigned int id);
+ *      sem_jobqueue_reprioritise(sem_jobqueue_t* sjq, pid_t pid, 
+ *          unsigned int id, unsigned int priority);
  *      sem_jobqueue_is_empty(sem_jobqueue_t* sjq);
  *      sem_jobqueue_is_full(sem_jobqueue_t* sjq);
  *      sem_jobqueue_peek(sem_jobqueue_t* sjq, job_t* dst);
@@ -106,6 +124,28 @@ typedef struct sem_jobqueue {
  */
 sem_jobqueue_t* sem_jobqueue_new(proc_t* proc);
 
+/*
+ * sem_jobqueue_new_sized(proc_t* proc, int capacity)
+ * 
+ * As sem_jobqueue_new but the underlying queue holds capacity jobs (see 
+ * ipc_jobqueue_new_sized) and the empty semaphore is initialised to 
+ * capacity. sem_jobqueue_new creates a queue of JOB_BUFFER_SIZE jobs.
+ *
+ * Every process sharing the queue must pass the same capacity.
+ *
+ * Parameters:
+ * proc - the non-null descriptor of a process sharing this queue
+ * capacity - the number of jobs the queue can hold, from 1 to 
+ *      PRI_JOBQUEUE_MAX_CAPACITY
+ *
+ * Return:
+ * As for sem_jobqueue_new.
+ *
+ * Errors:
+ * As for sem_jobqueue_new. errno is set to EINVAL if capacity is invalid.
+ */
+sem_jobqueue_t* sem_jobqueue_new_sized(proc_t* proc, int capacity);
+
 /*
  * sem_jobqueue_dequeue(sem_jobqueue_t* sjq, job_t* dst)
  *
@@ -156,6 +196,9 @@ job_t* sem_jobqueue_dequeue(sem_jobqueue_t* sjq, job_t* dst);
  *  - If a sem_wait call on a semaphore protecting the queue fails, this
  *      function will return without enqueueing a job and the state of the 
  *      queue will not be changed.
+ *  - If the queue does not accept the job (e.g. its label is not valid, see
+ *      job_copy), the slot the function waited for is released again, so 
+ *      the semaphores still count the jobs and free slots of the queue.
  *  - If the sjq parameter is NULL, this function returns and no semaphore
  *      or other operation is invoked.
  *
@@ -169,6 +212,195 @@ job_t* sem_jobqueue_dequeue(sem_jobqueue_t* sjq, job_t* dst);
  */
 void sem_jobqueue_enqueue(sem_jobqueue_t* sjq, job_t* job);
 
+/*
+ * sem_jobqueue_dequeue_n(sem_jobqueue_t* sjq, job_t* dst, int n)
+ *
+ * This is a wrapper for ipc_jobqueue_dequeue_n.
+ *
+ * The calling process blocks until at least one job is on the queue, as for
+ * sem_jobqueue_dequeue. It then takes as many of the jobs that are on the 
+ * queue as it can, up to n, without blocking again and dequeues them all 
+ * under a single acquisition of the mutex.
+ *
+ * Return:
+ * The number of jobs copied to dst, which is at least 1 on success. 
+ * 0 if sjq or dst is NULL, n is not positive or a sem_wait call fails, in
+ * which case the state of the queue is not changed.
+ *
+ * Errors:
+ * See sem_jobqueue_dequeue.
+ */
+int sem_jobqueue_dequeue_n(sem_jobqueue_t* sjq, job_t* dst, int n);
+
+/*
+ * sem_jobqueue_enqueue_n(sem_jobqueue_t* sjq, job_t* jobs, int n)
+ *
+ * This is a wrapper for ipc_jobqueue_enqueue_n.
+ *
+ * The jobs considered for enqueuing are those of the array up to the first
+ * job with an invalid priority (see pri_jobqueue_enqueue_n). The calling 
+ * process blocks until there is space for at least one of them, as for 
+ * sem_jobqueue_enqueue. It then claims as many free slots as it can, up to 
+ * the number of jobs, without blocking again and enqueues that many jobs
+ * under a single acquisition of the mutex. To enqueue a whole burst, call 
+ * this function again from the first job that was not enqueued.
+ *
+ * Usage:
+ *      int sent = 0;
+ *      while (sent < n) {
+ *          int k = sem_jobqueue_enqueue_n(sjq, jobs + sent, n - sent);
+ *          if (k == 0) break;          // invalid job or semaphore failure
+ *          sent += k;
+ *      }
+ *
+ * Return:
+ * The number of jobs enqueued, which is also the index of the first job that 
+ * was not enqueued. 0 if sjq or jobs is NULL, n is not positive, the first 
+ * job is invalid or a sem_wait call fails, in which case the state of the 
+ * queue is not changed.
+ *
+ * Errors:
+ * See sem_jobqueue_enqueue.
+ */
+int sem_jobqueue_enqueue_n(sem_jobqueue_t* sjq, job_t* jobs, int n);
+
+/*
+ * sem_jobqueue_borrow(sem_jobqueue_t* sjq)
+ *
+ * This is a wrapper for ipc_jobqueue_borrow.
+ *
+ * As for sem_jobqueue_dequeue, the calling process blocks until there is a 
+ * job on the queue. The job is borrowed under the mutex, but the mutex is 
+ * released before this function returns: other processes can use the queue 
+ * while the caller reads the borrowed job in place. This is safe because a
+ * borrowed slot is neither on the queue nor free, so no other queue 
+ * operation reads or writes it.
+ *
+ * The borrowed slot is not available to producers until the job is 
+ * committed with sem_jobqueue_commit. Every successful borrow must be 
+ * followed by a commit.
+ *
+ * Usage:
+ *      const job_t* j = sem_jobqueue_borrow(sjq);
+ *      if (j) {
+ *          ...                         // read *j, the mutex is not held
+ *          sem_jobqueue_commit(sjq, j);
+ *      }
+ *
+ * Return:
+ * A pointer to the borrowed job in the shared memory of the queue, or NULL 
+ * if sjq is NULL or a sem_wait call fails, in which case the state of the 
+ * queue is not changed.
+ *
+ * Errors:
+ * See sem_jobqueue_dequeue.
+ */
+const job_t* sem_jobqueue_borrow(sem_jobqueue_t* sjq);
+
+/*
+ * sem_jobqueue_commit(sem_jobqueue_t* sjq, const job_t* job)
+ *
+ * This is a wrapper for ipc_jobqueue_commit.
+ *
+ * Releases the slot of a job borrowed with sem_jobqueue_borrow under the 
+ * mutex and signals that a slot is free, waking a producer blocked on a 
+ * full queue.
+ *
+ * Return:
+ * True if the slot was released. False if sjq is NULL, job is not a borrowed
+ * job of the queue or a sem_wait call fails, in which case the state of the 
+ * queue is not changed.
+ *
+ * Errors:
+ * See sem_jobqueue_dequeue.
+ */
+bool sem_jobqueue_commit(sem_jobqueue_t* sjq, const job_t* job);
+
+/*
+ * sem_jobqueue_set_order(sem_jobqueue_t* sjq, pri_jobqueue_order_t order)
+ *
+ * This is a wrapper for ipc_jobqueue_set_order, called under the mutex.
+ *
+ * Return:
+ * As for ipc_jobqueue_set_order, or false if a sem_wait call fails.
+ */
+bool sem_jobqueue_set_order(sem_jobqueue_t* sjq, pri_jobqueue_order_t order);
+
+/*
+ * sem_jobqueue_enqueue_deadline(sem_jobqueue_t* sjq, deadline_job_t* job)
+ * sem_jobqueue_dequeue_deadline(sem_jobqueue_t* sjq, deadline_job_t* dst)
+ *
+ * These are wrappers for ipc_jobqueue_enqueue_deadline and 
+ * ipc_jobqueue_dequeue_deadline. They block, as sem_jobqueue_enqueue and 
+ * sem_jobqueue_dequeue do, until there is a free slot or a job on the queue.
+ *
+ * Return:
+ * As for the ipc_jobqueue functions, or false or NULL if a sem_wait call 
+ * fails, in which case the state of the queue is not changed.
+ */
+bool sem_jobqueue_enqueue_deadline(sem_jobqueue_t* sjq, deadline_job_t* job);
+deadline_job_t* sem_jobqueue_dequeue_deadline(sem_jobqueue_t* sjq, 
+    deadline_job_t* dst);
+
+/*
+ * sem_jobqueue_peek_reachable(sem_jobqueue_t* sjq, uint64_t now,
+ *      deadline_job_t* dst)
+ *
+ * This is a wrapper for ipc_jobqueue_peek_reachable, called under the mutex.
+ * It does not block if the queue is empty.
+ */
+deadline_job_t* sem_jobqueue_peek_reachable(sem_jobqueue_t* sjq, uint64_t now,
+    deadline_job_t* dst);
+
+/*
+ * sem_jobqueue_dequeue_reachable(sem_jobqueue_t* sjq, uint64_t now,
+ *      deadline_job_t* dst)
+ *
+ * This is a wrapper for ipc_jobqueue_dequeue_reachable.
+ *
+ * As for sem_jobqueue_dequeue, the calling process blocks until there is a 
+ * job on the queue. It does not wait for a job with a reachable deadline: if
+ * every job on the queue has missed its deadline, NULL is returned at once.
+ *
+ * Return:
+ * dst, or NULL if sjq is NULL, no job on the queue has a reachable deadline
+ * or a sem_wait call fails, in which case the state of the queue is not 
+ * changed.
+ */
+deadline_job_t* sem_jobqueue_dequeue_reachable(sem_jobqueue_t* sjq, 
+    uint64_t now, deadline_job_t* dst);
+
+/*
+ * sem_jobqueue_cancel(sem_jobqueue_t* sjq, pid_t pid, unsigned int id)
+ *
+ * This is a wrapper for ipc_jobqueue_cancel.
+ *
+ * A cancelled job leaves the queue without being dequeued, so the function 
+ * takes a unit of the full semaphore for it, without blocking, before it 
+ * takes the mutex, and posts empty once the job has been removed. If every
+ * job on the queue has already been claimed by a consumer that is waiting 
+ * for the mutex, there is no unit to take and the job is not cancelled: it
+ * is about to be dequeued. The mutex is held for a constant or logarithmic
+ * time (see pri_jobqueue_cancel), not for a drain of the queue.
+ *
+ * Return:
+ * True if the job was removed. False if sjq is NULL, no queued job has the 
+ * pid and id, every queued job has been claimed or a sem_wait call fails.
+ */
+bool sem_jobqueue_cancel(sem_jobqueue_t* sjq, pid_t pid, unsigned int id);
+
+/*
+ * sem_jobqueue_reprioritise(sem_jobqueue_t* sjq, pid_t pid, unsigned int id,
+ *      unsigned int priority)
+ *
+ * This is a wrapper for ipc_jobqueue_reprioritise, called under the mutex.
+ *
+ * Return:
+ * As for ipc_jobqueue_reprioritise, or false if a sem_wait call fails.
+ */
+bool sem_jobqueue_reprioritise(sem_jobqueue_t* sjq, pid_t pid, unsigned int id,
+    unsigned int priority);
+
 /*
  * sem_jobqueue_is_empty(sem_jobqueue_t* sjq)
  *
@@ -278,13 +510,13 @@ job_t* sem_jobqueue_peek(sem_jobqueue_t* sjq, job_t* dst);
  *      the calling process will block until the mutex is available.
  *  - If a sem_wait call on a semaphore protecting the queue fails, this
  *      function will return -1 regardless of the state of the queue.
- *  - If the sjq parameter is NULL, this function returns -1 and no semaphore
+ *  - If the sjq parameter is NULL, this function returns 0 and no semaphore
  *      or other operation is invoked.
  *
  * This function does not change the state of the queue.
  *
  * Return:
- * The size of the queue or -1 if sjq is NULL or sem_wait fails.
+ * The size of the queue, 0 if sjq is NULL or -1 if sem_wait fails.
  *
  * Errors:
  * See errors specified in ipc_jobqueue.h and pri_jobqueue.h
@@ -308,13 +540,14 @@ int sem_jobqueue_size(sem_jobqueue_t* sjq);
  *      the calling process will block until the mutex is available.
  *  - If a sem_wait call on a semaphore protecting the queue fails, this
  *      function will return -1 regardless of the state of the queue.
- *  - If the sjq parameter is NULL, this function returns -1 and no semaphore
+ *  - If the sjq parameter is NULL, this function returns 0 and no semaphore
  *      or other operation is invoked.
  *
  * This function does not change the state of the queue.
  *
  * Return:
- * The space (empty slots) in the queue or -1 if sjq is NULL or sem_wait fails.
+ * The space (empty slots) in the queue, 0 if sjq is NULL or -1 if sem_wait 
+ * fails.
  *
  * Errors:
  * See errors specified in ipc_jobqueue.h and pri_jobqueue.h
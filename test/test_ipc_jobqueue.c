@@ -198,6 +198,304 @@ MunitResult test_ipcjq_space_null(const MunitParameter params[],
     return test_jq_space_null((test_jq_t*) fixture);
 }
 
+MunitResult test_ipc_jobqueue_new_sized(const MunitParameter params[], 
+    void* fixture) {
+    proc_t* proc = new_init_proc();
+    int capacity = JOB_BUFFER_SIZE * 8 + 3;
+    ipc_jobqueue_t* q = ipc_jobqueue_new_sized(proc, capacity);
+    
+    assert_not_null(q);
+    
+    pri_jobqueue_t* pjq = (pri_jobqueue_t*) q->addr;
+    assert_int(pjq->buf_size, ==, capacity);
+    assert_true(jobs_initialised(pjq->jobs, capacity, capacity));
+    
+    // every slot of the shared mapping is usable
+    job_t j;
+    for (int i = 0; i < capacity; i++) {
+        set_job(&j, i + 1, i, i % 7 + 1);
+        ipc_jobqueue_enqueue(q, &j);
+    }
+    
+    assert_true(ipc_jobqueue_is_full(q));
+    assert_true(jobs_valid(pjq->jobs, capacity, capacity));
+    
+    ipc_delete(q);
+    
+    assert_null(ipc_jobqueue_new_sized(proc, 0));
+    
+    proc_delete(proc);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_ipc_jobqueue_batch(const MunitParameter params[], 
+    void* fixture) {
+    proc_t* proc = new_init_proc();
+    ipc_jobqueue_t* q = ipc_jobqueue_new(proc);
+    job_t jobs[JOB_BUFFER_SIZE];
+    job_t out[JOB_BUFFER_SIZE];
+    
+    assert_not_null(q);
+    
+    for (int i = 0; i < JOB_BUFFER_SIZE; i++)
+        set_job(&jobs[i], i + 1, i, i + 1);
+    
+    assert_int(ipc_jobqueue_enqueue_n(q, jobs, JOB_BUFFER_SIZE), ==, 
+        JOB_BUFFER_SIZE);
+    assert_true(ipc_jobqueue_is_full(q));
+    assert_int(ipc_jobqueue_dequeue_n(q, out, 10), ==, 10);
+    assert_int(ipc_jobqueue_dequeue_n(q, out + 10, JOB_BUFFER_SIZE), ==, 
+        JOB_BUFFER_SIZE - 10);
+    assert_true(ipc_jobqueue_is_empty(q));
+    
+    for (int i = 0; i < JOB_BUFFER_SIZE; i++)
+        assert_true(equal_jobs(&out[i], &jobs[i]));
+    
+    assert_int(ipc_jobqueue_enqueue_n(NULL, jobs, 1), ==, 0);
+    assert_int(ipc_jobqueue_dequeue_n(NULL, out, 1), ==, 0);
+    
+    ipc_delete(q);
+    proc_delete(proc);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_ipc_jobqueue_borrow(const MunitParameter params[], 
+    void* fixture) {
+    proc_t* proc = new_init_proc();
+    ipc_jobqueue_t* q = ipc_jobqueue_new(proc);
+    pri_jobqueue_t* pjq = (pri_jobqueue_t*) q->addr;
+    job_t j;
+    
+    assert_null(ipc_jobqueue_borrow(q));
+    
+    set_job(&j, 2, 2, 2);
+    ipc_jobqueue_enqueue(q, &j);
+    set_job(&j, 1, 1, 1);
+    ipc_jobqueue_enqueue(q, &j);
+    
+    // the borrowed job is read in place in the shared mapping
+    const job_t* b = ipc_jobqueue_borrow(q);
+    assert_true(b >= pjq->jobs && b < pjq->jobs + pjq->buf_size);
+    assert_true(equal_jobs((job_t*) b, &j));
+    assert_int(ipc_jobqueue_size(q), ==, 1);
+    assert_int(ipc_jobqueue_space(q), ==, JOB_BUFFER_SIZE - 2);
+    
+    assert_true(ipc_jobqueue_commit(q, b));
+    assert_false(ipc_jobqueue_commit(q, b));
+    assert_int(ipc_jobqueue_space(q), ==, JOB_BUFFER_SIZE - 1);
+    
+    assert_null(ipc_jobqueue_borrow(NULL));
+    assert_false(ipc_jobqueue_commit(NULL, b));
+    
+    ipc_delete(q);
+    proc_delete(proc);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_ipc_jobqueue_deadline(const MunitParameter params[], 
+    void* fixture) {
+    proc_t* proc = new_init_proc();
+    ipc_jobqueue_t* q = ipc_jobqueue_new(proc);
+    deadline_job_t dj;
+    
+    assert_true(ipc_jobqueue_set_order(q, PRI_JOBQUEUE_BY_DEADLINE));
+    
+    // the later deadline is dequeued last despite its higher priority
+    set_job(&dj.job, 1, 1, 1);
+    dj.deadline = 200;
+    assert_true(ipc_jobqueue_enqueue_deadline(q, &dj));
+    set_job(&dj.job, 2, 2, 5);
+    dj.deadline = 100;
+    assert_true(ipc_jobqueue_enqueue_deadline(q, &dj));
+    set_job(&dj.job, 3, 3, 2);
+    dj.deadline = 50;
+    assert_true(ipc_jobqueue_enqueue_deadline(q, &dj));
+    
+    // the job due at 50 cannot be reached at 60
+    assert_not_null(ipc_jobqueue_peek_reachable(q, 60, &dj));
+    assert_int(dj.job.id, ==, 2);
+    assert_not_null(ipc_jobqueue_dequeue_reachable(q, 60, &dj));
+    assert_int(dj.job.id, ==, 2);
+    assert_true(dj.deadline == 100);
+    assert_null(ipc_jobqueue_dequeue_reachable(q, 201, &dj));
+    
+    assert_not_null(ipc_jobqueue_dequeue_deadline(q, &dj));
+    assert_int(dj.job.id, ==, 3);
+    assert_not_null(ipc_jobqueue_dequeue_deadline(q, &dj));
+    assert_int(dj.job.id, ==, 1);
+    assert_true(ipc_jobqueue_is_empty(q));
+    
+    assert_false(ipc_jobqueue_set_order(NULL, PRI_JOBQUEUE_BY_DEADLINE));
+    assert_false(ipc_jobqueue_enqueue_deadline(NULL, &dj));
+    assert_null(ipc_jobqueue_dequeue_deadline(NULL, &dj));
+    assert_null(ipc_jobqueue_peek_reachable(NULL, 0, &dj));
+    assert_null(ipc_jobqueue_dequeue_reachable(NULL, 0, &dj));
+    
+    ipc_delete(q);
+    proc_delete(proc);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_ipc_jobqueue_cancel(const MunitParameter params[], 
+    void* fixture) {
+    proc_t* proc = new_init_proc();
+    ipc_jobqueue_t* q = ipc_jobqueue_new(proc);
+    job_t j;
+    
+    for (int i = 1; i <= 3; i++) {
+        set_job(&j, i, i, i);
+        ipc_jobqueue_enqueue(q, &j);
+    }
+    
+    assert_true(ipc_jobqueue_cancel(q, 1, 1));
+    assert_false(ipc_jobqueue_cancel(q, 1, 1));
+    assert_true(ipc_jobqueue_reprioritise(q, 3, 3, 1));
+    assert_int(ipc_jobqueue_size(q), ==, 2);
+    
+    assert_not_null(ipc_jobqueue_dequeue(q, &j));
+    assert_int(j.id, ==, 3);
+    assert_uint(j.priority, ==, 1);
+    assert_not_null(ipc_jobqueue_dequeue(q, &j));
+    assert_int(j.id, ==, 2);
+    
+    assert_false(ipc_jobqueue_cancel(NULL, 2, 2));
+    assert_false(ipc_jobqueue_reprioritise(NULL, 2, 2, 1));
+    
+    ipc_delete(q);
+    proc_delete(proc);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_ipc_jobqueue_compact(const MunitParameter params[], 
+    void* fixture) {
+    test_procs_t* tp = new_test_procs();
+    int capacity = JOB_BUFFER_SIZE * 4;
+    ipc_jobqueue_t* q = ipc_jobqueue_new_compact(tp->pin, capacity, 4);
+    
+    assert_not_null(q);
+    assert_true(pri_jobqueue_sizeof_compact(capacity, 4) 
+        < pri_jobqueue_sizeof(capacity));
+    
+    // a process that maps the queue elsewhere sees the same jobs and labels
+    ipc_jobqueue_t* qni = ipc_jobqueue_new_compact(tp->pni, capacity, 4);
+    assert_not_null(qni);
+    
+    const char* labels[] = { "alpha", "beta", "gamma" };
+    job_t jobs[JOB_BUFFER_SIZE];
+    job_t j;
+    
+    for (int i = 0; i < JOB_BUFFER_SIZE; i++) {
+        job_set(&jobs[i], i + 1, i, i % 5 + 1, labels[i % 3]);
+        ipc_jobqueue_enqueue(q, &jobs[i]);
+    }
+    
+    assert_int(ipc_jobqueue_size(qni), ==, JOB_BUFFER_SIZE);
+    assert_int(label_table_count(ipc_jobqueue_labels(qni)), ==, 3);
+    
+    // jobs come out in priority then FIFO order with their labels expanded
+    assert_not_null(ipc_jobqueue_peek(qni, &j));
+    assert_true(equal_jobs(&j, &jobs[0]));
+    
+    int next[5] = { 0, 1, 2, 3, 4 };
+    for (int n = 0; n < JOB_BUFFER_SIZE; n++) {
+        unsigned int pri = 0;
+        while (next[pri] >= JOB_BUFFER_SIZE) pri++;
+        job_t* expect = &jobs[next[pri]];
+        next[pri] += 5;
+        
+        if (n % 2) {
+            assert_not_null(ipc_jobqueue_dequeue(qni, &j));
+            assert_true(equal_jobs(&j, expect));
+        } else {
+            // a compact job converts to the same entry as its job
+            compact_job_t cj;
+            char str[JOB_STR_SIZE];
+            char expect_str[JOB_STR_SIZE];
+            
+            assert_not_null(ipc_jobqueue_dequeue_compact(qni, &cj));
+            assert_not_null(label_table_to_str(ipc_jobqueue_labels(q), &cj, 
+                str));
+            assert_not_null(job_to_str(expect, expect_str));
+            assert_string_equal(str, expect_str);
+        }
+    }
+    
+    assert_true(ipc_jobqueue_is_empty(q));
+    
+    ipc_delete(qni);
+    ipc_delete(q);
+    delete_test_procs(tp);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_ipc_jobqueue_compact_labels(const MunitParameter params[], 
+    void* fixture) {
+    proc_t* proc = new_init_proc();
+    ipc_jobqueue_t* q = ipc_jobqueue_new_compact(proc, JOB_BUFFER_SIZE, 2);
+    compact_job_t cj;
+    deadline_job_t dj;
+    job_t j;
+    
+    assert_not_null(q);
+    
+    job_set(&j, 1, 1, 2, "one");
+    ipc_jobqueue_enqueue(q, &j);
+    job_set(&j, 2, 2, 1, "two");
+    ipc_jobqueue_enqueue(q, &j);
+    
+    // a third label does not fit the table, a known label still does
+    job_set(&j, 3, 3, 1, "three");
+    ipc_jobqueue_enqueue(q, &j);
+    assert_int(ipc_jobqueue_size(q), ==, 2);
+    assert_int(ipc_jobqueue_space(q), ==, JOB_BUFFER_SIZE - 2);
+    job_set(&j, 4, 4, 3, "one");
+    ipc_jobqueue_enqueue(q, &j);
+    assert_int(ipc_jobqueue_size(q), ==, 3);
+    
+    // compact slots cannot be borrowed in place
+    assert_null(ipc_jobqueue_borrow(q));
+    assert_int(ipc_jobqueue_size(q), ==, 3);
+    
+    // cancel, reprioritise and the deadline functions work on compact slots
+    assert_true(ipc_jobqueue_reprioritise(q, 1, 1, 1));
+    assert_true(ipc_jobqueue_cancel(q, 2, 2));
+    assert_not_null(ipc_jobqueue_dequeue_deadline(q, &dj));
+    assert_int(dj.job.id, ==, 1);
+    assert_uint(dj.job.priority, ==, 1);
+    assert_string_equal(dj.job.label, j.label);
+    
+    job_t* top = ipc_jobqueue_dequeue(q, NULL);
+    assert_not_null(top);
+    assert_true(equal_jobs(top, &j));
+    job_delete(top);
+    assert_null(ipc_jobqueue_dequeue_compact(q, &cj));
+    
+    assert_null(ipc_jobqueue_dequeue_compact(q, NULL));
+    assert_null(ipc_jobqueue_dequeue_compact(NULL, &cj));
+    assert_null(ipc_jobqueue_labels(NULL));
+    assert_null(ipc_jobqueue_new_compact(proc, JOB_BUFFER_SIZE, 0));
+    
+    ipc_delete(q);
+    
+    // a queue of job_t slots has no label table
+    q = ipc_jobqueue_new(proc);
+    assert_null(ipc_jobqueue_labels(q));
+    ipc_jobqueue_enqueue(q, &j);
+    assert_null(ipc_jobqueue_dequeue_compact(q, &cj));
+    assert_int(ipc_jobqueue_size(q), ==, 1);
+    
+    ipc_delete(q);
+    proc_delete(proc);
+    
+    return MUNIT_OK;
+}
+
 MunitResult test_ipc_jobqueue_delete(const MunitParameter params[], 
     void* fixture) {
     proc_t* proc = new_init_proc();
@@ -74,6 +74,23 @@ MunitResult test_ipcjq_space_nqfilling(const MunitParameter params[],
 MunitResult test_ipcjq_space_null(const MunitParameter params[], 
     void* fixture);
 
+MunitResult test_ipc_jobqueue_new_sized(const MunitParameter params[],
+    void* fixture);
+
+MunitResult test_ipc_jobqueue_batch(const MunitParameter params[], 
+    void* fixture);
+
+MunitResult test_ipc_jobqueue_borrow(const MunitParameter params[], 
+    void* fixture);
+
+MunitResult test_ipc_jobqueue_deadline(const MunitParameter params[], 
+    void* fixture);
+MunitResult test_ipc_jobqueue_cancel(const MunitParameter params[], 
+    void* fixture);
+MunitResult test_ipc_jobqueue_compact(const MunitParameter params[], 
+    void* fixture);
+MunitResult test_ipc_jobqueue_compact_labels(const MunitParameter params[], 
+    void* fixture);
 MunitResult test_ipc_jobqueue_delete(const MunitParameter params[], 
     void* fixture);
 
@@ -153,6 +170,26 @@ static MunitTest tests[] = {
     { "/test_ipcjq_space_null", test_ipcjq_space_null, test_setup,
         test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
 
+    { "/test_ipc_jobqueue_new_sized", test_ipc_jobqueue_new_sized, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+
+    { "/test_ipc_jobqueue_batch", test_ipc_jobqueue_batch, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+
+    { "/test_ipc_jobqueue_borrow", test_ipc_jobqueue_borrow, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+
+    { "/test_ipc_jobqueue_deadline", test_ipc_jobqueue_deadline, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+
+    { "/test_ipc_jobqueue_cancel", test_ipc_jobqueue_cancel, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+
+    { "/test_ipc_jobqueue_compact", test_ipc_jobqueue_compact, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_ipc_jobqueue_compact_labels", test_ipc_jobqueue_compact_labels, 
+        NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
     { "/test_ipc_jobqueue_delete", test_ipc_jobqueue_delete, NULL, NULL,
         MUNIT_TEST_OPTION_NONE, NULL },
 
@@ -1,5 +1,7 @@
 /******** DO NOT EDIT THIS FILE ********/
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
 #include "test_job.h"
 #include "../job.h"
 
@@ -733,3 +735,414 @@ MunitResult test_job_delete(const MunitParameter params[], void* fixture) {
     return MUNIT_OK;
 }
 
+MunitResult test_job_pool(const MunitParameter params[], void* fixture) {
+    int capacity = 4;
+    job_t* jobs[6];
+    job_pool_stats_t stats;
+    job_pool_t* pool = job_pool_new(capacity);
+    assert_not_null(pool);
+
+    /* the slab serves capacity distinct jobs, then falls back to malloc */
+    for (int i = 0; i < 6; i++) {
+        jobs[i] = job_pool_get(pool);
+        assert_not_null(jobs[i]);
+        assert_true(job_pool_owns(pool, jobs[i]) == (i < capacity));
+        for (int j = 0; j < i; j++)
+            assert_ptr_not_equal(jobs[i], jobs[j]);
+    }
+
+    assert_ptr_equal(job_pool_stats(pool, &stats), &stats);
+    assert_ulong(stats.gets, ==, 6);
+    assert_ulong(stats.hits, ==, capacity);
+    assert_ulong(stats.misses, ==, 2);
+    assert_ulong(stats.puts, ==, 0);
+
+    for (int i = 0; i < 6; i++)
+        job_pool_put(pool, jobs[i]);
+
+    /* the last job put back is the next one taken */
+    job_t* job = job_pool_get(pool);
+    assert_ptr_equal(job, jobs[capacity - 1]);
+    job_pool_put(pool, job);
+
+    job_pool_stats(pool, &stats);
+    assert_ulong(stats.gets, ==, 7);
+    assert_ulong(stats.hits, ==, capacity + 1);
+    assert_ulong(stats.puts, ==, 7);
+
+    job_pool_delete(pool);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_job_pool_use(const MunitParameter params[], void* fixture) {
+    char str[JOB_STR_SIZE];
+    job_pool_stats_t stats;
+    job_pool_t* pool = job_pool_new(8);
+    assert_not_null(pool);
+
+    assert_null(job_pool_use(pool));
+
+    job_t* j1 = job_new(1, 2, 3, label_in[4]);
+    job_t* j2 = job_copy(j1, NULL);
+    job_t* j3 = str_to_job(job_to_str(j1, str), NULL);
+    
+    assert_true(job_pool_owns(pool, j1));
+    assert_true(job_pool_owns(pool, j2));
+    assert_true(job_pool_owns(pool, j3));
+    assert_true(job_is_equal(j1, j2));
+    assert_true(job_is_equal(j1, j3));
+
+    /* a failed conversion takes nothing from the pool */
+    assert_null(str_to_job("bad", NULL));
+
+    job_delete(j1);
+    job_delete(j2);
+    job_delete(j3);
+
+    job_pool_stats(pool, &stats);
+    assert_ulong(stats.gets, ==, 3);
+    assert_ulong(stats.hits, ==, 3);
+    assert_ulong(stats.puts, ==, 3);
+
+    /* deleting the selected pool reverts to malloc and free */
+    job_pool_delete(pool);
+    assert_null(job_pool_use(NULL));
+
+    job_t* job = job_new(1, 2, 3, NULL);
+    assert_not_null(job);
+    job_delete(job);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_job_pool_null(const MunitParameter params[], void* fixture) {
+    job_pool_stats_t stats;
+    job_pool_t* pool = job_pool_new(1);
+    
+    assert_null(job_pool_new(0));
+    assert_null(job_pool_new(-1));
+    assert_null(job_pool_get(NULL));
+    assert_false(job_pool_owns(NULL, pool->slab));
+    assert_false(job_pool_owns(pool, NULL));
+    assert_null(job_pool_stats(NULL, &stats));
+    assert_null(job_pool_stats(pool, NULL));
+
+    /* the following should just not cause errors */
+    job_pool_put(NULL, NULL);
+    job_pool_put(pool, NULL);
+    job_pool_delete(NULL);
+
+    job_pool_delete(pool);
+
+    return MUNIT_OK;
+}
+
+/* job_to_str against snprintf with JOB_STR_FMT, the reference */
+static void assert_to_str_as_snprintf(job_t* job) {
+    char expected[JOB_STR_SIZE];
+    char actual[JOB_STR_SIZE];
+
+    memset(expected, 'x', JOB_STR_SIZE);
+    memset(actual, 'x', JOB_STR_SIZE);
+
+    int ret = snprintf(expected, JOB_STR_SIZE, JOB_STR_FMT, job->pid, job->id,
+        job->priority, job->label);
+    char* str = job_to_str(job, actual);
+
+    if (ret < JOB_STR_SIZE)
+        assert_ptr_equal(str, actual);
+    else
+        assert_null(str);
+    assert_memory_equal(JOB_STR_SIZE, actual, expected);
+
+    str = job_to_str(job, NULL);
+    if (ret < JOB_STR_SIZE) {
+        assert_not_null(str);
+        assert_string_equal(str, expected);
+        free(str);
+    } else {
+        assert_null(str);
+    }
+}
+
+MunitResult test_job_to_str_snprintf(const MunitParameter params[], 
+    void* fixture) {
+    int pids[] = { INT_MIN, INT_MIN + 1, -10000000, -9999999, -1000000, 
+        -999999, -100000, -1, 0, 1, 999999, 1000000, 9999999, 10000000, 
+        INT_MAX };
+    unsigned int uints[] = { 0, 1, 9999, 10000, 99999, 100000, 999999, 
+        UINT_MAX - 1, UINT_MAX };
+    int npids = sizeof(pids) / sizeof(pids[0]);
+    int nuints = sizeof(uints) / sizeof(uints[0]);
+    job_t job;
+
+    /* every combination of field widths either side of overflow */
+    for (int p = 0; p < npids; p++) {
+        for (int i = 0; i < nuints; i++) {
+            for (int r = 0; r < nuints; r++) {
+                set_test_job(&job, pids[p], uints[i], uints[r], 
+                    (p + i + r) % TEST_LABELS);
+                assert_to_str_as_snprintf(&job);
+            }
+        }
+    }
+
+    for (int n = 0; n < 10000; n++) {
+        /* random magnitudes, so that every number of digits is covered */
+        int shift = munit_rand_int_range(1, 31);
+        set_test_job(&job, (int) (munit_rand_uint32() >> shift), 
+            munit_rand_uint32() >> munit_rand_int_range(0, 31),
+            munit_rand_uint32() >> munit_rand_int_range(0, 31),
+            munit_rand_int_range(0, TEST_LABELS - 1));
+        if (munit_rand_int_range(0, 1)) job.pid = -job.pid;
+        assert_to_str_as_snprintf(&job);
+    }
+
+    return MUNIT_OK;
+}
+
+/* the sscanf conversion of a job string, the reference for str_to_job */
+static job_t* sscanf_str_to_job(char* str, job_t* job) {
+    if (strnlen(str, JOB_STR_SIZE + 1) != JOB_STR_SIZE - 1) return NULL;
+    if (sscanf(str, JOB_STR_FMT, &job->pid, &job->id, &job->priority, 
+        job->label) != 4)
+        return NULL;
+    return job;
+}
+
+/* characters that are significant to the format or to sscanf */
+static const char fuzz_chars[] = "0123456789-+ \t\n,:*pidrlabex\x80\xff";
+
+MunitResult test_str_to_job_fuzz(const MunitParameter params[], 
+    void* fixture) {
+    char str[JOB_STR_SIZE + 1];
+    char canonical[JOB_STR_SIZE];
+    job_t expected;
+    job_t job;
+
+    for (int n = 0; n < 200000; n++) {
+        set_test_job(&job, munit_rand_int_range(-999999, 9999999),
+            munit_rand_int_range(0, 99999), munit_rand_int_range(0, 99999),
+            munit_rand_int_range(0, TEST_LABELS - 1));
+        assert_not_null(job_to_str(&job, str));
+        str[JOB_STR_SIZE] = '\0';
+
+        /* up to 3 mutations, mostly at the fixed positions of the fields */
+        int mutations = munit_rand_int_range(0, 3);
+        for (int m = 0; m < mutations; m++) {
+            int i = munit_rand_int_range(0, 
+                munit_rand_int_range(0, 3) ? 37 : JOB_STR_SIZE - 1);
+            int c = munit_rand_int_range(0, sizeof(fuzz_chars) - 1);
+            /* the last choice is the terminating NUL, truncating str */
+            str[i] = fuzz_chars[c];
+        }
+
+        /* 
+         * str_to_job converts str if and only if sscanf does and job_to_str
+         * gives str back, and then to the same job
+         */
+        bool is_canonical = sscanf_str_to_job(str, &expected)
+            && job_to_str(&expected, canonical) 
+            && strcmp(canonical, str) == 0;
+
+        job_t* actual = str_to_job(str, &job);
+        if (is_canonical) {
+            assert_ptr_equal(actual, &job);
+            assert_true(job_is_equal(actual, &expected));
+        } else {
+            assert_null(actual);
+        }
+    }
+
+    return MUNIT_OK;
+}
+
+MunitResult test_job_to_bin(const MunitParameter params[], void* fixture) {
+    unsigned char bin[JOB_BIN_SIZE];
+    job_t expected_job;
+    job_t job;
+
+    /* the layout is fixed, whatever the byte order of the host */
+    set_test_job(&expected_job, -2, 0x01020304, 0xa0b0c0d0, 1);
+    assert_ptr_equal(job_to_bin(&expected_job, bin), bin);
+    unsigned char header[16] = { JOB_BIN_VERSION, 0, 0, 0, 
+        0xfe, 0xff, 0xff, 0xff, 0x04, 0x03, 0x02, 0x01, 
+        0xd0, 0xc0, 0xb0, 0xa0 };
+    assert_memory_equal(16, bin, header);
+    assert_memory_equal(MAX_NAME_SIZE, bin + 16, expected_label[1]);
+
+    for (int i = 0; i < TEST_LABELS; i++) {
+        set_test_job(&expected_job, i % 2 ? -i : i * 1000003, i * 65537, 
+            i + 1, i);
+
+        assert_ptr_equal(job_to_bin(&expected_job, bin), bin);
+        assert_ptr_equal(bin_to_job(bin, &job), &job);
+        assert_true(equal_jobs(&job, &expected_job));
+
+        unsigned char* bp = job_to_bin(&expected_job, NULL);
+        assert_not_null(bp);
+        job_t* jp = bin_to_job(bp, NULL);
+        assert_not_null(jp);
+        assert_true(equal_jobs(jp, &expected_job));
+        free(bp);
+        job_delete(jp);
+    }
+
+    /* invalid label */
+    set_test_job(&job, 1, 1, 1, 0);
+    job.label[MAX_NAME_SIZE - 2] = '\0';
+    assert_null(job_to_bin(&job, bin));
+    assert_null(job_to_bin(&job, NULL));
+    assert_null(job_to_bin(NULL, bin));
+
+    return MUNIT_OK;
+}
+
+MunitResult test_bin_to_job_err(const MunitParameter params[], 
+    void* fixture) {
+    unsigned char bin[JOB_BIN_SIZE];
+    job_t job;
+
+    set_test_job(&job, 1, 2, 3, 4);
+    assert_not_null(job_to_bin(&job, bin));
+    assert_not_null(bin_to_job(bin, &job));
+
+    assert_null(bin_to_job(NULL, &job));
+
+    /* other versions */
+    bin[0] = JOB_BIN_VERSION + 1;
+    assert_null(bin_to_job(bin, &job));
+    bin[0] = 0;
+    assert_null(bin_to_job(bin, NULL));
+    bin[0] = JOB_BIN_VERSION;
+
+    for (int i = 1; i < 4; i++) {
+        bin[i] = 1;
+        assert_null(bin_to_job(bin, &job));
+        bin[i] = 0;
+    }
+
+    /* short and unterminated labels */
+    bin[16 + 5] = '\0';
+    assert_null(bin_to_job(bin, &job));
+    bin[16 + 5] = '*';
+    bin[JOB_BIN_SIZE - 1] = '*';
+    assert_null(bin_to_job(bin, &job));
+    bin[JOB_BIN_SIZE - 1] = '\0';
+
+    assert_not_null(bin_to_job(bin, &job));
+
+    return MUNIT_OK;
+}
+
+/* sizes either side of the block size of the batch functions */
+static int batch_sizes[] = { 1, 2, 3, 63, 64, 65, 127, 128, 129, 1000 };
+#define BATCH_SIZES ((int) (sizeof(batch_sizes) / sizeof(batch_sizes[0])))
+#define BATCH_MAX 1001
+
+MunitResult test_job_init_n(const MunitParameter params[], void* fixture) {
+    job_t jobs[BATCH_MAX];
+    job_t expected_job;
+
+    job_init(&expected_job);
+
+    for (int s = 0; s < BATCH_SIZES; s++) {
+        int n = batch_sizes[s];
+        set_test_job(&jobs[n], 7, 7, 7, 3);
+        for (int i = 0; i < n; i++)
+            set_test_job(&jobs[i], i + 1, i, i, i % TEST_LABELS);
+
+        job_init_n(jobs, n);
+
+        for (int i = 0; i < n; i++)
+            assert_true(equal_jobs(&jobs[i], &expected_job));
+        /* no job after the n jobs is touched */
+        assert_int(jobs[n].pid, ==, 7);
+    }
+
+    job_init_n(NULL, 1);
+    job_init_n(jobs, 0);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_job_set_n(const MunitParameter params[], void* fixture) {
+    job_t jobs[BATCH_MAX];
+    job_t expected_job;
+
+    for (int s = 0; s < BATCH_SIZES; s++) {
+        int n = batch_sizes[s];
+        int label = s % TEST_LABELS;
+        job_init(&jobs[n]);
+
+        assert_ptr_equal(job_set_n(jobs, n, 42, 100, 3, label_in[label]),
+            jobs);
+
+        for (int i = 0; i < n; i++) {
+            job_set(&expected_job, 42, 100 + i, 3, label_in[label]);
+            assert_true(equal_jobs(&jobs[i], &expected_job));
+        }
+        assert_int(jobs[n].pid, ==, 0);
+    }
+
+    assert_null(job_set_n(NULL, 1, 1, 1, 1, NULL));
+    assert_null(job_set_n(jobs, 0, 1, 1, 1, NULL));
+
+    return MUNIT_OK;
+}
+
+MunitResult test_job_equal_n(const MunitParameter params[], void* fixture) {
+    job_t jobs1[BATCH_MAX];
+    job_t jobs2[BATCH_MAX];
+
+    for (int s = 0; s < BATCH_SIZES; s++) {
+        int n = batch_sizes[s];
+        for (int i = 0; i < n; i++) {
+            set_test_job(&jobs1[i], i + 1, i, i % 5, i % TEST_LABELS);
+            jobs2[i] = jobs1[i];
+        }
+
+        assert_int(job_equal_n(jobs1, jobs2, n), ==, n);
+        assert_int(job_equal_n(jobs1, jobs1, n), ==, n);
+
+        /* each field of a job at either end and in the middle */
+        int at[] = { 0, n / 2, n - 1 };
+        for (int a = 0; a < 3; a++) {
+            job_t* job = &jobs2[at[a]];
+            job->pid++;
+            assert_int(job_equal_n(jobs1, jobs2, n), ==, at[a]);
+            job->pid--;
+            job->id++;
+            assert_int(job_equal_n(jobs1, jobs2, n), ==, at[a]);
+            job->id--;
+            job->priority++;
+            assert_int(job_equal_n(jobs1, jobs2, n), ==, at[a]);
+            job->priority--;
+            job->label[MAX_NAME_SIZE - 2]++;
+            assert_int(job_equal_n(jobs1, jobs2, n), ==, at[a]);
+            job->label[MAX_NAME_SIZE - 2]--;
+        }
+
+        /* the first of several mismatches */
+        jobs2[n - 1].id++;
+        assert_int(job_equal_n(jobs1, jobs2, n), ==, n - 1);
+        jobs2[n / 2].id++;
+        assert_int(job_equal_n(jobs1, jobs2, n), ==, n / 2);
+        jobs2[n / 2].id--;
+        jobs2[n - 1].id--;
+
+        /* bytes after the end of labels are not compared, as by strncmp */
+        jobs1[n / 2].label[3] = jobs2[n / 2].label[3] = '\0';
+        jobs2[n / 2].label[4] = '?';
+        assert_int(job_equal_n(jobs1, jobs2, n), ==, n);
+        assert_true(job_is_equal(&jobs1[n / 2], &jobs2[n / 2]));
+    }
+
+    assert_int(job_equal_n(jobs1, jobs2, 0), ==, 0);
+    assert_int(job_equal_n(NULL, jobs2, 3), ==, 0);
+    assert_int(job_equal_n(jobs1, NULL, 3), ==, 0);
+    assert_int(job_equal_n(NULL, NULL, 3), ==, 3);
+
+    return MUNIT_OK;
+}
@@ -43,6 +43,8 @@ MunitResult test_job_to_str_err_stack(const MunitParameter params[],
 MunitResult test_job_to_str_err_heap(const MunitParameter params[], 
     void* fixture);
 MunitResult test_job_to_str_null(const MunitParameter params[], void* fixture);
+MunitResult test_job_to_str_snprintf(const MunitParameter params[], 
+    void* fixture);
 
 MunitResult test_str_to_job_stack(const MunitParameter params[], void* fixture);
 MunitResult test_str_to_job_heap(const MunitParameter params[], void* fixture);
@@ -51,9 +53,19 @@ MunitResult test_str_to_job_err_stack(const MunitParameter params[],
 MunitResult test_str_to_job_err_heap(const MunitParameter params[], 
     void* fixture);
 MunitResult test_str_to_job_null(const MunitParameter params[], void* fixture);
+MunitResult test_str_to_job_fuzz(const MunitParameter params[], void* fixture);
+MunitResult test_job_to_bin(const MunitParameter params[], void* fixture);
+MunitResult test_bin_to_job_err(const MunitParameter params[], void* fixture);
+MunitResult test_job_init_n(const MunitParameter params[], void* fixture);
+MunitResult test_job_set_n(const MunitParameter params[], void* fixture);
+MunitResult test_job_equal_n(const MunitParameter params[], void* fixture);
 
 MunitResult test_job_delete(const MunitParameter params[], void* fixture);
 
+MunitResult test_job_pool(const MunitParameter params[], void* fixture);
+MunitResult test_job_pool_use(const MunitParameter params[], void* fixture);
+MunitResult test_job_pool_null(const MunitParameter params[], void* fixture);
+
 static MunitTest tests[] = {
 /* exclude following tests from marking */
 #ifndef _CSC2035_MARKING
@@ -107,6 +119,8 @@ static MunitTest tests[] = {
         MUNIT_TEST_OPTION_NONE, NULL },
     { "/test_job_to_str_null", test_job_to_str_null, NULL, NULL,
         MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_job_to_str_snprintf", test_job_to_str_snprintf, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
 
     { "/test_str_to_job_stack", test_str_to_job_stack, NULL, NULL,
         MUNIT_TEST_OPTION_NONE, NULL },
@@ -118,9 +132,28 @@ static MunitTest tests[] = {
         MUNIT_TEST_OPTION_NONE, NULL },
     { "/test_str_to_job_null", test_str_to_job_null, NULL, NULL,
         MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_str_to_job_fuzz", test_str_to_job_fuzz, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_job_to_bin", test_job_to_bin, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_bin_to_job_err", test_bin_to_job_err, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_job_init_n", test_job_init_n, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_job_set_n", test_job_set_n, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_job_equal_n", test_job_equal_n, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
 
     { "/test_job_delete", test_job_delete, NULL, NULL,
         MUNIT_TEST_OPTION_NONE, NULL },
+
+    { "/test_job_pool", test_job_pool, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_job_pool_use", test_job_pool_use, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_job_pool_null", test_job_pool_null, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
         
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
 };
@@ -1,6 +1,9 @@
 /******** DO NOT EDIT THIS FILE ********/
 #include <stdio.h>
 #include <errno.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <pthread.h>
 #include "test_joblog.h"
 #include "procs4tests.h"
 #include "../joblog.h"
@@ -70,8 +73,12 @@ void test_tear_down(void* fixture) {
     int* preserve_logs = (int*) fixture;
     
     if (!*preserve_logs) {
-        for (int i = 0; i < LOG_FILES; i++)
+        for (int i = 0; i < LOG_FILES; i++) {
+            proc_t* proc = new_test_proc(i);
+            joblog_delete(proc);
+            proc_delete(proc);
             unlink(log_fname[i]);
+        }
     }
     
     errno = 0;
@@ -302,6 +309,41 @@ MunitResult test_joblog_write_null(const MunitParameter params[],
     return MUNIT_OK;
 }
 
+MunitResult test_joblog_write_compact(const MunitParameter params[], 
+    void* fixture) {
+    proc_t* proc = new_test_proc(1);
+    label_table_t* lt = label_table_new(2);
+    compact_job_t cj;
+    job_t j;
+    job_t r;
+
+    job_set(&j, 7, 3, 2, job_label[1]);
+    assert_not_null(label_table_compact(lt, &j, &cj));
+
+    errno = 0;
+    joblog_write_compact(proc, lt, &cj);
+    assert_int(errno, ==, 0);
+
+    /* the entry is the expanded job, as joblog_write would write it */
+    assert_int(joblog_count(proc), ==, 1);
+    assert_not_null(joblog_read(proc, 0, &r));
+    assert_true(job_is_equal(&r, &j));
+
+    /* nothing is written for a missing table, job or label */
+    joblog_write_compact(NULL, lt, &cj);
+    joblog_write_compact(proc, NULL, &cj);
+    joblog_write_compact(proc, lt, NULL);
+    cj.label = 1;
+    joblog_write_compact(proc, lt, &cj);
+    assert_int(errno, ==, 0);
+    assert_int(joblog_count(proc), ==, 1);
+
+    label_table_delete(lt);
+    proc_delete(proc);
+
+    return MUNIT_OK;
+}
+
 MunitResult test_joblog_read_cpid0(const MunitParameter params[],
     void* fixture) {
     return test_cpid_joblog_read(0, true, false, true);
@@ -427,3 +469,1222 @@ MunitResult test_joblog_delete(const MunitParameter params[],
     return MUNIT_OK;
 }
 
+
+/* the number of whole entries in the log file of cp_id */
+static int logged_entries(pid_t cp_id) {
+    struct stat sb;
+    if (stat(log_fname[cp_id], &sb) != 0) return 0;
+    return sb.st_size / JOB_STR_SIZE;
+}
+
+static void set_entry_job(job_t* job, int i) {
+    job_set(job, i + 1, i, i % 5 + 1, job_label[i % TEST_ENTRY_NUM]);
+}
+
+MunitResult test_joblog_buffer(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(0);
+    job_t job;
+    job_t rjob;
+
+    assert_int(joblog_set_buffer(proc, 64 * JOB_STR_SIZE), ==, 0);
+
+    for (int i = 0; i < TEST_ENTRY_NUM; i++) {
+        set_entry_job(&job, i);
+        joblog_write(proc, &job);
+    }
+    assert_int(logged_entries(0), ==, 0);
+
+    assert_int(joblog_flush(proc), ==, 0);
+    assert_int(logged_entries(0), ==, TEST_ENTRY_NUM);
+
+    /* a read sees the entries still in the buffer */
+    set_entry_job(&job, TEST_ENTRY_NUM);
+    joblog_write(proc, &job);
+    assert_int(logged_entries(0), ==, TEST_ENTRY_NUM);
+    assert_not_null(joblog_read(proc, TEST_ENTRY_NUM, &rjob));
+    assert_true(job_is_equal(&rjob, &job));
+
+    for (int i = 0; i < TEST_ENTRY_NUM; i++) {
+        set_entry_job(&job, i);
+        assert_not_null(joblog_read(proc, i, &rjob));
+        assert_true(job_is_equal(&rjob, &job));
+    }
+
+    /* closing flushes, and writes are unbuffered again after a close */
+    joblog_write(proc, &job);
+    assert_int(joblog_close(proc), ==, 0);
+    assert_int(logged_entries(0), ==, TEST_ENTRY_NUM + 2);
+    joblog_write(proc, &job);
+    assert_int(logged_entries(0), ==, TEST_ENTRY_NUM + 3);
+
+    /* delete discards buffered entries with the log */
+    assert_int(joblog_set_buffer(proc, 64 * JOB_STR_SIZE), ==, 0);
+    joblog_write(proc, &job);
+    joblog_delete(proc);
+    assert_int(access(log_fname[0], F_OK), ==, -1);
+    assert_int(joblog_flush(proc), ==, 0);
+    assert_int(access(log_fname[0], F_OK), ==, -1);
+
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_buffer_threshold(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(1);
+    job_t job;
+
+    /* 3 entries are written at a time */
+    assert_int(joblog_set_buffer(proc, 3 * JOB_STR_SIZE), ==, 0);
+
+    for (int i = 0; i < 10; i++) {
+        set_entry_job(&job, i);
+        joblog_write(proc, &job);
+        assert_int(logged_entries(1), ==, (i + 1) / 3 * 3);
+    }
+
+    /* turning the buffer off flushes it */
+    assert_int(joblog_set_buffer(proc, 0), ==, 0);
+    assert_int(logged_entries(1), ==, 10);
+    joblog_write(proc, &job);
+    assert_int(logged_entries(1), ==, 11);
+
+    /* a buffer smaller than an entry holds one entry */
+    assert_int(joblog_set_buffer(proc, 1), ==, 0);
+    joblog_write(proc, &job);
+    assert_int(logged_entries(1), ==, 12);
+
+    proc_delete(proc);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_buffer_exit(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(2);
+    job_t job;
+    job_t rjob;
+
+    assert_int(joblog_set_buffer(proc, 64 * JOB_STR_SIZE), ==, 0);
+    set_entry_job(&job, 0);
+    joblog_write(proc, &job);
+
+    pid_t child = fork();
+    assert_int(child, >=, 0);
+
+    if (child == 0) {
+        /* 
+         * the child buffers its own entries, which are written when it 
+         * exits, but not the buffered entry of its parent
+         */
+        joblog_set_buffer(proc, 64 * JOB_STR_SIZE);
+        for (int i = 1; i < TEST_ENTRY_NUM; i++) {
+            set_entry_job(&job, i);
+            joblog_write(proc, &job);
+        }
+        exit(logged_entries(2) == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    int status;
+    waitpid(child, &status, 0);
+    assert_true(WIFEXITED(status));
+    assert_int(WEXITSTATUS(status), ==, EXIT_SUCCESS);
+    assert_int(logged_entries(2), ==, TEST_ENTRY_NUM - 1);
+
+    set_entry_job(&job, 1);
+    assert_not_null(joblog_read(proc, 0, &rjob));
+    assert_true(job_is_equal(&rjob, &job));
+
+    /* the parent's entry is written when it reads the log */
+    set_entry_job(&job, 0);
+    assert_not_null(joblog_read(proc, TEST_ENTRY_NUM - 1, &rjob));
+    assert_true(job_is_equal(&rjob, &job));
+
+    proc_delete(proc);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_buffer_null(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(3);
+
+    errno = 0;
+    assert_int(joblog_set_buffer(NULL, 64), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_flush(NULL), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_close(NULL), ==, -1);
+    assert_int(errno, ==, EINVAL);
+
+    /* nothing to flush or close for a log that is not open */
+    assert_int(joblog_flush(proc), ==, 0);
+    assert_int(joblog_close(proc), ==, 0);
+    assert_int(access(log_fname[3], F_OK), ==, -1);
+
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_count(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(0);
+    job_t job;
+
+    errno = 0;
+    assert_int(joblog_count(NULL), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_count(proc), ==, -1);
+    assert_int(errno, ==, ENOENT);
+
+    for (int i = 0; i < TEST_ENTRY_NUM; i++) {
+        set_entry_job(&job, i);
+        joblog_write(proc, &job);
+        assert_int(joblog_count(proc), ==, i + 1);
+    }
+
+    /* buffered entries are counted */
+    assert_int(joblog_set_buffer(proc, 64 * JOB_STR_SIZE), ==, 0);
+    joblog_write(proc, &job);
+    assert_int(joblog_count(proc), ==, TEST_ENTRY_NUM + 1);
+
+    /* by another process that does not have the log open */
+    assert_int(joblog_close(proc), ==, 0);
+    assert_int(joblog_count(proc), ==, TEST_ENTRY_NUM + 1);
+
+    /* a partial entry at the end is not counted */
+    FILE* lf = fopen(log_fname[0], "a");
+    fprintf(lf, "pid:00");
+    fclose(lf);
+    assert_int(joblog_count(proc), ==, TEST_ENTRY_NUM + 1);
+    assert_null(joblog_read(proc, TEST_ENTRY_NUM + 1, &job));
+
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_read_malformed(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(0);
+    job_t job;
+    job_t rjob;
+
+    for (int i = 0; i < TEST_ENTRY_NUM; i++) {
+        set_entry_job(&job, i);
+        joblog_write(proc, &job);
+    }
+    assert_int(joblog_close(proc), ==, 0);
+
+    /* corrupt the separator of entry 3 and the new line of entry 5 */
+    FILE* lf = fopen(log_fname[0], "r+");
+    fseek(lf, 3 * JOB_STR_SIZE + 11, SEEK_SET);
+    fputc(';', lf);
+    fseek(lf, 6 * JOB_STR_SIZE - 1, SEEK_SET);
+    fputc('x', lf);
+    fclose(lf);
+
+    int init_errno = errno;
+    for (int i = 0; i < TEST_ENTRY_NUM; i++) {
+        job_t* jptr = joblog_read(proc, i, &rjob);
+        if (i == 3 || i == 5) {
+            assert_null(jptr);
+        } else {
+            set_entry_job(&job, i);
+            assert_ptr_equal(jptr, &rjob);
+            assert_true(job_is_equal(&rjob, &job));
+        }
+        assert_int(errno, ==, init_errno);
+    }
+
+    proc_delete(proc);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_cursor(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(0);
+    joblog_cursor_t cur;
+    job_t job;
+    job_t rjob;
+
+    errno = 0;
+    assert_int(joblog_cursor_open(NULL, &cur), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_cursor_open(proc, NULL), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_cursor_open(proc, &cur), ==, -1);
+    assert_int(errno, ==, ENOENT);
+    assert_null(joblog_cursor_next(NULL, &job));
+    assert_null(joblog_cursor_next_str(NULL));
+    assert_int(joblog_cursor_count(NULL), ==, 0);
+    joblog_cursor_close(NULL);
+
+    /* an empty log has no entries */
+    FILE* lf = fopen(log_fname[0], "w");
+    fclose(lf);
+    assert_int(joblog_cursor_open(proc, &cur), ==, 0);
+    assert_int(joblog_cursor_count(&cur), ==, 0);
+    assert_null(joblog_cursor_next(&cur, &rjob));
+    joblog_cursor_close(&cur);
+
+    /* the cursor sees entries still in the buffer */
+    assert_int(joblog_set_buffer(proc, 64 * JOB_STR_SIZE), ==, 0);
+    for (int i = 0; i < TEST_ENTRY_NUM; i++) {
+        set_entry_job(&job, i);
+        joblog_write(proc, &job);
+    }
+    assert_int(joblog_cursor_open(proc, &cur), ==, 0);
+    assert_int(joblog_cursor_count(&cur), ==, TEST_ENTRY_NUM);
+
+    /* and not entries written after it was opened */
+    joblog_write(proc, &job);
+    assert_int(joblog_flush(proc), ==, 0);
+
+    for (int i = 0; i < TEST_ENTRY_NUM; i++) {
+        set_entry_job(&job, i);
+        assert_ptr_equal(joblog_cursor_next(&cur, &rjob), &rjob);
+        assert_true(job_is_equal(&rjob, &job));
+        assert_int(joblog_cursor_count(&cur), ==, TEST_ENTRY_NUM - i - 1);
+    }
+    assert_null(joblog_cursor_next(&cur, &rjob));
+    assert_null(joblog_cursor_next_str(&cur));
+    assert_int(cur.skipped, ==, 0);
+    joblog_cursor_close(&cur);
+
+    /* entry text points into the log, and jobs can be allocated */
+    char str[JOB_STR_SIZE];
+    assert_int(joblog_cursor_open(proc, &cur), ==, 0);
+    assert_int(joblog_cursor_count(&cur), ==, TEST_ENTRY_NUM + 1);
+    for (int i = 0; i < TEST_ENTRY_NUM; i += 2) {
+        set_entry_job(&job, i);
+        const char* entry = joblog_cursor_next_str(&cur);
+        assert_not_null(entry);
+        assert_memory_equal(JOB_STR_SIZE - 1, entry, job_to_str(&job, str));
+        assert_char(entry[JOB_STR_SIZE - 1], ==, '\n');
+
+        if (i + 1 < TEST_ENTRY_NUM) {
+            set_entry_job(&job, i + 1);
+            job_t* jptr = joblog_cursor_next(&cur, NULL);
+            assert_not_null(jptr);
+            assert_true(job_is_equal(jptr, &job));
+            job_delete(jptr);
+        }
+    }
+    joblog_cursor_close(&cur);
+    assert_int(joblog_cursor_count(&cur), ==, 0);
+
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+#define SCAN_THREADS 4
+#define SCAN_ENTRIES 1000
+
+typedef struct {
+    joblog_cursor_t range;
+    int first;
+    int scanned;
+    bool in_order;
+} scan_t;
+
+static void* scan_range(void* arg) {
+    scan_t* scan = (scan_t*) arg;
+    job_t job;
+    job_t rjob;
+
+    scan->scanned = 0;
+    scan->in_order = true;
+    while (joblog_cursor_next(&scan->range, &rjob)) {
+        set_entry_job(&job, scan->first + scan->scanned++);
+        scan->in_order = scan->in_order && job_is_equal(&rjob, &job);
+    }
+
+    return NULL;
+}
+
+MunitResult test_joblog_cursor_range(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(1);
+    joblog_cursor_t cur;
+    joblog_cursor_t range;
+    job_t job;
+    job_t rjob;
+
+    assert_int(joblog_set_buffer(proc, 64 * JOB_STR_SIZE), ==, 0);
+    for (int i = 0; i < SCAN_ENTRIES; i++) {
+        set_entry_job(&job, i);
+        joblog_write(proc, &job);
+    }
+    assert_int(joblog_cursor_open(proc, &cur), ==, 0);
+    assert_int(joblog_cursor_count(&cur), ==, SCAN_ENTRIES);
+
+    assert_null(joblog_cursor_range(NULL, 0, 1, &range));
+    assert_null(joblog_cursor_range(&cur, 0, 1, NULL));
+    assert_null(joblog_cursor_range(&cur, -1, 1, &range));
+    assert_null(joblog_cursor_range(&cur, 0, -1, &range));
+
+    /* ranges are limited to the entries of the cursor */
+    assert_ptr_equal(joblog_cursor_range(&cur, 10, 5, &range), &range);
+    assert_int(joblog_cursor_count(&range), ==, 5);
+    assert_int(joblog_cursor_entry(&range), ==, 10);
+    set_entry_job(&job, 10);
+    assert_not_null(joblog_cursor_next(&range, &rjob));
+    assert_true(job_is_equal(&rjob, &job));
+    assert_int(joblog_cursor_entry(&range), ==, 11);
+    joblog_cursor_close(&range);
+
+    joblog_cursor_range(&cur, SCAN_ENTRIES - 2, 5, &range);
+    assert_int(joblog_cursor_count(&range), ==, 2);
+    joblog_cursor_close(&range);
+    joblog_cursor_range(&cur, SCAN_ENTRIES + 1, 5, &range);
+    assert_int(joblog_cursor_count(&range), ==, 0);
+    assert_int(joblog_cursor_entry(&range), ==, -1);
+    assert_null(joblog_cursor_next(&range, &rjob));
+    joblog_cursor_close(&range);
+
+    /* and relative to its position */
+    assert_int(joblog_cursor_entry(NULL), ==, -1);
+    assert_int(joblog_cursor_entry(&cur), ==, 0);
+    assert_not_null(joblog_cursor_next(&cur, &rjob));
+    joblog_cursor_range(&cur, 0, SCAN_ENTRIES, &range);
+    assert_int(joblog_cursor_count(&range), ==, SCAN_ENTRIES - 1);
+    assert_int(joblog_cursor_entry(&range), ==, 1);
+    set_entry_job(&job, 1);
+    assert_not_null(joblog_cursor_next(&range, &rjob));
+    assert_true(job_is_equal(&rjob, &job));
+    joblog_cursor_close(&range);
+
+    /* threads scan disjoint ranges of the log in parallel */
+    int n = joblog_cursor_count(&cur);
+    pthread_t threads[SCAN_THREADS];
+    scan_t scans[SCAN_THREADS];
+
+    for (int t = 0; t < SCAN_THREADS; t++) {
+        int first = t * n / SCAN_THREADS;
+        int count = (t + 1) * n / SCAN_THREADS - first;
+        joblog_cursor_range(&cur, first, count, &scans[t].range);
+        scans[t].first = first + 1;
+        assert_int(pthread_create(&threads[t], NULL, scan_range, &scans[t]),
+            ==, 0);
+    }
+
+    int scanned = 0;
+    for (int t = 0; t < SCAN_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        joblog_cursor_close(&scans[t].range);
+        assert_true(scans[t].in_order);
+        scanned += scans[t].scanned;
+    }
+    assert_int(scanned, ==, SCAN_ENTRIES - 1);
+
+    joblog_cursor_close(&cur);
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_cursor_malformed(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(2);
+    joblog_cursor_t cur;
+    job_t job;
+    job_t rjob;
+
+    for (int i = 0; i < TEST_ENTRY_NUM; i++) {
+        set_entry_job(&job, i);
+        joblog_write(proc, &job);
+    }
+    assert_int(joblog_close(proc), ==, 0);
+
+    /* 
+     * corrupt the separator of entry 3 and the new line of entry 5, and
+     * add a partial entry
+     */
+    FILE* lf = fopen(log_fname[2], "r+");
+    fseek(lf, 3 * JOB_STR_SIZE + 11, SEEK_SET);
+    fputc(';', lf);
+    fseek(lf, 6 * JOB_STR_SIZE - 1, SEEK_SET);
+    fputc('x', lf);
+    fseek(lf, 0, SEEK_END);
+    fprintf(lf, "pid:00");
+    fclose(lf);
+
+    assert_int(joblog_cursor_open(proc, &cur), ==, 0);
+    assert_int(joblog_cursor_count(&cur), ==, TEST_ENTRY_NUM);
+
+    for (int i = 0; i < TEST_ENTRY_NUM; i++) {
+        if (i == 3 || i == 5) continue;
+        set_entry_job(&job, i);
+        assert_ptr_equal(joblog_cursor_next(&cur, &rjob), &rjob);
+        assert_true(job_is_equal(&rjob, &job));
+    }
+    assert_null(joblog_cursor_next(&cur, &rjob));
+    assert_int(cur.skipped, ==, 2);
+    joblog_cursor_close(&cur);
+
+    /* malformed entries are also skipped when jobs are allocated */
+    assert_int(joblog_cursor_open(proc, &cur), ==, 0);
+    int allocated = 0;
+    job_t* jptr;
+    while ((jptr = joblog_cursor_next(&cur, NULL))) {
+        job_delete(jptr);
+        allocated++;
+    }
+    assert_int(allocated, ==, TEST_ENTRY_NUM - 2);
+    assert_int(cur.skipped, ==, 2);
+    joblog_cursor_close(&cur);
+
+    proc_delete(proc);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_async(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(0);
+    job_t job;
+    job_t rjob;
+
+    /* a small ring, so that the writer falls behind and the logger waits */
+    assert_int(joblog_set_async(proc, 3, 1000, JOBLOG_FULL_BLOCK), ==, 0);
+    for (int i = 0; i < SCAN_ENTRIES; i++) {
+        set_entry_job(&job, i);
+        joblog_write(proc, &job);
+    }
+    assert_int(joblog_count(proc), ==, SCAN_ENTRIES);
+    assert_int(joblog_dropped(proc), ==, 0);
+
+    for (int i = 0; i < SCAN_ENTRIES; i++) {
+        set_entry_job(&job, i);
+        assert_not_null(joblog_read(proc, i, &rjob));
+        assert_true(job_is_equal(&rjob, &job));
+    }
+
+    /* the writer writes a job within the interval without a flush */
+    assert_int(joblog_set_async(proc, 1024, 10, JOBLOG_FULL_BLOCK), ==, 0);
+    joblog_write(proc, &job);
+    for (int i = 0; i < 100 && logged_entries(0) == SCAN_ENTRIES; i++)
+        usleep(10000);
+    assert_int(logged_entries(0), ==, SCAN_ENTRIES + 1);
+
+    /* closing writes the ring, and writes are synchronous after a close */
+    assert_int(joblog_set_async(proc, 1024, 1000, JOBLOG_FULL_BLOCK), ==, 0);
+    joblog_write(proc, &job);
+    assert_int(joblog_close(proc), ==, 0);
+    assert_int(logged_entries(0), ==, SCAN_ENTRIES + 2);
+    joblog_write(proc, &job);
+    assert_int(logged_entries(0), ==, SCAN_ENTRIES + 3);
+
+    /* and after the ring is turned off or replaced by a buffer */
+    assert_int(joblog_set_async(proc, 1024, 1000, JOBLOG_FULL_BLOCK), ==, 0);
+    joblog_write(proc, &job);
+    assert_int(joblog_set_async(proc, 0, 0, JOBLOG_FULL_BLOCK), ==, 0);
+    assert_int(logged_entries(0), ==, SCAN_ENTRIES + 4);
+    joblog_write(proc, &job);
+    assert_int(logged_entries(0), ==, SCAN_ENTRIES + 5);
+
+    assert_int(joblog_set_async(proc, 1024, 1000, JOBLOG_FULL_BLOCK), ==, 0);
+    joblog_write(proc, &job);
+    assert_int(joblog_set_buffer(proc, 0), ==, 0);
+    assert_int(logged_entries(0), ==, SCAN_ENTRIES + 6);
+
+    /* delete discards the jobs in the ring with the log */
+    assert_int(joblog_set_async(proc, 1024, 1000, JOBLOG_FULL_BLOCK), ==, 0);
+    joblog_write(proc, &job);
+    joblog_delete(proc);
+    assert_int(joblog_flush(proc), ==, 0);
+    assert_int(access(log_fname[0], F_OK), ==, -1);
+
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_async_drop(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(1);
+    job_t job;
+    job_t rjob;
+
+    assert_int(joblog_set_async(proc, 2, 1000, JOBLOG_FULL_DROP), ==, 0);
+    for (int i = 0; i < SCAN_ENTRIES; i++) {
+        set_entry_job(&job, i);
+        joblog_write(proc, &job);
+    }
+
+    /* every job is either logged, in order, or dropped */
+    int n = joblog_count(proc);
+    long dropped = joblog_dropped(proc);
+    assert_int(n + dropped, ==, SCAN_ENTRIES);
+    assert_int(n, >=, 2);
+
+    unsigned int last_id = 0;
+    for (int i = 0; i < n; i++) {
+        assert_not_null(joblog_read(proc, i, &rjob));
+        if (i > 0) assert_uint(rjob.id, >, last_id);
+        set_entry_job(&job, rjob.id);
+        assert_true(job_is_equal(&rjob, &job));
+        last_id = rjob.id;
+    }
+
+    assert_int(joblog_close(proc), ==, 0);
+    assert_int(joblog_dropped(proc), ==, 0);
+
+    proc_delete(proc);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_async_exit(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(2);
+    job_t job;
+    job_t rjob;
+
+    assert_int(joblog_set_async(proc, 1024, 1000, JOBLOG_FULL_BLOCK), ==, 0);
+    set_entry_job(&job, 0);
+    joblog_write(proc, &job);
+
+    pid_t child = fork();
+    assert_int(child, >=, 0);
+
+    if (child == 0) {
+        /* 
+         * the child has its own writer, which writes its ring when it 
+         * exits, but not the ring of its parent
+         */
+        joblog_set_async(proc, 1024, 1000, JOBLOG_FULL_BLOCK);
+        for (int i = 1; i < TEST_ENTRY_NUM; i++) {
+            set_entry_job(&job, i);
+            joblog_write(proc, &job);
+        }
+        exit(EXIT_SUCCESS);
+    }
+
+    int status;
+    waitpid(child, &status, 0);
+    assert_true(WIFEXITED(status));
+    assert_int(WEXITSTATUS(status), ==, EXIT_SUCCESS);
+
+    /* each job is logged once, by the process that wrote it */
+    int logged[TEST_ENTRY_NUM] = { 0 };
+    assert_int(joblog_count(proc), ==, TEST_ENTRY_NUM);
+    for (int i = 0; i < TEST_ENTRY_NUM; i++) {
+        assert_not_null(joblog_read(proc, i, &rjob));
+        assert_uint(rjob.id, <, TEST_ENTRY_NUM);
+        logged[rjob.id]++;
+    }
+    for (int i = 0; i < TEST_ENTRY_NUM; i++)
+        assert_int(logged[i], ==, 1);
+
+    proc_delete(proc);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_async_null(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(3);
+
+    errno = 0;
+    assert_int(joblog_set_async(NULL, 16, 10, JOBLOG_FULL_BLOCK), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_set_async(proc, -1, 10, JOBLOG_FULL_BLOCK), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_set_async(proc, 16, 0, JOBLOG_FULL_BLOCK), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_set_async(proc, 16, 10, (joblog_full_t) 7), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_dropped(NULL), ==, -1);
+    assert_int(errno, ==, EINVAL);
+
+    assert_int(joblog_dropped(proc), ==, 0);
+    assert_int(access(log_fname[3], F_OK), ==, -1);
+
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_sync(const MunitParameter params[],
+    void* fixture) {
+    joblog_sync_t syncs[] = { JOBLOG_SYNC_NONE, JOBLOG_SYNC_INTERVAL, 
+        JOBLOG_SYNC_RECORDS, JOBLOG_SYNC_EVERY };
+    job_t job;
+    job_t rjob;
+
+    /* every mode logs the same entries, synchronously and asynchronously */
+    for (int m = 0; m < 4; m++) {
+        proc_t* proc = new_test_proc(m);
+        int n = 0;
+
+        assert_int(joblog_set_sync(proc, syncs[m], 3), ==, 0);
+        for (int i = 0; i < TEST_ENTRY_NUM; i++, n++) {
+            set_entry_job(&job, n);
+            joblog_write(proc, &job);
+            assert_int(logged_entries(m), ==, n + 1);
+        }
+
+        /* a synced entry is in the file before joblog_write returns */
+        assert_int(joblog_set_buffer(proc, 64 * JOB_STR_SIZE), ==, 0);
+        for (int i = 0; i < TEST_ENTRY_NUM; i++, n++) {
+            set_entry_job(&job, n);
+            joblog_write(proc, &job);
+        }
+        assert_int(logged_entries(m), ==, 
+            syncs[m] == JOBLOG_SYNC_EVERY ? n : TEST_ENTRY_NUM);
+        assert_int(joblog_flush(proc), ==, 0);
+
+        assert_int(joblog_set_async(proc, 4, 1, JOBLOG_FULL_BLOCK), ==, 0);
+        for (int i = 0; i < TEST_ENTRY_NUM; i++, n++) {
+            set_entry_job(&job, n);
+            joblog_write(proc, &job);
+        }
+        assert_int(joblog_flush(proc), ==, 0);
+        assert_int(logged_entries(m), ==, n);
+
+        for (int i = 0; i < n; i++) {
+            set_entry_job(&job, i);
+            assert_not_null(joblog_read(proc, i, &rjob));
+            assert_true(job_is_equal(&rjob, &job));
+        }
+
+        assert_int(joblog_close(proc), ==, 0);
+        proc_delete(proc);
+    }
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_sync_null(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(3);
+
+    errno = 0;
+    assert_int(joblog_set_sync(NULL, JOBLOG_SYNC_EVERY, 0), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_set_sync(proc, (joblog_sync_t) 7, 1), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_set_sync(proc, JOBLOG_SYNC_INTERVAL, 0), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_set_sync(proc, JOBLOG_SYNC_RECORDS, -1), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    assert_int(access(log_fname[3], F_OK), ==, -1);
+
+    /* n is only used by the interval and records modes */
+    assert_int(joblog_set_sync(proc, JOBLOG_SYNC_EVERY, 0), ==, 0);
+    assert_int(joblog_set_sync(proc, JOBLOG_SYNC_NONE, -1), ==, 0);
+
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+#define SYNC_INTERVAL_MS 200
+
+MunitResult test_joblog_sync_interval(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(1);
+    job_t job;
+
+    assert_int(joblog_set_async(proc, 16, 5, JOBLOG_FULL_BLOCK), ==, 0);
+    assert_int(joblog_set_sync(proc, JOBLOG_SYNC_INTERVAL, SYNC_INTERVAL_MS),
+        ==, 0);
+
+    /* the writer writes the entry at once, but it is not due to be synced */
+    set_entry_job(&job, 0);
+    joblog_write(proc, &job);
+    for (int i = 0; i < 1000 && logged_entries(1) < 1; i++)
+        usleep(1000);
+    assert_int(logged_entries(1), ==, 1);
+    assert_int(joblog_unsynced(proc), ==, 1);
+
+    /* with nothing more written, the writer syncs it once the interval ends */
+    usleep(2 * SYNC_INTERVAL_MS * 1000);
+    for (int i = 0; i < 100 && joblog_unsynced(proc) > 0; i++)
+        usleep(10000);
+    assert_int(joblog_unsynced(proc), ==, 0);
+
+    /* a synchronous log is synced when it is next written or flushed */
+    assert_int(joblog_set_async(proc, 0, 0, JOBLOG_FULL_BLOCK), ==, 0);
+    assert_int(joblog_set_sync(proc, JOBLOG_SYNC_INTERVAL, SYNC_INTERVAL_MS),
+        ==, 0);
+    set_entry_job(&job, 1);
+    joblog_write(proc, &job);
+    assert_int(joblog_unsynced(proc), ==, 1);
+    assert_int(joblog_flush(proc), ==, 0);
+    assert_int(joblog_unsynced(proc), ==, 0);
+    assert_int(logged_entries(1), ==, 2);
+
+    assert_int(joblog_close(proc), ==, 0);
+    assert_int(joblog_unsynced(proc), ==, 0);
+
+    errno = 0;
+    assert_int(joblog_unsynced(NULL), ==, -1);
+    assert_int(errno, ==, EINVAL);
+
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+#define SEGMENT_ENTRIES 4
+
+/* the number of files of segments of the log of cp_id that exist */
+static int segment_files(pid_t cp_id, int segments) {
+    char name[64];
+    int n = access(log_fname[cp_id], F_OK) == 0;
+
+    for (int s = 1; s < segments; s++) {
+        snprintf(name, sizeof(name), "%.*s.%06d.txt", 
+            (int) strlen(log_fname[cp_id]) - 4, log_fname[cp_id], s);
+        n += access(name, F_OK) == 0;
+    }
+    return n;
+}
+
+MunitResult test_joblog_segment(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(0);
+    joblog_cursor_t cur;
+    joblog_cursor_t range;
+    job_t job;
+    job_t rjob;
+    int n = 0;
+
+    /* a partial segment size is rounded down to whole entries */
+    assert_int(joblog_set_segment_size(proc, 
+        SEGMENT_ENTRIES * JOB_STR_SIZE + 10), ==, 0);
+    assert_int(access("out/bwait_cons0000000.idx", F_OK), ==, 0);
+
+    for (int i = 0; i < 10; i++, n++) {
+        set_entry_job(&job, n);
+        joblog_write(proc, &job);
+    }
+
+    /* buffered and asynchronous writes are split across segments */
+    assert_int(joblog_set_buffer(proc, 3 * JOB_STR_SIZE), ==, 0);
+    for (int i = 0; i < 7; i++, n++) {
+        set_entry_job(&job, n);
+        joblog_write(proc, &job);
+    }
+    assert_int(joblog_set_async(proc, 4, 1, JOBLOG_FULL_BLOCK), ==, 0);
+    for (int i = 0; i < 5; i++, n++) {
+        set_entry_job(&job, n);
+        joblog_write(proc, &job);
+    }
+    assert_int(joblog_count(proc), ==, n);
+    assert_int(logged_entries(0), ==, SEGMENT_ENTRIES);
+
+    /* a process that opens the log again writes to its last segment */
+    assert_int(joblog_close(proc), ==, 0);
+    set_entry_job(&job, n++);
+    joblog_write(proc, &job);
+    assert_int(joblog_count(proc), ==, n);
+    assert_int(joblog_close(proc), ==, 0);
+
+    int segments = (n + SEGMENT_ENTRIES - 1) / SEGMENT_ENTRIES;
+    assert_int(segment_files(0, segments + 1), ==, segments);
+    for (int i = 0; i < n; i++) {
+        set_entry_job(&job, i);
+        assert_not_null(joblog_read(proc, i, &rjob));
+        assert_true(job_is_equal(&rjob, &job));
+    }
+    assert_null(joblog_read(proc, n, &rjob));
+
+    assert_int(joblog_cursor_open(proc, &cur), ==, 0);
+    assert_int(joblog_cursor_count(&cur), ==, n);
+    for (int i = 0; i < n; i++) {
+        set_entry_job(&job, i);
+        assert_not_null(joblog_cursor_next(&cur, &rjob));
+        assert_true(job_is_equal(&rjob, &job));
+    }
+    joblog_cursor_close(&cur);
+
+    /* old segments go, without renumbering the entries */
+    assert_int(joblog_delete_segments(proc, 2 * SEGMENT_ENTRIES + 1), ==, 2);
+    assert_int(joblog_delete_segments(proc, 2 * SEGMENT_ENTRIES + 1), ==, 0);
+    assert_int(segment_files(0, segments), ==, segments - 2);
+    assert_int(joblog_count(proc), ==, n);
+    assert_null(joblog_read(proc, 0, &rjob));
+    set_entry_job(&job, 2 * SEGMENT_ENTRIES);
+    assert_not_null(joblog_read(proc, 2 * SEGMENT_ENTRIES, &rjob));
+    assert_true(job_is_equal(&rjob, &job));
+
+    /* the entries of the cursor keep their numbers in the log */
+    assert_int(joblog_cursor_open(proc, &cur), ==, 0);
+    assert_int(joblog_cursor_count(&cur), ==, n - 2 * SEGMENT_ENTRIES);
+    assert_int(joblog_cursor_entry(&cur), ==, 2 * SEGMENT_ENTRIES);
+    assert_not_null(joblog_cursor_next(&cur, &rjob));
+    assert_true(job_is_equal(&rjob, &job));
+    joblog_cursor_range(&cur, SEGMENT_ENTRIES, 1, &range);
+    assert_int(joblog_cursor_entry(&range), ==, 3 * SEGMENT_ENTRIES + 1);
+    joblog_cursor_close(&range);
+    joblog_cursor_close(&cur);
+
+    /* the last segment is never deleted */
+    assert_int(joblog_delete_segments(proc, n), ==, segments - 3);
+    assert_int(segment_files(0, segments), ==, 1);
+    set_entry_job(&job, n - 1);
+    assert_not_null(joblog_read(proc, n - 1, &rjob));
+    assert_true(job_is_equal(&rjob, &job));
+
+    joblog_delete(proc);
+    assert_int(segment_files(0, segments), ==, 0);
+    assert_int(access("out/bwait_cons0000000.idx", F_OK), ==, -1);
+
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_segment_null(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(1);
+    job_t job;
+
+    errno = 0;
+    assert_int(joblog_set_segment_size(NULL, 1024), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_delete_segments(NULL, 0), ==, -1);
+    assert_int(errno, ==, EINVAL);
+
+    /* a log that is not segmented has no segments to delete */
+    set_entry_job(&job, 0);
+    joblog_write(proc, &job);
+    assert_int(joblog_delete_segments(proc, 1), ==, 0);
+    assert_int(joblog_set_segment_size(proc, 0), ==, 0);
+    assert_int(access("out/bwait_prod0000001.idx", F_OK), ==, -1);
+
+    /* a segment holds at least one entry */
+    assert_int(joblog_set_segment_size(proc, 1), ==, 0);
+    joblog_write(proc, &job);
+    joblog_write(proc, &job);
+    assert_int(joblog_count(proc), ==, 3);
+    assert_int(segment_files(1, 4), ==, 3);
+    assert_int(logged_entries(1), ==, 1);
+
+    /* and the log stays segmented when it stops rolling over */
+    assert_int(joblog_set_segment_size(proc, 0), ==, 0);
+    joblog_write(proc, &job);
+    assert_int(segment_files(1, 4), ==, 3);
+    assert_int(joblog_count(proc), ==, 4);
+    joblog_delete(proc);
+    assert_int(access("out/bwait_prod0000001.idx", F_OK), ==, -1);
+
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+#define COMPRESS_ENTRIES 300
+
+/* the name of the compressed segment s of the log of cp_id */
+static char* compressed_name(pid_t cp_id, int s, char* name) {
+    int len = (int) strlen(log_fname[cp_id]) - 4;
+
+    if (s == 0)
+        snprintf(name, 64, "%.*s.jlz", len, log_fname[cp_id]);
+    else
+        snprintf(name, 64, "%.*s.%06d.jlz", len, log_fname[cp_id], s);
+    return name;
+}
+
+MunitResult test_joblog_compress(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(0);
+    joblog_cursor_t cur;
+    joblog_cursor_t range;
+    char name[64];
+    struct stat sb;
+    job_t job;
+    job_t rjob;
+    int n = 3 * COMPRESS_ENTRIES + 10;
+
+    /* segments span more than one block of entries */
+    assert_int(joblog_set_segment_size(proc, 
+        COMPRESS_ENTRIES * JOB_STR_SIZE), ==, 0);
+    assert_int(joblog_set_compression(proc, true), ==, 0);
+    for (int i = 0; i < n; i++) {
+        set_entry_job(&job, i);
+        joblog_write(proc, &job);
+    }
+
+    /* 
+     * segments are compressed by the writer as the log rolls over, except 
+     * the last, and flushing waits for them
+     */
+    assert_int(joblog_flush(proc), ==, 0);
+    assert_int(segment_files(0, 4), ==, 1);
+    for (int s = 0; s < 3; s++) {
+        assert_int(stat(compressed_name(0, s, name), &sb), ==, 0);
+        assert_int(sb.st_size, <, COMPRESS_ENTRIES * JOB_STR_SIZE / 4);
+    }
+    assert_int(access(compressed_name(0, 3, name), F_OK), ==, -1);
+    assert_int(joblog_count(proc), ==, n);
+
+    /* reads are the same, with and without the log open */
+    for (int c = 0; c < 2; c++) {
+        for (int i = 0; i < n; i++) {
+            set_entry_job(&job, i);
+            assert_not_null(joblog_read(proc, i, &rjob));
+            assert_true(job_is_equal(&rjob, &job));
+        }
+        assert_null(joblog_read(proc, n, &rjob));
+        assert_int(joblog_close(proc), ==, 0);
+    }
+
+    assert_int(joblog_cursor_open(proc, &cur), ==, 0);
+    assert_int(joblog_cursor_count(&cur), ==, n);
+    assert_not_null(joblog_cursor_range(&cur, COMPRESS_ENTRIES - 5, 
+        COMPRESS_ENTRIES * 2 + 10, &range));
+    for (int i = 0; i < n; i++) {
+        set_entry_job(&job, i);
+        assert_not_null(joblog_cursor_next(&cur, &rjob));
+        assert_true(job_is_equal(&rjob, &job));
+    }
+    assert_null(joblog_cursor_next(&cur, &rjob));
+    assert_int(cur.skipped, ==, 0);
+
+    /* a range decodes its own blocks, into text entries */
+    char entry[JOB_STR_SIZE];
+    for (int i = COMPRESS_ENTRIES - 5; i < 3 * COMPRESS_ENTRIES + 5; i++) {
+        const char* str = joblog_cursor_next_str(&range);
+        assert_not_null(str);
+        set_entry_job(&job, i);
+        assert_memory_equal(JOB_STR_SIZE - 1, str, job_to_str(&job, entry));
+        assert_char(str[JOB_STR_SIZE - 1], ==, '\n');
+    }
+    assert_null(joblog_cursor_next_str(&range));
+    joblog_cursor_close(&range);
+    joblog_cursor_close(&cur);
+
+    /* compressed segments go with the log */
+    joblog_delete(proc);
+    for (int s = 0; s < 3; s++)
+        assert_int(access(compressed_name(0, s, name), F_OK), ==, -1);
+
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_compress_null(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(1);
+    joblog_cursor_t cur;
+    char name[64];
+    job_t job;
+    job_t rjob;
+    int n = 3 * SEGMENT_ENTRIES;
+
+    errno = 0;
+    assert_int(joblog_set_compression(NULL, true), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_compress_segments(NULL, 0), ==, -1);
+    assert_int(errno, ==, EINVAL);
+
+    /* a log that is not segmented has no segments to compress */
+    set_entry_job(&job, 0);
+    joblog_write(proc, &job);
+    assert_int(joblog_compress_segments(proc, 1), ==, 0);
+    joblog_delete(proc);
+
+    assert_int(joblog_set_segment_size(proc, 
+        SEGMENT_ENTRIES * JOB_STR_SIZE), ==, 0);
+    for (int i = 0; i < n; i++) {
+        set_entry_job(&job, i);
+        joblog_write(proc, &job);
+    }
+    assert_int(segment_files(1, 4), ==, 3);
+
+    /* corrupt the separator of entry 1, which stays malformed */
+    FILE* lf = fopen(log_fname[1], "r+");
+    fseek(lf, JOB_STR_SIZE + 11, SEEK_SET);
+    fputc(';', lf);
+    fclose(lf);
+
+    assert_int(joblog_compress_segments(proc, SEGMENT_ENTRIES - 1), ==, 0);
+    assert_int(joblog_compress_segments(proc, SEGMENT_ENTRIES), ==, 1);
+    assert_int(joblog_compress_segments(proc, SEGMENT_ENTRIES), ==, 0);
+    assert_int(access(log_fname[1], F_OK), ==, -1);
+    assert_int(access(compressed_name(1, 0, name), F_OK), ==, 0);
+
+    /* the last segment is never compressed */
+    assert_int(joblog_compress_segments(proc, n), ==, 1);
+    assert_int(segment_files(1, 4), ==, 1);
+    assert_int(access(compressed_name(1, 2, name), F_OK), ==, -1);
+
+    int init_errno = errno;
+    for (int i = 0; i < n; i++) {
+        job_t* jptr = joblog_read(proc, i, &rjob);
+        if (i == 1) {
+            assert_null(jptr);
+        } else {
+            set_entry_job(&job, i);
+            assert_ptr_equal(jptr, &rjob);
+            assert_true(job_is_equal(&rjob, &job));
+        }
+        assert_int(errno, ==, init_errno);
+    }
+
+    assert_int(joblog_cursor_open(proc, &cur), ==, 0);
+    assert_int(joblog_cursor_count(&cur), ==, n);
+    assert_not_null(joblog_cursor_next_str(&cur));
+    assert_char(joblog_cursor_next_str(&cur)[0], ==, '?');
+    for (int i = 2; i < n; i++) {
+        set_entry_job(&job, i);
+        assert_not_null(joblog_cursor_next(&cur, &rjob));
+        assert_true(job_is_equal(&rjob, &job));
+    }
+    assert_int(cur.skipped, ==, 0);
+    joblog_cursor_close(&cur);
+
+    /* deleted segments are not compressed */
+    assert_int(joblog_delete_segments(proc, n), ==, 2);
+    assert_int(access(compressed_name(1, 0, name), F_OK), ==, -1);
+    assert_int(joblog_compress_segments(proc, n), ==, 0);
+
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+#define RANGE_ENTRIES 5000
+
+MunitResult test_joblog_read_range(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(0);
+    job_t* jobs = calloc(RANGE_ENTRIES + 1, sizeof(job_t));
+    job_t job;
+
+    /* more entries than are read in one chunk, some of them buffered */
+    for (int i = 0; i < RANGE_ENTRIES; i++) {
+        if (i == RANGE_ENTRIES - 10) 
+            assert_int(joblog_set_buffer(proc, 64 * JOB_STR_SIZE), ==, 0);
+        set_entry_job(&job, i);
+        joblog_write(proc, &job);
+    }
+
+    assert_int(joblog_read_range(proc, 0, RANGE_ENTRIES + 1, jobs), ==, 
+        RANGE_ENTRIES);
+    for (int i = 0; i < RANGE_ENTRIES; i++) {
+        set_entry_job(&job, i);
+        assert_true(job_is_equal(&jobs[i], &job));
+    }
+    assert_int(joblog_read_range(proc, 7, 3, jobs), ==, 3);
+    set_entry_job(&job, 9);
+    assert_true(job_is_equal(&jobs[2], &job));
+    assert_int(joblog_read_range(proc, RANGE_ENTRIES, 1, jobs), ==, 0);
+    assert_int(joblog_read_range(proc, 0, 0, jobs), ==, 0);
+    assert_int(joblog_close(proc), ==, 0);
+
+    /* the range ends at a malformed entry */
+    FILE* lf = fopen(log_fname[0], "r+");
+    fseek(lf, 4100 * JOB_STR_SIZE + 11, SEEK_SET);
+    fputc(';', lf);
+    fclose(lf);
+    assert_int(joblog_read_range(proc, 4000, 200, jobs), ==, 100);
+    assert_int(joblog_read_range(proc, 4100, 200, jobs), ==, 0);
+    assert_int(joblog_read_range(proc, 4101, 200, jobs), ==, 200);
+    set_entry_job(&job, 4101);
+    assert_true(job_is_equal(&jobs[0], &job));
+    joblog_delete(proc);
+
+    /* across text, compressed and deleted segments */
+    assert_int(joblog_set_segment_size(proc, 
+        COMPRESS_ENTRIES * JOB_STR_SIZE), ==, 0);
+    for (int i = 0; i < 4 * COMPRESS_ENTRIES; i++) {
+        set_entry_job(&job, i);
+        joblog_write(proc, &job);
+    }
+    assert_int(joblog_compress_segments(proc, 2 * COMPRESS_ENTRIES), ==, 2);
+
+    int first = COMPRESS_ENTRIES / 2;
+    assert_int(joblog_read_range(proc, first, 3 * COMPRESS_ENTRIES, jobs), 
+        ==, 3 * COMPRESS_ENTRIES);
+    for (int i = 0; i < 3 * COMPRESS_ENTRIES; i++) {
+        set_entry_job(&job, first + i);
+        assert_true(job_is_equal(&jobs[i], &job));
+    }
+    assert_int(joblog_read_range(proc, 4 * COMPRESS_ENTRIES - 1, 10, jobs), 
+        ==, 1);
+
+    assert_int(joblog_delete_segments(proc, COMPRESS_ENTRIES), ==, 1);
+    errno = 0;
+    assert_int(joblog_read_range(proc, 0, 10, jobs), ==, -1);
+    assert_int(errno, ==, ENOENT);
+    errno = 0;
+    assert_int(joblog_read_range(proc, COMPRESS_ENTRIES, 10, jobs), ==, 10);
+    assert_int(errno, ==, 0);
+
+    free(jobs);
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
+
+MunitResult test_joblog_read_range_null(const MunitParameter params[],
+    void* fixture) {
+    proc_t* proc = new_test_proc(1);
+    job_t jobs[2];
+
+    errno = 0;
+    assert_int(joblog_read_range(NULL, 0, 1, jobs), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_read_range(proc, 0, 1, NULL), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_read_range(proc, -1, 1, jobs), ==, -1);
+    assert_int(errno, ==, EINVAL);
+    errno = 0;
+    assert_int(joblog_read_range(proc, 0, -1, jobs), ==, -1);
+    assert_int(errno, ==, EINVAL);
+
+    /* there is no log to read */
+    errno = 0;
+    assert_int(joblog_read_range(proc, 0, 1, jobs), ==, -1);
+    assert_int(errno, ==, ENOENT);
+    assert_int(access(log_fname[1], F_OK), ==, -1);
+
+    proc_delete(proc);
+    errno = 0;
+
+    return MUNIT_OK;
+}
@@ -46,6 +46,52 @@ MunitResult test_joblog_read_null(const MunitParameter params[],
 
 MunitResult test_joblog_delete(const MunitParameter params[],
     void* fixture);
+MunitResult test_joblog_buffer(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_buffer_threshold(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_buffer_exit(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_buffer_null(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_count(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_read_malformed(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_cursor(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_cursor_range(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_cursor_malformed(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_async(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_async_drop(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_async_exit(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_async_null(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_sync(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_sync_null(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_sync_interval(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_segment(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_segment_null(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_compress(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_compress_null(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_read_range(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_read_range_null(const MunitParameter params[],
+    void* fixture);
+MunitResult test_joblog_write_compact(const MunitParameter params[],
+    void* fixture);
 
 static MunitTest tests[] = {
     { "/test_joblog_write_cpid0", test_joblog_write_cpid0,
@@ -82,6 +128,52 @@ static MunitTest tests[] = {
 
     { "/test_joblog_delete", test_joblog_delete, test_setup, test_tear_down,
         MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_buffer", test_joblog_buffer, test_setup, test_tear_down,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_buffer_threshold", test_joblog_buffer_threshold, 
+        test_setup, test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_buffer_exit", test_joblog_buffer_exit, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_buffer_null", test_joblog_buffer_null, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_count", test_joblog_count, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_read_malformed", test_joblog_read_malformed, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_cursor", test_joblog_cursor, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_cursor_range", test_joblog_cursor_range, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_cursor_malformed", test_joblog_cursor_malformed, 
+        test_setup, test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_async", test_joblog_async, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_async_drop", test_joblog_async_drop, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_async_exit", test_joblog_async_exit, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_async_null", test_joblog_async_null, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_sync", test_joblog_sync, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_sync_null", test_joblog_sync_null, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_sync_interval", test_joblog_sync_interval, test_setup,
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_segment", test_joblog_segment, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_segment_null", test_joblog_segment_null, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_compress", test_joblog_compress, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_compress_null", test_joblog_compress_null, test_setup,
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_read_range", test_joblog_read_range, test_setup, 
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_read_range_null", test_joblog_read_range_null, 
+        test_setup, test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_joblog_write_compact", test_joblog_write_compact, test_setup,
+        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
 
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
 };
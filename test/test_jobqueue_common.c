@@ -242,7 +242,8 @@ static MunitResult test_jq_ndequeue_tofull(test_jq_t* test_jq, int pri_method) {
 
 /* tests */
 MunitResult test_pjq_init(test_jq_t* test_jq) {
-    pri_jobqueue_t* q = (pri_jobqueue_t*) malloc(sizeof(pri_jobqueue_t));
+    pri_jobqueue_t* q = (pri_jobqueue_t*) 
+        malloc(pri_jobqueue_sizeof(JOB_BUFFER_SIZE));
     
     pri_jobqueue_init(q);
     
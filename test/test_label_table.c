@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "test_label_table.h"
+#include "../label_table.h"
+
+int main(int argc, char** argv) {
+    return munit_suite_main(&suite, NULL, argc, argv);
+}
+
+MunitResult test_label_table_new(const MunitParameter params[],
+    void* fixture) {
+    errno = 0;
+    assert_null(label_table_new(0));
+    assert_int(errno, ==, EINVAL);
+    assert_size(label_table_sizeof(0), ==, 0);
+
+    label_table_t* lt = label_table_new(LABEL_TABLE_SIZE);
+    assert_not_null(lt);
+    assert_int(lt->capacity, ==, LABEL_TABLE_SIZE);
+    assert_int(label_table_count(lt), ==, 0);
+    assert_int(label_table_count(NULL), ==, 0);
+    assert_uint32(lt->index_mask + 1, >=, 2 * LABEL_TABLE_SIZE);
+    assert_uint32(lt->index_mask & (lt->index_mask + 1), ==, 0);
+    assert_size(lt->index_off + (lt->index_mask + 1) * sizeof(uint32_t), ==,
+        label_table_sizeof(LABEL_TABLE_SIZE));
+
+    assert_size(sizeof(compact_job_t), ==, 16);
+
+    label_table_delete(lt);
+    label_table_delete(NULL);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_label_table_init(const MunitParameter params[],
+    void* fixture) {
+    size_t size = label_table_sizeof(4);
+    label_table_t* lt = malloc(size);
+
+    assert_null(label_table_init(NULL, 4));
+    assert_null(label_table_init(lt, 0));
+
+    memset(lt, 0xff, size);
+    assert_ptr_equal(label_table_init(lt, 4), lt);
+    assert_int(label_table_count(lt), ==, 0);
+    assert_uint32(label_table_find(lt, "a"), ==, LABEL_NONE);
+    assert_uint32(label_table_intern(lt, "a"), ==, 0);
+
+    /* re-initialising empties the table */
+    assert_ptr_equal(label_table_init(lt, 4), lt);
+    assert_uint32(label_table_find(lt, "a"), ==, LABEL_NONE);
+
+    free(lt);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_label_table_intern(const MunitParameter params[],
+    void* fixture) {
+    label_table_t* lt = label_table_new(LABEL_TABLE_SIZE);
+    char label[MAX_NAME_SIZE];
+    job_t job;
+
+    assert_uint32(label_table_intern(NULL, "a"), ==, LABEL_NONE);
+    assert_uint32(label_table_find(NULL, "a"), ==, LABEL_NONE);
+    assert_null(label_table_label(NULL, 0));
+    assert_null(label_table_label(lt, 0));
+    assert_null(label_table_label(lt, LABEL_NONE));
+
+    for (int i = 0; i < LABEL_TABLE_SIZE; i++) {
+        snprintf(label, sizeof(label), "label%d", i);
+        assert_uint32(label_table_intern(lt, label), ==, i);
+        assert_int(label_table_count(lt), ==, i + 1);
+    }
+
+    for (int i = LABEL_TABLE_SIZE - 1; i >= 0; i--) {
+        snprintf(label, sizeof(label), "label%d", i);
+        job_set(&job, 0, 0, 0, label);
+        assert_uint32(label_table_intern(lt, label), ==, i);
+        assert_uint32(label_table_find(lt, label), ==, i);
+        /* a label and its padded form are the same label */
+        assert_uint32(label_table_find(lt, job.label), ==, i);
+        assert_string_equal(label_table_label(lt, i), job.label);
+    }
+
+    assert_int(label_table_count(lt), ==, LABEL_TABLE_SIZE);
+    assert_uint32(label_table_find(lt, "label"), ==, LABEL_NONE);
+    assert_null(label_table_label(lt, LABEL_TABLE_SIZE));
+
+    label_table_delete(lt);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_label_table_full(const MunitParameter params[],
+    void* fixture) {
+    label_table_t* lt = label_table_new(2);
+
+    assert_uint32(label_table_intern(lt, NULL), ==, 0);
+    assert_uint32(label_table_intern(lt, ""), ==, 0);
+    assert_uint32(label_table_intern(lt, PAD_STRING), ==, 0);
+    assert_string_equal(label_table_label(lt, 0), PAD_STRING);
+    assert_uint32(label_table_intern(lt, "b"), ==, 1);
+    assert_uint32(label_table_intern(lt, "c"), ==, LABEL_NONE);
+    assert_uint32(label_table_intern(lt, "b"), ==, 1);
+    assert_int(label_table_count(lt), ==, 2);
+
+    label_table_delete(lt);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_label_table_compact(const MunitParameter params[],
+    void* fixture) {
+    label_table_t* lt = label_table_new(8);
+    compact_job_t cjobs[64];
+    job_t jobs[64];
+    job_t job;
+    char label[MAX_NAME_SIZE];
+
+    for (int i = 0; i < 64; i++) {
+        snprintf(label, sizeof(label), "job%d", i % 8);
+        job_set(&jobs[i], i + 1, i, i % 5 + 1, label);
+        assert_ptr_equal(label_table_compact(lt, &jobs[i], &cjobs[i]),
+            &cjobs[i]);
+        assert_int(cjobs[i].pid, ==, i + 1);
+        assert_uint(cjobs[i].id, ==, i);
+        assert_uint(cjobs[i].priority, ==, i % 5 + 1);
+        assert_uint32(cjobs[i].label, ==, i % 8);
+    }
+    assert_int(label_table_count(lt), ==, 8);
+
+    for (int i = 0; i < 64; i++) {
+        assert_ptr_equal(label_table_expand(lt, &cjobs[i], &job), &job);
+        assert_true(job_is_equal(&job, &jobs[i]));
+
+        job_t* jp = label_table_expand(lt, &cjobs[i], NULL);
+        assert_not_null(jp);
+        assert_true(job_is_equal(jp, &jobs[i]));
+        job_delete(jp);
+    }
+
+    /* no room for a ninth label */
+    job_set(&job, 1, 1, 1, "job8");
+    assert_null(label_table_compact(lt, &job, &cjobs[0]));
+
+    /* invalid label */
+    memset(job.label, 'x', MAX_NAME_SIZE);
+    assert_null(label_table_compact(lt, &job, &cjobs[0]));
+
+    assert_null(label_table_compact(NULL, &jobs[0], &cjobs[0]));
+    assert_null(label_table_compact(lt, NULL, &cjobs[0]));
+    assert_null(label_table_compact(lt, &jobs[0], NULL));
+    assert_null(label_table_expand(NULL, &cjobs[0], &job));
+    assert_null(label_table_expand(lt, NULL, &job));
+
+    cjobs[0].label = 8;
+    assert_null(label_table_expand(lt, &cjobs[0], &job));
+
+    label_table_delete(lt);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_label_table_to_str(const MunitParameter params[],
+    void* fixture) {
+    label_table_t* lt = label_table_new(LABEL_TABLE_SIZE);
+    compact_job_t cjob;
+    job_t job;
+    char expected[JOB_STR_SIZE];
+    char str[JOB_STR_SIZE];
+
+    job_set(&job, 1234, 42, 3, "label");
+    label_table_compact(lt, &job, &cjob);
+
+    assert_not_null(job_to_str(&job, expected));
+    assert_ptr_equal(label_table_to_str(lt, &cjob, str), str);
+    assert_string_equal(str, expected);
+
+    char* s = label_table_to_str(lt, &cjob, NULL);
+    assert_not_null(s);
+    assert_string_equal(s, expected);
+    free(s);
+
+    assert_null(label_table_to_str(NULL, &cjob, str));
+    assert_null(label_table_to_str(lt, NULL, str));
+
+    label_table_delete(lt);
+
+    return MUNIT_OK;
+}
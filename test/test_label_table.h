@@ -0,0 +1,43 @@
+/* 
+ * test_label_table.h - structures and function declarations for unit tests
+ * of the label table and compact jobs.
+ */  
+#ifndef _TEST_LABEL_TABLE_H
+#define _TEST_LABEL_TABLE_H
+#define MUNIT_ENABLE_ASSERT_ALIASES
+#include "munit/munit.h"
+
+MunitResult test_label_table_new(const MunitParameter params[],
+    void* fixture);
+MunitResult test_label_table_init(const MunitParameter params[],
+    void* fixture);
+MunitResult test_label_table_intern(const MunitParameter params[],
+    void* fixture);
+MunitResult test_label_table_full(const MunitParameter params[],
+    void* fixture);
+MunitResult test_label_table_compact(const MunitParameter params[],
+    void* fixture);
+MunitResult test_label_table_to_str(const MunitParameter params[],
+    void* fixture);
+
+static MunitTest tests[] = {
+    { "/test_label_table_new", test_label_table_new, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_label_table_init", test_label_table_init, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_label_table_intern", test_label_table_intern, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_label_table_full", test_label_table_full, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_label_table_compact", test_label_table_compact, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_label_table_to_str", test_label_table_to_str, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite suite = {
+    "/test_label_table", tests, NULL, 1, MUNIT_SUITE_OPTION_NONE
+};
+
+#endif
@@ -1,4 +1,8 @@
 /******** DO NOT EDIT THIS FILE ********/
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
 #include "test_jobqueue_common.h"
 #include "test_pri_jobqueue.h"
 #include "../pri_jobqueue.h"
@@ -7,17 +11,33 @@ int main(int argc, char** argv) {
     return munit_suite_main(&suite, NULL, argc, argv);
 }
 
+static pri_jobqueue_engine_t engine_param(const MunitParameter params[]) {
+    const char* engine = munit_parameters_get(params, "engine");
+    
+    if (engine && !strcmp(engine, "scan"))
+        return PRI_JOBQUEUE_SCAN;
+    if (engine && !strcmp(engine, "bucket"))
+        return PRI_JOBQUEUE_BUCKET;
+        
+    return PRI_JOBQUEUE_HEAP;
+}
+
+static pri_jobqueue_layout_t layout_param(const MunitParameter params[]) {
+    const char* layout = munit_parameters_get(params, "layout");
+    
+    if (layout && !strcmp(layout, "aos"))
+        return PRI_JOBQUEUE_AOS;
+        
+    return PRI_JOBQUEUE_SOA;
+}
+
 void* test_setup(const MunitParameter params[], void* user_data) {
     test_jq_t* test_jq = (test_jq_t*) malloc(sizeof(test_jq_t));
     
-    pri_jobqueue_t* q = (pri_jobqueue_t*) malloc(sizeof(pri_jobqueue_t));
+    pri_jobqueue_t* q = pri_jobqueue_new();
     
-    q->buf_size = JOB_BUFFER_SIZE;
-    q->size = 0;
-    
-    for (int i = 0; i < q->buf_size; i++) {
-        init_job(&q->jobs[i]);
-    }
+    assert_true(pri_jobqueue_set_engine(q, engine_param(params)));
+    assert_true(pri_jobqueue_set_layout(q, layout_param(params)));
     
     test_jq->q = q;
     test_jq->qimpl = q; 
@@ -55,11 +75,756 @@ MunitResult test_pri_jobqueue_new(const MunitParameter params[],
     return MUNIT_OK;
 }
 
+MunitResult test_pri_jobqueue_new_sized(const MunitParameter params[], 
+    void* fixture) {
+    int capacities[] = { 1, 3, JOB_BUFFER_SIZE + 1, 100000 };
+    
+    for (int c = 0; c < 4; c++) {
+        pri_jobqueue_t* q = pri_jobqueue_new_sized(capacities[c]);
+        
+        assert_not_null(q);
+        assert_int(q->buf_size, ==, capacities[c]);
+        assert_true(jobs_initialised(q->jobs, q->buf_size, q->buf_size));
+        
+        job_t j;
+        for (int i = 0; !pri_jobqueue_is_full(q); i++) {
+            set_job(&j, i + 1, i, munit_rand_int_range(1, 5));
+            pri_jobqueue_enqueue(q, &j);
+        }
+        
+        assert_int(pri_jobqueue_size(q), ==, capacities[c]);
+        assert_int(pri_jobqueue_space(q), ==, 0);
+        assert_true(jobs_valid(q->jobs, q->buf_size, q->buf_size));
+        
+        job_t prev;
+        init_job(&prev);
+        while (pri_jobqueue_dequeue(q, &j)) {
+            // priority order, FIFO (increasing id) within a priority level
+            assert_uint(j.priority, >=, prev.priority);
+            if (j.priority == prev.priority)
+                assert_uint(j.id, >, prev.id);
+            prev = j;
+        }
+        
+        assert_true(pri_jobqueue_is_empty(q));
+        assert_true(jobs_initialised(q->jobs, q->buf_size, q->buf_size));
+        
+        pri_jobqueue_delete(q);
+    }
+    
+    errno = 0;
+    assert_null(pri_jobqueue_new_sized(0));
+    assert_int(errno, ==, EINVAL);
+    assert_null(pri_jobqueue_new_sized(PRI_JOBQUEUE_MAX_CAPACITY + 1));
+    assert_int(pri_jobqueue_sizeof(0), ==, 0);
+    assert_int(pri_jobqueue_sizeof(1), <, pri_jobqueue_sizeof(2));
+    assert_int(pri_jobqueue_init_sized(NULL, 1), ==, -1);
+    
+    return MUNIT_OK;
+}
+
 MunitResult test_pri_jobqueue_init(const MunitParameter params[], 
     void* fixture) {
     return test_pjq_init((test_jq_t*) fixture);
 }
 
+MunitResult test_pri_jobqueue_set_engine(const MunitParameter params[], 
+    void* fixture) {
+    pri_jobqueue_t* q = pri_jobqueue_new();
+    job_t j;
+    
+    assert_true(pri_jobqueue_set_engine(q, PRI_JOBQUEUE_SCAN));
+    assert_int(q->engine, ==, PRI_JOBQUEUE_SCAN);
+    assert_false(pri_jobqueue_set_engine(q, (pri_jobqueue_engine_t) -1));
+    
+    set_job(&j, 1, 1, 1);
+    pri_jobqueue_enqueue(q, &j);
+    
+    // engine cannot be changed on a queue that is not empty
+    assert_false(pri_jobqueue_set_engine(q, PRI_JOBQUEUE_HEAP));
+    assert_int(q->engine, ==, PRI_JOBQUEUE_SCAN);
+    assert_int(q->size, ==, 1);
+    
+    assert_not_null(pri_jobqueue_dequeue(q, &j));
+    assert_true(pri_jobqueue_set_engine(q, PRI_JOBQUEUE_HEAP));
+    assert_false(pri_jobqueue_set_engine(NULL, PRI_JOBQUEUE_HEAP));
+    
+    free(q);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_pri_jobqueue_set_levels(const MunitParameter params[], 
+    void* fixture) {
+    pri_jobqueue_t* q = pri_jobqueue_new();
+    unsigned int pris[] = { 3, 1, 4, 2, 1, 4, 3, 2, 5, 1 };
+    int n = sizeof(pris) / sizeof(pris[0]);
+    job_t j;
+    
+    assert_int(q->levels, ==, PRI_JOBQUEUE_LEVELS);
+    assert_true(pri_jobqueue_set_engine(q, PRI_JOBQUEUE_BUCKET));
+    assert_false(pri_jobqueue_set_levels(q, 0));
+    assert_false(pri_jobqueue_set_levels(q, PRI_JOBQUEUE_MAX_LEVELS + 1));
+    assert_false(pri_jobqueue_set_levels(NULL, 2));
+    assert_true(pri_jobqueue_set_levels(q, 2));
+    assert_int(q->levels, ==, 2);
+    
+    // priorities 1 and 2 are listed, 3 to 5 go on the heap
+    for (int i = 0; i < n; i++) {
+        set_job(&j, i, i, pris[i]);
+        pri_jobqueue_enqueue(q, &j);
+    }
+    
+    assert_int(q->size, ==, n);
+    assert_false(pri_jobqueue_set_levels(q, 4));
+    
+    // in priority order, and FIFO (by id) within a priority
+    unsigned int last_pri = 0;
+    unsigned int last_id = 0;
+    for (int i = 0; i < n; i++) {
+        assert_not_null(pri_jobqueue_dequeue(q, &j));
+        assert_true(j.priority >= last_pri);
+        if (j.priority == last_pri)
+            assert_true(j.id > last_id);
+        last_pri = j.priority;
+        last_id = j.id;
+    }
+    
+    assert_true(pri_jobqueue_is_empty(q));
+    assert_int(q->level_map, ==, 0);
+    assert_int(q->heap_size, ==, 0);
+    
+    free(q);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_pri_jobqueue_set_layout(const MunitParameter params[], 
+    void* fixture) {
+    pri_jobqueue_t* q = pri_jobqueue_new();
+    job_t j;
+    
+    assert_int(q->layout, ==, PRI_JOBQUEUE_SOA);
+    assert_true(pri_jobqueue_set_layout(q, PRI_JOBQUEUE_AOS));
+    assert_int(q->layout, ==, PRI_JOBQUEUE_AOS);
+    assert_false(pri_jobqueue_set_layout(q, (pri_jobqueue_layout_t) -1));
+    assert_false(pri_jobqueue_set_layout(NULL, PRI_JOBQUEUE_SOA));
+    
+    set_job(&j, 1, 1, 1);
+    pri_jobqueue_enqueue(q, &j);
+    assert_false(pri_jobqueue_set_layout(q, PRI_JOBQUEUE_SOA));
+    assert_int(q->layout, ==, PRI_JOBQUEUE_AOS);
+    
+    assert_not_null(pri_jobqueue_dequeue(q, &j));
+    assert_true(pri_jobqueue_set_layout(q, PRI_JOBQUEUE_SOA));
+    
+    free(q);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_pri_jobqueue_set_aging(const MunitParameter params[], 
+    void* fixture) {
+    pri_jobqueue_t* q = pri_jobqueue_new();
+    job_t j;
+    
+    assert_int(q->aging, ==, PRI_JOBQUEUE_AGE_NONE);
+    assert_true(pri_jobqueue_set_aging(q, PRI_JOBQUEUE_AGE_DEQUEUES, 8));
+    assert_int(q->aging, ==, PRI_JOBQUEUE_AGE_DEQUEUES);
+    assert_uint(q->age_step, ==, 8);
+    assert_true(pri_jobqueue_set_aging(q, PRI_JOBQUEUE_AGE_MSEC, 100));
+    assert_int(q->aging, ==, PRI_JOBQUEUE_AGE_MSEC);
+    
+    assert_false(pri_jobqueue_set_aging(q, PRI_JOBQUEUE_AGE_DEQUEUES, 0));
+    assert_false(pri_jobqueue_set_aging(q, (pri_jobqueue_aging_t) -1, 1));
+    assert_false(pri_jobqueue_set_aging(NULL, PRI_JOBQUEUE_AGE_NONE, 0));
+    assert_int(q->aging, ==, PRI_JOBQUEUE_AGE_MSEC);
+    
+    set_job(&j, 1, 1, 1);
+    pri_jobqueue_enqueue(q, &j);
+    assert_false(pri_jobqueue_set_aging(q, PRI_JOBQUEUE_AGE_NONE, 0));
+    assert_int(q->aging, ==, PRI_JOBQUEUE_AGE_MSEC);
+    
+    assert_not_null(pri_jobqueue_dequeue(q, &j));
+    assert_true(pri_jobqueue_set_aging(q, PRI_JOBQUEUE_AGE_NONE, 0));
+    assert_uint(q->age_step, ==, 0);
+    
+    free(q);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_pri_jobqueue_aging(const MunitParameter params[], 
+    void* fixture) {
+    pri_jobqueue_t* q = (pri_jobqueue_t*) ((test_jq_t*) fixture)->q;
+    unsigned int step = 4;
+    unsigned int dequeues = 0;
+    job_t jobs[JOB_BUFFER_SIZE];
+    unsigned int keys[JOB_BUFFER_SIZE];
+    int n = 0;
+    job_t j;
+    
+    assert_true(pri_jobqueue_set_aging(q, PRI_JOBQUEUE_AGE_DEQUEUES, step));
+    
+    /* 
+     * against a model that holds jobs in FIFO order with their keys, the 
+     * job dequeued is always the first with the least key
+     */
+    for (int i = 0; i < 4000; i++) {
+        if (munit_rand_int_range(0, 2) && n < JOB_BUFFER_SIZE) {
+            set_job(&j, i, i, munit_rand_int_range(1, 20));
+            pri_jobqueue_enqueue(q, &j);
+            jobs[n] = j;
+            keys[n++] = j.priority * step + dequeues;
+        } else if (n > 0) {
+            int top = 0;
+            for (int k = 1; k < n; k++) {
+                if (keys[k] < keys[top]) top = k;
+            }
+            
+            assert_true(equal_jobs(pri_jobqueue_dequeue(q, &j), &jobs[top]));
+            dequeues++;
+            
+            n--;
+            memmove(&jobs[top], &jobs[top + 1], (n - top) * sizeof(job_t));
+            memmove(&keys[top], &keys[top + 1], 
+                (n - top) * sizeof(unsigned int));
+        } else {
+            assert_null(pri_jobqueue_dequeue(q, &j));
+        }
+    }
+    
+    while (!pri_jobqueue_is_empty(q))
+        pri_jobqueue_dequeue(q, &j);
+    
+    /* 
+     * a low priority job is not starved by a stream of priority 1 jobs, it 
+     * waits at most (5 - 1) * step dequeues
+     */
+    set_job(&j, 0, 0, 5);
+    pri_jobqueue_enqueue(q, &j);
+    
+    int waited = 0;
+    for (;;) {
+        set_job(&j, 1, waited + 1, 1);
+        pri_jobqueue_enqueue(q, &j);
+        pri_jobqueue_dequeue(q, &j);
+        if (j.priority == 5) break;
+        waited++;
+        assert_int(waited, <=, 4 * step);
+    }
+    assert_int(waited, ==, 4 * step);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_pri_jobqueue_aging_large(const MunitParameter params[], 
+    void* fixture) {
+    pri_jobqueue_t* q = (pri_jobqueue_t*) ((test_jq_t*) fixture)->q;
+    job_t j;
+    
+    /* priority * step past 2^31 and 2^32 does not wrap the keys */
+    unsigned int steps[] = { 1, 256, 1u << 31 };
+    unsigned int low[] = { 3000000000u, 1u << 24, 2 };
+    for (int t = 0; t < 3; t++) {
+        assert_true(pri_jobqueue_set_aging(q, PRI_JOBQUEUE_AGE_DEQUEUES, 
+            steps[t]));
+        set_job(&j, 1, 1, low[t]);
+        pri_jobqueue_enqueue(q, &j);
+        set_job(&j, 2, 2, 1);
+        pri_jobqueue_enqueue(q, &j);
+        set_job(&j, 3, 3, low[t] - 1);
+        pri_jobqueue_enqueue(q, &j);
+        
+        assert_int(pri_jobqueue_dequeue(q, &j)->pid, ==, 2);
+        assert_int(pri_jobqueue_dequeue(q, &j)->pid, ==, 3);
+        assert_int(pri_jobqueue_dequeue(q, &j)->pid, ==, 1);
+        assert_true(pri_jobqueue_is_empty(q));
+    }
+    
+    /* and nor does reprioritising a job to the largest priority */
+    assert_true(pri_jobqueue_set_aging(q, PRI_JOBQUEUE_AGE_MSEC, 1u << 31));
+    set_job(&j, 1, 1, 1);
+    pri_jobqueue_enqueue(q, &j);
+    set_job(&j, 2, 2, 2);
+    pri_jobqueue_enqueue(q, &j);
+    assert_true(pri_jobqueue_reprioritise(q, 1, 1, UINT_MAX));
+    assert_int(pri_jobqueue_dequeue(q, &j)->pid, ==, 2);
+    assert_int(pri_jobqueue_dequeue(q, &j)->pid, ==, 1);
+    assert_int(j.priority, ==, UINT_MAX);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_pri_jobqueue_cancel_duplicate(const MunitParameter params[],
+    void* fixture) {
+    pri_jobqueue_t* q = (pri_jobqueue_t*) ((test_jq_t*) fixture)->q;
+    job_t j;
+    
+    /* 
+     * jobs that share a pid and id are cancelled and reprioritised oldest 
+     * first, whatever their priorities and slots
+     */
+    for (int i = 0; i < 8; i++) {
+        set_job(&j, 1, 1, 8 - i);
+        pri_jobqueue_enqueue(q, &j);
+        set_job(&j, 2, i, 1);
+        pri_jobqueue_enqueue(q, &j);
+    }
+    for (int i = 0; i < 8; i++) 
+        assert_true(pri_jobqueue_cancel(q, 2, i));
+    
+    assert_true(pri_jobqueue_cancel(q, 1, 1));          // priority 8
+    assert_true(pri_jobqueue_reprioritise(q, 1, 1, 9)); // priority 7 to 9
+    assert_true(pri_jobqueue_cancel(q, 1, 1));          // priority 6
+    
+    unsigned int left[] = { 1, 2, 3, 4, 5, 9 };
+    for (int i = 0; i < 6; i++) {
+        assert_not_null(pri_jobqueue_dequeue(q, &j));
+        assert_uint(j.priority, ==, left[i]);
+    }
+    assert_true(pri_jobqueue_is_empty(q));
+    assert_false(pri_jobqueue_cancel(q, 1, 1));
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_pri_jobqueue_compact(const MunitParameter params[],
+    void* fixture) {
+    int capacity = JOB_BUFFER_SIZE * 2;
+    pri_jobqueue_t* q = pri_jobqueue_new_sized(capacity);
+    pri_jobqueue_t* cq = pri_jobqueue_new_compact(capacity, 8);
+    char label[MAX_NAME_SIZE];
+    job_t j;
+    job_t cj;
+    
+    assert_not_null(cq);
+    assert_null(pri_jobqueue_labels(q));
+    
+    pri_jobqueue_t* queues[] = { q, cq };
+    for (int k = 0; k < 2; k++) {
+        assert_true(pri_jobqueue_set_engine(queues[k], engine_param(params)));
+        assert_true(pri_jobqueue_set_layout(queues[k], layout_param(params)));
+    }
+    
+    /* a compact queue dequeues the same jobs in the same order */
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < capacity; i++) {
+            (void) snprintf(label, MAX_NAME_SIZE, "label%d", i % 8);
+            job_set(&j, i, round, munit_rand_int_range(1, 40), label);
+            pri_jobqueue_enqueue(q, &j);
+            pri_jobqueue_enqueue(cq, &j);
+        }
+        assert_true(pri_jobqueue_is_full(cq));
+        
+        for (int i = 0; i < capacity; i += 7) {
+            assert_true(pri_jobqueue_reprioritise(q, i, round, i % 3 + 1));
+            assert_true(pri_jobqueue_reprioritise(cq, i, round, i % 3 + 1));
+            assert_true(pri_jobqueue_cancel(q, i + 1, round));
+            assert_true(pri_jobqueue_cancel(cq, i + 1, round));
+        }
+        
+        while (pri_jobqueue_peek(q, &j)) {
+            assert_not_null(pri_jobqueue_peek(cq, &cj));
+            assert_true(equal_jobs(&cj, &j));
+            assert_not_null(pri_jobqueue_dequeue(q, &j));
+            assert_not_null(pri_jobqueue_dequeue(cq, &cj));
+            assert_true(equal_jobs(&cj, &j));
+        }
+        assert_true(pri_jobqueue_is_empty(cq));
+        assert_int(pri_jobqueue_space(cq), ==, capacity);
+    }
+    
+    assert_int(label_table_count(pri_jobqueue_labels(cq)), ==, 8);
+    
+    /* a new label does not fit in the full table: the job is not queued */
+    job_set(&j, 1, 1, 1, "label8");
+    errno = 0;
+    pri_jobqueue_enqueue(cq, &j);
+    assert_int(errno, ==, ENOSPC);
+    assert_int(pri_jobqueue_size(cq), ==, 0);
+    errno = 0;
+    assert_int(pri_jobqueue_enqueue_n(cq, &j, 1), ==, 0);
+    assert_int(errno, ==, ENOSPC);
+    assert_int(pri_jobqueue_size(cq), ==, 0);
+    
+    /* but jobs with labels already in the table still are */
+    errno = 0;
+    job_set(&j, 1, 1, 1, "label7");
+    pri_jobqueue_enqueue(cq, &j);
+    assert_int(errno, ==, 0);
+    assert_int(pri_jobqueue_size(cq), ==, 1);
+    
+    pri_jobqueue_delete(cq);
+    pri_jobqueue_delete(q);
+    
+    assert_null(pri_jobqueue_new_compact(capacity, 0));
+    assert_int(pri_jobqueue_sizeof_compact(0, 8), ==, 0);
+    assert_int(pri_jobqueue_init_compact(NULL, capacity, 8), ==, -1);
+    
+    return MUNIT_OK;
+}
+
+/* the occupancy bitmap agrees with the jobs buffer and size */
+static void assert_occupancy(pri_jobqueue_t* q) {
+    uint64_t* occupied = (uint64_t*) ((char*) q + q->occupied_off);
+    int used = 0;
+    
+    for (int i = 0; i < q->buf_size; i++) {
+        bool bit = (occupied[i / 64] >> (i % 64)) & 1;
+        assert_int(bit, ==, q->jobs[i].priority > 0);
+        used += bit;
+    }
+    
+    assert_int(used, ==, q->size + q->borrowed);
+    
+    // bits past the last slot stay set
+    for (int i = q->buf_size; i % 64; i++)
+        assert_true((occupied[i / 64] >> (i % 64)) & 1);
+}
+
+MunitResult test_pri_jobqueue_set_order(const MunitParameter params[], 
+    void* fixture) {
+    pri_jobqueue_t* q = pri_jobqueue_new();
+    job_t j;
+    
+    assert_int(q->order, ==, PRI_JOBQUEUE_BY_PRIORITY);
+    assert_true(pri_jobqueue_set_order(q, PRI_JOBQUEUE_BY_DEADLINE));
+    assert_int(q->order, ==, PRI_JOBQUEUE_BY_DEADLINE);
+    assert_false(pri_jobqueue_set_order(q, (pri_jobqueue_order_t) -1));
+    assert_false(pri_jobqueue_set_order(NULL, PRI_JOBQUEUE_BY_PRIORITY));
+    
+    set_job(&j, 1, 1, 1);
+    pri_jobqueue_enqueue(q, &j);
+    assert_false(pri_jobqueue_set_order(q, PRI_JOBQUEUE_BY_PRIORITY));
+    assert_int(q->order, ==, PRI_JOBQUEUE_BY_DEADLINE);
+    
+    assert_not_null(pri_jobqueue_dequeue(q, &j));
+    assert_true(pri_jobqueue_set_order(q, PRI_JOBQUEUE_BY_PRIORITY));
+    
+    free(q);
+    
+    return MUNIT_OK;
+}
+
+/* 
+ * the index of the job of a model queue (held in FIFO order) that the queue 
+ * dequeues first of those with a deadline not before now, or -1
+ */
+static int model_top(deadline_job_t* jobs, int n, pri_jobqueue_order_t order,
+    uint64_t now) {
+    int top = -1;
+    
+    for (int i = 0; i < n; i++) {
+        if (jobs[i].deadline < now) continue;
+        if (top >= 0 && order == PRI_JOBQUEUE_BY_DEADLINE 
+            && jobs[i].deadline != jobs[top].deadline) {
+            if (jobs[i].deadline < jobs[top].deadline) top = i;
+        } else if (top < 0 || jobs[i].job.priority < jobs[top].job.priority) {
+            top = i;
+        }
+    }
+    
+    return top;
+}
+
+MunitResult test_pri_jobqueue_deadline(const MunitParameter params[], 
+    void* fixture) {
+    pri_jobqueue_t* q = (pri_jobqueue_t*) ((test_jq_t*) fixture)->q;
+    deadline_job_t jobs[JOB_BUFFER_SIZE];
+    deadline_job_t dj;
+    pri_jobqueue_order_t orders[] = { 
+        PRI_JOBQUEUE_BY_PRIORITY, PRI_JOBQUEUE_BY_DEADLINE 
+    };
+    
+    for (int o = 0; o < 2; o++) {
+        int n = 0;
+        assert_true(pri_jobqueue_set_order(q, orders[o]));
+        
+        for (int i = 0; i < 4000; i++) {
+            int op = munit_rand_int_range(0, 3);
+            
+            if (op < 2 && n < JOB_BUFFER_SIZE) {
+                // few distinct deadlines, so that priorities break ties
+                set_job(&dj.job, i, i, munit_rand_int_range(1, 20));
+                if (munit_rand_int_range(0, 9) == 0) {
+                    dj.deadline = JOB_NO_DEADLINE;
+                    pri_jobqueue_enqueue(q, &dj.job);
+                } else {
+                    dj.deadline = munit_rand_int_range(0, 9);
+                    assert_true(pri_jobqueue_enqueue_deadline(q, &dj));
+                }
+                jobs[n++] = dj;
+                continue;
+            }
+            
+            uint64_t now = op == 2 ? munit_rand_int_range(0, 10) : 0;
+            int top = model_top(jobs, n, orders[o], now);
+            
+            if (op == 2) {
+                deadline_job_t peeked;
+                deadline_job_t* p = pri_jobqueue_peek_reachable(q, now, 
+                    &peeked);
+                deadline_job_t* d = pri_jobqueue_dequeue_reachable(q, now, 
+                    &dj);
+                if (top < 0) {
+                    assert_null(p);
+                    assert_null(d);
+                    continue;
+                }
+                assert_true(equal_jobs(&peeked.job, &jobs[top].job));
+            } else if (top < 0) {
+                assert_null(pri_jobqueue_dequeue_deadline(q, &dj));
+                continue;
+            } else {
+                assert_ptr_equal(pri_jobqueue_dequeue_deadline(q, &dj), &dj);
+            }
+            
+            assert_true(equal_jobs(&dj.job, &jobs[top].job));
+            assert_true(dj.deadline == jobs[top].deadline);
+            
+            n--;
+            memmove(&jobs[top], &jobs[top + 1], 
+                (n - top) * sizeof(deadline_job_t));
+            assert_int(pri_jobqueue_size(q), ==, n);
+        }
+        
+        assert_occupancy(q);
+        while (pri_jobqueue_dequeue_deadline(q, &dj))
+            ;
+    }
+    
+    assert_false(pri_jobqueue_enqueue_deadline(q, NULL));
+    assert_false(pri_jobqueue_enqueue_deadline(NULL, &dj));
+    assert_null(pri_jobqueue_dequeue_deadline(q, NULL));
+    assert_null(pri_jobqueue_peek_reachable(NULL, 0, &dj));
+    assert_null(pri_jobqueue_dequeue_reachable(q, 0, NULL));
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_pri_jobqueue_cancel(const MunitParameter params[], 
+    void* fixture) {
+    pri_jobqueue_t* q = (pri_jobqueue_t*) ((test_jq_t*) fixture)->q;
+    job_t jobs[JOB_BUFFER_SIZE];
+    int n = 0;
+    job_t j;
+    
+    assert_false(pri_jobqueue_cancel(q, 1, 1));
+    assert_false(pri_jobqueue_reprioritise(q, 1, 1, 1));
+    
+    /* 
+     * against a model that holds jobs in the order they were last enqueued 
+     * or reprioritised, the job dequeued is the first with the highest
+     * priority
+     */
+    for (int i = 0; i < 4000; i++) {
+        int op = munit_rand_int_range(0, 4);
+        int k = n > 1 ? munit_rand_int_range(0, n - 1) : n - 1;
+        
+        if (op < 2 && n < JOB_BUFFER_SIZE) {
+            set_job(&j, i, i + 1, munit_rand_int_range(1, 20));
+            pri_jobqueue_enqueue(q, &j);
+            jobs[n++] = j;
+        } else if (op == 2 && k >= 0) {
+            assert_true(pri_jobqueue_cancel(q, jobs[k].pid, jobs[k].id));
+            assert_false(pri_jobqueue_cancel(q, jobs[k].pid, jobs[k].id));
+            n--;
+            memmove(&jobs[k], &jobs[k + 1], (n - k) * sizeof(job_t));
+        } else if (op == 3 && k >= 0) {
+            j = jobs[k];
+            j.priority = munit_rand_int_range(1, 20);
+            assert_true(pri_jobqueue_reprioritise(q, j.pid, j.id, 
+                j.priority));
+            memmove(&jobs[k], &jobs[k + 1], (n - k - 1) * sizeof(job_t));
+            jobs[n - 1] = j;
+        } else if (n > 0) {
+            int top = 0;
+            for (int m = 1; m < n; m++) {
+                if (jobs[m].priority < jobs[top].priority) top = m;
+            }
+            assert_true(equal_jobs(pri_jobqueue_dequeue(q, &j), &jobs[top]));
+            assert_false(pri_jobqueue_cancel(q, j.pid, j.id));
+            n--;
+            memmove(&jobs[top], &jobs[top + 1], (n - top) * sizeof(job_t));
+        }
+        
+        assert_int(pri_jobqueue_size(q), ==, n);
+        assert_false(pri_jobqueue_cancel(q, -1, i));
+    }
+    
+    assert_occupancy(q);
+    
+    // borrowed jobs are not on the queue
+    if (n > 0) {
+        const job_t* b = pri_jobqueue_borrow(q);
+        assert_false(pri_jobqueue_cancel(q, b->pid, b->id));
+        assert_false(pri_jobqueue_reprioritise(q, b->pid, b->id, 1));
+        assert_true(pri_jobqueue_commit(q, b));
+    }
+    
+    assert_false(pri_jobqueue_cancel(NULL, 1, 1));
+    assert_false(pri_jobqueue_reprioritise(NULL, 1, 1, 1));
+    if (n > 0)
+        assert_false(pri_jobqueue_reprioritise(q, jobs[0].pid, jobs[0].id, 0));
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_pri_jobqueue_occupancy(const MunitParameter params[], 
+    void* fixture) {
+    pri_jobqueue_t* q = (pri_jobqueue_t*) ((test_jq_t*) fixture)->q;
+    job_t j;
+    
+    assert_occupancy(q);
+    
+    for (int i = 0; i < 4000; i++) {
+        if (munit_rand_int_range(0, 2) && !pri_jobqueue_is_full(q)) {
+            set_job(&j, i, i, munit_rand_int_range(1, 20));
+            pri_jobqueue_enqueue(q, &j);
+        } else {
+            pri_jobqueue_dequeue(q, &j);
+        }
+        assert_occupancy(q);
+    }
+    
+    pri_jobqueue_init(q);
+    assert_occupancy(q);
+    
+    // a capacity that does not fill the last word
+    pri_jobqueue_t* sq = pri_jobqueue_new_sized(70);
+    for (int i = 0; i < 70; i++) {
+        set_job(&j, i, i, 1);
+        pri_jobqueue_enqueue(sq, &j);
+    }
+    assert_true(pri_jobqueue_is_full(sq));
+    assert_occupancy(sq);
+    
+    pri_jobqueue_dequeue(sq, &j);
+    pri_jobqueue_dequeue(sq, &j);
+    assert_occupancy(sq);
+    assert_int(pri_jobqueue_enqueue_n(sq, &j, 1), ==, 1);
+    assert_occupancy(sq);
+    
+    pri_jobqueue_delete(sq);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_pri_jobqueue_borrow(const MunitParameter params[], 
+    void* fixture) {
+    pri_jobqueue_t* q = (pri_jobqueue_t*) ((test_jq_t*) fixture)->q;
+    pri_jobqueue_t* ref = pri_jobqueue_new();
+    job_t j;
+    job_t exp;
+    
+    assert_null(pri_jobqueue_borrow(q));
+    
+    for (int i = 0; i < JOB_BUFFER_SIZE; i++) {
+        set_job(&j, i, i, munit_rand_int_range(1, 20));
+        pri_jobqueue_enqueue(q, &j);
+        pri_jobqueue_enqueue(ref, &j);
+    }
+    
+    // borrowed in the same order as dequeued, and in place
+    const job_t* b1 = pri_jobqueue_borrow(q);
+    const job_t* b2 = pri_jobqueue_borrow(q);
+    assert_true(b1 >= q->jobs && b1 < q->jobs + q->buf_size);
+    assert_true(equal_jobs((job_t*) b1, pri_jobqueue_dequeue(ref, &exp)));
+    assert_true(equal_jobs((job_t*) b2, pri_jobqueue_dequeue(ref, &exp)));
+    
+    // the borrowed slots are neither queued nor free
+    assert_int(pri_jobqueue_size(q), ==, JOB_BUFFER_SIZE - 2);
+    assert_int(pri_jobqueue_space(q), ==, 0);
+    assert_true(pri_jobqueue_is_full(q));
+    assert_occupancy(q);
+    assert_true(equal_jobs(pri_jobqueue_peek(q, &j), 
+        pri_jobqueue_peek(ref, &exp)));
+    assert_false(pri_jobqueue_set_engine(q, PRI_JOBQUEUE_HEAP));
+    
+    // only borrowed jobs of this queue can be committed
+    assert_false(pri_jobqueue_commit(q, NULL));
+    assert_false(pri_jobqueue_commit(NULL, b1));
+    assert_false(pri_jobqueue_commit(q, &j));
+    for (int i = 0; i < q->buf_size; i++) {
+        if (&q->jobs[i] != b1 && &q->jobs[i] != b2)
+            assert_false(pri_jobqueue_commit(q, &q->jobs[i]));
+    }
+    
+    // in any order
+    assert_true(pri_jobqueue_commit(q, b2));
+    assert_false(pri_jobqueue_commit(q, b2));
+    assert_int(pri_jobqueue_space(q), ==, 1);
+    assert_true(jobs_initialised((job_t*) b2, 1, 1));
+    assert_true(pri_jobqueue_commit(q, b1));
+    assert_occupancy(q);
+    
+    // the rest are borrowed in order too
+    while (!pri_jobqueue_is_empty(q)) {
+        const job_t* b = pri_jobqueue_borrow(q);
+        assert_true(equal_jobs((job_t*) b, pri_jobqueue_dequeue(ref, &exp)));
+        assert_true(pri_jobqueue_commit(q, b));
+    }
+    
+    assert_int(pri_jobqueue_space(q), ==, JOB_BUFFER_SIZE);
+    assert_occupancy(q);
+    
+    pri_jobqueue_delete(ref);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_pri_jobqueue_batch(const MunitParameter params[], 
+    void* fixture) {
+    pri_jobqueue_t* q = (pri_jobqueue_t*) ((test_jq_t*) fixture)->q;
+    int n = JOB_BUFFER_SIZE + 10;
+    job_t jobs[n];
+    job_t out[n];
+    
+    for (int i = 0; i < n; i++)
+        set_job(&jobs[i], i, i, (n - i) % 20 + 1);
+    
+    // stops at the first invalid job
+    jobs[5].priority = 0;
+    assert_int(pri_jobqueue_enqueue_n(q, jobs, n), ==, 5);
+    assert_int(pri_jobqueue_size(q), ==, 5);
+    jobs[5].priority = 1;
+    
+    // stops when full
+    assert_int(pri_jobqueue_enqueue_n(q, jobs + 5, n - 5), ==, 
+        JOB_BUFFER_SIZE - 5);
+    assert_true(pri_jobqueue_is_full(q));
+    assert_int(pri_jobqueue_enqueue_n(q, jobs, 1), ==, 0);
+    
+    // batches come out in the same order as single dequeues
+    pri_jobqueue_t* ref = pri_jobqueue_new();
+    pri_jobqueue_enqueue_n(ref, jobs, JOB_BUFFER_SIZE);
+    
+    int got = 0;
+    while (got < JOB_BUFFER_SIZE)
+        got += pri_jobqueue_dequeue_n(q, out + got, 7);
+    
+    assert_int(got, ==, JOB_BUFFER_SIZE);
+    assert_true(pri_jobqueue_is_empty(q));
+    assert_true(jobs_initialised(q->jobs, q->buf_size, q->buf_size));
+    for (int i = 0; i < got; i++) {
+        job_t exp;
+        pri_jobqueue_dequeue(ref, &exp);
+        assert_true(equal_jobs(&out[i], &exp));
+    }
+    
+    assert_int(pri_jobqueue_dequeue_n(q, out, n), ==, 0);
+    assert_int(pri_jobqueue_dequeue_n(NULL, out, n), ==, 0);
+    assert_int(pri_jobqueue_dequeue_n(q, NULL, n), ==, 0);
+    assert_int(pri_jobqueue_enqueue_n(NULL, jobs, n), ==, 0);
+    assert_int(pri_jobqueue_enqueue_n(q, NULL, n), ==, 0);
+    assert_int(pri_jobqueue_enqueue_n(q, jobs, 0), ==, 0);
+    
+    pri_jobqueue_delete(ref);
+    
+    return MUNIT_OK;
+}
+
 MunitResult test_prijq_ndequeue_randpri(const MunitParameter params[], 
     void* fixture) {
     return test_jq_ndequeue_randpri((test_jq_t*) fixture);
@@ -10,9 +10,54 @@
 MunitResult test_pri_jobqueue_new(const MunitParameter params[], 
     void* fixture);
     
+MunitResult test_pri_jobqueue_new_sized(const MunitParameter params[], 
+    void* fixture);
+    
 MunitResult test_pri_jobqueue_init(const MunitParameter params[], 
     void* fixture);
 
+MunitResult test_pri_jobqueue_set_engine(const MunitParameter params[], 
+    void* fixture);
+
+MunitResult test_pri_jobqueue_set_levels(const MunitParameter params[], 
+    void* fixture);
+
+MunitResult test_pri_jobqueue_set_layout(const MunitParameter params[], 
+    void* fixture);
+
+MunitResult test_pri_jobqueue_set_aging(const MunitParameter params[], 
+    void* fixture);
+
+MunitResult test_pri_jobqueue_aging(const MunitParameter params[], 
+    void* fixture);
+
+MunitResult test_pri_jobqueue_aging_large(const MunitParameter params[], 
+    void* fixture);
+
+MunitResult test_pri_jobqueue_cancel_duplicate(const MunitParameter params[],
+    void* fixture);
+
+MunitResult test_pri_jobqueue_compact(const MunitParameter params[],
+    void* fixture);
+
+MunitResult test_pri_jobqueue_set_order(const MunitParameter params[], 
+    void* fixture);
+
+MunitResult test_pri_jobqueue_deadline(const MunitParameter params[], 
+    void* fixture);
+
+MunitResult test_pri_jobqueue_cancel(const MunitParameter params[], 
+    void* fixture);
+
+MunitResult test_pri_jobqueue_occupancy(const MunitParameter params[], 
+    void* fixture);
+
+MunitResult test_pri_jobqueue_borrow(const MunitParameter params[], 
+    void* fixture);
+
+MunitResult test_pri_jobqueue_batch(const MunitParameter params[], 
+    void* fixture);
+
 MunitResult test_prijq_ndequeue_randpri(const MunitParameter params[], 
     void* fixture);
 MunitResult test_prijq_ndequeue_samepri(const MunitParameter params[], 
@@ -85,84 +130,139 @@ MunitResult test_pri_jobqueue_delete(const MunitParameter params[],
 void* test_setup(const MunitParameter params[], void* user_data);
 void test_tear_down(void* fixture);
 
+static char* engine_values[] = { "heap", "scan", "bucket", NULL };
+static char* layout_values[] = { "soa", "aos", NULL };
+
+static MunitParameterEnum engine_params[] = {
+    { "engine", engine_values },
+    { "layout", layout_values },
+    { NULL, NULL },
+};
+
 static MunitTest tests[] = {
     { "/test_pri_jobqueue_new", test_pri_jobqueue_new, NULL, NULL,
         MUNIT_TEST_OPTION_NONE, NULL },
 
+    { "/test_pri_jobqueue_new_sized", test_pri_jobqueue_new_sized, NULL, 
+        NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
     { "/test_pri_jobqueue_init", test_pri_jobqueue_init, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
+
+    { "/test_pri_jobqueue_set_engine", test_pri_jobqueue_set_engine, NULL,
+        NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { "/test_pri_jobqueue_set_levels", test_pri_jobqueue_set_levels, NULL,
+        NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { "/test_pri_jobqueue_set_layout", test_pri_jobqueue_set_layout, NULL,
+        NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { "/test_pri_jobqueue_set_aging", test_pri_jobqueue_set_aging, NULL,
+        NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { "/test_pri_jobqueue_aging", test_pri_jobqueue_aging, test_setup,
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
+
+    { "/test_pri_jobqueue_aging_large", test_pri_jobqueue_aging_large, 
+        test_setup, test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
+
+    { "/test_pri_jobqueue_set_order", test_pri_jobqueue_set_order, NULL,
+        NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { "/test_pri_jobqueue_deadline", test_pri_jobqueue_deadline, test_setup,
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
+
+    { "/test_pri_jobqueue_cancel", test_pri_jobqueue_cancel, test_setup,
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
+
+    { "/test_pri_jobqueue_cancel_duplicate", 
+        test_pri_jobqueue_cancel_duplicate, test_setup, test_tear_down, 
+        MUNIT_TEST_OPTION_NONE, engine_params },
+
+    { "/test_pri_jobqueue_compact", test_pri_jobqueue_compact, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, engine_params },
+
+    { "/test_pri_jobqueue_occupancy", test_pri_jobqueue_occupancy, test_setup,
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
+
+    { "/test_pri_jobqueue_borrow", test_pri_jobqueue_borrow, test_setup,
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
+
+    { "/test_pri_jobqueue_batch", test_pri_jobqueue_batch, test_setup,
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
 
     { "/test_prijq_ndequeue_randpri", test_prijq_ndequeue_randpri, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_ndequeue_samepri", test_prijq_ndequeue_samepri, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_ndequeue_decpri", test_prijq_ndequeue_decpri, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_ndequeue_incpri", test_prijq_ndequeue_incpri, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_ndequeue_inout", test_prijq_ndequeue_inout, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_ndequeue_randinout", test_prijq_ndequeue_randinout,
-        test_setup, test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_setup, test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_ndequeue_heap", test_prijq_ndequeue_heap, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
 
     { "/test_prijq_dequeue_empty", test_prijq_dequeue_empty, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_dequeue_null", test_prijq_dequeue_null, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
 
     { "/test_prijq_enqueue_full", test_prijq_enqueue_full, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_enqueue_null", test_prijq_enqueue_null, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_enqueue_zeropri", test_prijq_enqueue_zeropri, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     
     { "/test_prijq_is_empty", test_prijq_is_empty, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_is_empty_notempty", test_prijq_is_empty_notempty, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_is_empty_nqnotempty", test_prijq_is_empty_nqnotempty,
-        test_setup, test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_setup, test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_is_empty_null", test_prijq_is_empty_null, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
 
     { "/test_prijq_is_full_empty", test_prijq_is_full_empty, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_is_full_filling", test_prijq_is_full_filling, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_is_full_nqfilling", test_prijq_is_full_nqfilling, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_is_full_null", test_prijq_is_full_null, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
 
     { "/test_prijq_peek_full", test_prijq_peek_full, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_peek_empty", test_prijq_peek_empty, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_peek_heap", test_prijq_peek_heap, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_peek_null", test_prijq_peek_null, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
 
     { "/test_prijq_size_empty", test_prijq_size_empty, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_size_filling", test_prijq_size_filling, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_size_nqfilling", test_prijq_size_nqfilling, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_size_null", test_prijq_size_null, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
 
     { "/test_prijq_space_empty", test_prijq_space_empty, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_space_filling", test_prijq_space_filling, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_space_nqfilling", test_prijq_space_nqfilling, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
     { "/test_prijq_space_null", test_prijq_space_null, test_setup,
-        test_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+        test_tear_down, MUNIT_TEST_OPTION_NONE, engine_params },
 
     { "/test_pri_jobqueue_delete", test_pri_jobqueue_delete, NULL, NULL,
         MUNIT_TEST_OPTION_NONE, NULL },
@@ -0,0 +1,148 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test_pri_search.h"
+#include "../pri_search.h"
+
+#define MAX_N 1000
+
+int main(int argc, char** argv) {
+    return munit_suite_main(&suite, NULL, argc, argv);
+}
+
+/* select the isa parameter, false if the CPU does not support it */
+static bool set_isa_param(const MunitParameter params[]) {
+    const char* name = munit_parameters_get(params, "isa");
+
+    for (pri_search_isa_t isa = PRI_SEARCH_SCALAR; isa <= PRI_SEARCH_AVX512;
+         isa++) {
+        if (!strcmp(name, pri_search_isa_name(isa)))
+            return pri_search_set_isa(isa);
+    }
+
+    return false;
+}
+
+static unsigned int ref_min(const unsigned int* prios, int n) {
+    unsigned int least = 0;
+
+    for (int i = 0; i < n; i++) {
+        if (prios[i] && (!least || prios[i] < least))
+            least = prios[i];
+    }
+
+    return least;
+}
+
+static int ref_find(const unsigned int* prios, int n, int from,
+    unsigned int value) {
+    for (int i = from < 0 ? n : from; i < n; i++) {
+        if (prios[i] == value) return i;
+    }
+
+    return -1;
+}
+
+/* check the kernels against the reference on prios + off for every n */
+static void check_all_n(const unsigned int* prios, int max_n) {
+    for (int n = 0; n <= max_n; n++) {
+        unsigned int least = ref_min(prios, n);
+        
+        assert_uint(pri_search_min(prios, n), ==, least);
+        assert_int(pri_search_first_min(prios, n), ==, 
+            least ? ref_find(prios, n, 0, least) : -1);
+        
+        for (int from = 0; from <= n; from += 1 + n / 8) {
+            assert_int(pri_search_find(prios, n, from, least), ==, 
+                ref_find(prios, n, from, least));
+            assert_int(pri_search_find(prios, n, from, prios[0]), ==, 
+                ref_find(prios, n, from, prios[0]));
+        }
+    }
+}
+
+MunitResult test_pri_search_empty(const MunitParameter params[],
+    void* fixture) {
+    if (!set_isa_param(params)) return MUNIT_SKIP;
+    
+    unsigned int zeros[MAX_N] = { 0 };
+    
+    assert_uint(pri_search_min(NULL, 10), ==, 0);
+    assert_uint(pri_search_min(zeros, 0), ==, 0);
+    assert_uint(pri_search_min(zeros, MAX_N), ==, 0);
+    assert_int(pri_search_first_min(zeros, MAX_N), ==, -1);
+    assert_int(pri_search_find(zeros, MAX_N, 0, 1), ==, -1);
+    assert_int(pri_search_find(zeros, MAX_N, MAX_N - 1, 0), ==, MAX_N - 1);
+    assert_int(pri_search_find(zeros, MAX_N, MAX_N, 0), ==, -1);
+    assert_int(pri_search_find(zeros, MAX_N, -1, 0), ==, -1);
+    assert_int(pri_search_find(NULL, MAX_N, 0, 0), ==, -1);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_pri_search_isa(const MunitParameter params[],
+    void* fixture) {
+    pri_search_isa_t widest = pri_search_isa();
+    
+    // the default is the widest supported isa
+    assert_true(pri_search_isa_supported(widest));
+    for (pri_search_isa_t isa = widest + 1; isa <= PRI_SEARCH_AVX512; isa++)
+        assert_false(pri_search_isa_supported(isa));
+    
+    assert_true(pri_search_isa_supported(PRI_SEARCH_SCALAR));
+    assert_true(pri_search_set_isa(PRI_SEARCH_SCALAR));
+    assert_int(pri_search_isa(), ==, PRI_SEARCH_SCALAR);
+    assert_false(pri_search_set_isa((pri_search_isa_t) -1));
+    assert_int(pri_search_isa(), ==, PRI_SEARCH_SCALAR);
+    assert_string_equal(pri_search_isa_name((pri_search_isa_t) 99), 
+        "unknown");
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_pri_search_random(const MunitParameter params[],
+    void* fixture) {
+    if (!set_isa_param(params)) return MUNIT_SKIP;
+    
+    unsigned int prios[MAX_N + 3];
+    
+    for (int round = 0; round < 20; round++) {
+        int zero_pct = munit_rand_int_range(0, 100);
+        unsigned int max_pri = munit_rand_int_range(2, round % 2 ? 8 : 10000);
+        
+        for (int i = 0; i < MAX_N + 3; i++) {
+            prios[i] = munit_rand_int_range(0, 99) < zero_pct ? 0 
+                : (unsigned int) munit_rand_int_range(1, max_pri);
+        }
+        
+        // unaligned starts as well as aligned
+        check_all_n(prios + round % 4, 200);
+        check_all_n(prios, MAX_N);
+    }
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_pri_search_extremes(const MunitParameter params[],
+    void* fixture) {
+    if (!set_isa_param(params)) return MUNIT_SKIP;
+    
+    unsigned int prios[MAX_N];
+    
+    // very large priorities must not be confused with unused slots
+    for (int i = 0; i < MAX_N; i++)
+        prios[i] = i % 3 ? ~0u : 0;
+    check_all_n(prios, 100);
+    prios[77] = ~0u - 1;
+    check_all_n(prios, 100);
+    
+    // the single highest priority in every position
+    for (int pos = 0; pos < 70; pos++) {
+        for (int i = 0; i < 70; i++)
+            prios[i] = 5;
+        prios[pos] = 1;
+        assert_uint(pri_search_min(prios, 70), ==, 1);
+        assert_int(pri_search_first_min(prios, 70), ==, pos);
+    }
+    
+    return MUNIT_OK;
+}
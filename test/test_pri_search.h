@@ -0,0 +1,42 @@
+/* 
+ * test_pri_search.h - structures and function declarations for unit tests
+ * of the pri_search kernels.
+ */  
+#ifndef _TEST_PRI_SEARCH_H
+#define _TEST_PRI_SEARCH_H
+#define MUNIT_ENABLE_ASSERT_ALIASES
+#include "munit/munit.h"
+
+MunitResult test_pri_search_empty(const MunitParameter params[],
+    void* fixture);
+MunitResult test_pri_search_isa(const MunitParameter params[],
+    void* fixture);
+MunitResult test_pri_search_random(const MunitParameter params[],
+    void* fixture);
+MunitResult test_pri_search_extremes(const MunitParameter params[],
+    void* fixture);
+
+static char* isa_values[] = { "scalar", "sse4.1", "avx2", "avx512", NULL };
+
+static MunitParameterEnum isa_params[] = {
+    { "isa", isa_values },
+    { NULL, NULL },
+};
+
+static MunitTest tests[] = {
+    { "/test_pri_search_empty", test_pri_search_empty, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, isa_params },
+    { "/test_pri_search_isa", test_pri_search_isa, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { "/test_pri_search_random", test_pri_search_random, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, isa_params },
+    { "/test_pri_search_extremes", test_pri_search_extremes, NULL, NULL,
+        MUNIT_TEST_OPTION_NONE, isa_params },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite suite = {
+    "/test_pri_search", tests, NULL, 1, MUNIT_SUITE_OPTION_NONE
+};
+
+#endif
@@ -166,6 +166,280 @@ MunitResult test_sem_jobqueue_2proc_ndequeue(
     return MUNIT_OK;
 }
 
+MunitResult test_sem_jobqueue_new_sized(const MunitParameter params[], 
+    void* fixture) {
+    proc_t* proc = new_init_proc();
+    int capacity = JOB_BUFFER_SIZE * 2;
+    sem_jobqueue_t* sjq = sem_jobqueue_new_sized(proc, capacity);
+    
+    assert_not_null(sjq);
+    
+    // must not block on the empty semaphore beyond JOB_BUFFER_SIZE jobs
+    for (int i = 0; i < capacity; i++) {
+        job_t j;
+        set_job(&j, i + 1, i, i + 1);
+        errno = 0;
+        sem_jobqueue_enqueue(sjq, &j);
+        assert_int(errno, ==, 0);
+    }
+    
+    assert_true(sem_jobqueue_is_full(sjq));
+    assert_int(sem_jobqueue_size(sjq), ==, capacity);
+    
+    for (int i = 0; i < capacity; i++) {
+        job_t expj;
+        job_t dqj;
+        set_job(&expj, i + 1, i, i + 1);
+        assert_not_null(sem_jobqueue_dequeue(sjq, &dqj));
+        assert_true(equal_jobs(&dqj, &expj));
+    }
+    
+    assert_true(sem_jobqueue_is_empty(sjq));
+    
+    del_sjq(sjq);
+    proc_delete(proc);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_sem_jobqueue_2proc_batch(const MunitParameter params[], 
+    void* fixture) {
+    int njobs = JOB_BUFFER_SIZE * 4;
+    int burst = 24;
+    job_t jobs[njobs];
+
+    for (int i = 0; i < njobs; i++)
+        set_job(&jobs[i], i + 1, i, i + 1);
+    
+    // create the queue before forking so that the child can open it
+    proc_t* pp = new_init_proc();
+    sem_jobqueue_t* sjq = sem_jobqueue_new(pp);
+    assert_not_null(sjq);
+    
+    pid_t pid = fork();
+    
+    if (pid < 0)
+        return MUNIT_FAIL;
+    
+    if (pid == 0) {
+        // in child, produce jobs in bursts
+        proc_t* cp = new_noninit_proc();
+        sem_jobqueue_t* csjq = sem_jobqueue_new(cp);
+
+        assert_not_null(csjq);
+        
+        int sent = 0;
+        while (sent < njobs) {
+            int n = njobs - sent < burst ? njobs - sent : burst;
+            int k = sem_jobqueue_enqueue_n(csjq, jobs + sent, n);
+            assert_int(k, >, 0);
+            sent += k;
+        }
+        
+        exit(EXIT_SUCCESS);
+    } else {
+        // in parent, consume jobs in bursts
+        int child_stat;
+        job_t dqj[burst];
+        int got = 0;
+
+        while (got < njobs) {
+            int k = sem_jobqueue_dequeue_n(sjq, dqj, burst);
+            assert_int(k, >, 0);
+            
+            for (int i = 0; i < k; i++)
+                assert_true(equal_jobs(&dqj[i], &jobs[got++]));
+        }
+        
+        waitpid(pid, &child_stat, 0);
+        assert_int(WEXITSTATUS(child_stat), ==, EXIT_SUCCESS);
+        assert_true(sem_jobqueue_is_empty(sjq));
+        
+        // nothing to claim for an invalid job
+        jobs[0].priority = 0;
+        assert_int(sem_jobqueue_enqueue_n(sjq, jobs, 1), ==, 0);
+        assert_int(sem_jobqueue_enqueue_n(NULL, jobs, 1), ==, 0);
+        assert_int(sem_jobqueue_dequeue_n(NULL, jobs, 1), ==, 0);
+        
+        del_sjq(sjq);
+        proc_delete(pp);
+    }
+
+    return MUNIT_OK;
+}
+
+MunitResult test_sem_jobqueue_borrow(const MunitParameter params[], 
+    void* fixture) {
+    proc_t* proc = new_init_proc();
+    sem_jobqueue_t* sjq = sem_jobqueue_new_sized(proc, 2);
+    job_t j;
+    job_t j2;
+    
+    assert_not_null(sjq);
+    
+    set_job(&j, 1, 1, 1);
+    sem_jobqueue_enqueue(sjq, &j);
+    
+    const job_t* b = sem_jobqueue_borrow(sjq);
+    assert_not_null(b);
+    assert_true(equal_jobs((job_t*) b, &j));
+    
+    // the mutex is not held while the job is borrowed
+    set_job(&j2, 2, 2, 2);
+    sem_jobqueue_enqueue(sjq, &j2);
+    assert_int(sem_jobqueue_size(sjq), ==, 1);
+    assert_true(sem_jobqueue_is_full(sjq));
+    
+    // the borrowed slot is not free until committed
+    assert_int(sem_trywait(sjq->empty), ==, -1);
+    assert_true(sem_jobqueue_commit(sjq, b));
+    assert_false(sem_jobqueue_commit(sjq, b));
+    assert_int(sem_jobqueue_space(sjq), ==, 1);
+    
+    errno = 0;
+    sem_jobqueue_enqueue(sjq, &j);
+    assert_int(errno, ==, 0);
+    assert_true(sem_jobqueue_is_full(sjq));
+    
+    assert_null(sem_jobqueue_borrow(NULL));
+    assert_false(sem_jobqueue_commit(NULL, b));
+    
+    del_sjq(sjq);
+    proc_delete(proc);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_sem_jobqueue_deadline(const MunitParameter params[], 
+    void* fixture) {
+    proc_t* proc = new_init_proc();
+    sem_jobqueue_t* sjq = sem_jobqueue_new_sized(proc, 2);
+    deadline_job_t dj;
+    
+    assert_not_null(sjq);
+    assert_true(sem_jobqueue_set_order(sjq, PRI_JOBQUEUE_BY_DEADLINE));
+    
+    set_job(&dj.job, 1, 1, 1);
+    dj.deadline = 100;
+    assert_true(sem_jobqueue_enqueue_deadline(sjq, &dj));
+    set_job(&dj.job, 2, 2, 2);
+    dj.deadline = 50;
+    assert_true(sem_jobqueue_enqueue_deadline(sjq, &dj));
+    assert_true(sem_jobqueue_is_full(sjq));
+    
+    // no reachable job returns at once, leaving the queue full
+    assert_null(sem_jobqueue_dequeue_reachable(sjq, 101, &dj));
+    assert_int(sem_jobqueue_size(sjq), ==, 2);
+    
+    assert_not_null(sem_jobqueue_peek_reachable(sjq, 51, &dj));
+    assert_int(dj.job.id, ==, 1);
+    assert_not_null(sem_jobqueue_dequeue_reachable(sjq, 51, &dj));
+    assert_int(dj.job.id, ==, 1);
+    assert_int(sem_jobqueue_space(sjq), ==, 1);
+    
+    assert_not_null(sem_jobqueue_dequeue_deadline(sjq, &dj));
+    assert_int(dj.job.id, ==, 2);
+    assert_true(dj.deadline == 50);
+    
+    // the semaphores agree with the queue: empty has both units again
+    assert_int(sem_trywait(sjq->full), ==, -1);
+    assert_int(sem_trywait(sjq->empty), ==, 0);
+    assert_int(sem_trywait(sjq->empty), ==, 0);
+    sem_post(sjq->empty);
+    sem_post(sjq->empty);
+    
+    assert_false(sem_jobqueue_set_order(NULL, PRI_JOBQUEUE_BY_DEADLINE));
+    assert_false(sem_jobqueue_enqueue_deadline(NULL, &dj));
+    assert_null(sem_jobqueue_dequeue_deadline(NULL, &dj));
+    assert_null(sem_jobqueue_peek_reachable(NULL, 0, &dj));
+    assert_null(sem_jobqueue_dequeue_reachable(NULL, 0, &dj));
+    
+    del_sjq(sjq);
+    proc_delete(proc);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_sem_jobqueue_cancel(const MunitParameter params[], 
+    void* fixture) {
+    proc_t* proc = new_init_proc();
+    sem_jobqueue_t* sjq = sem_jobqueue_new_sized(proc, 2);
+    job_t j;
+    
+    assert_not_null(sjq);
+    
+    set_job(&j, 1, 1, 1);
+    sem_jobqueue_enqueue(sjq, &j);
+    set_job(&j, 2, 2, 2);
+    sem_jobqueue_enqueue(sjq, &j);
+    assert_true(sem_jobqueue_is_full(sjq));
+    
+    // a cancelled job frees its slot for a producer
+    assert_true(sem_jobqueue_cancel(sjq, 1, 1));
+    assert_false(sem_jobqueue_cancel(sjq, 1, 1));
+    assert_int(sem_trywait(sjq->empty), ==, 0);
+    sem_post(sjq->empty);
+    
+    set_job(&j, 3, 3, 3);
+    sem_jobqueue_enqueue(sjq, &j);
+    assert_true(sem_jobqueue_reprioritise(sjq, 3, 3, 1));
+    
+    assert_not_null(sem_jobqueue_dequeue(sjq, &j));
+    assert_int(j.id, ==, 3);
+    assert_not_null(sem_jobqueue_dequeue(sjq, &j));
+    assert_int(j.id, ==, 2);
+    
+    // nothing left to claim
+    assert_int(sem_trywait(sjq->full), ==, -1);
+    assert_false(sem_jobqueue_cancel(sjq, 2, 2));
+    
+    assert_false(sem_jobqueue_cancel(NULL, 2, 2));
+    assert_false(sem_jobqueue_reprioritise(NULL, 2, 2, 1));
+    
+    del_sjq(sjq);
+    proc_delete(proc);
+    
+    return MUNIT_OK;
+}
+
+MunitResult test_sem_jobqueue_rejected(const MunitParameter params[], 
+    void* fixture) {
+    proc_t* proc = new_init_proc();
+    sem_jobqueue_t* sjq = sem_jobqueue_new_sized(proc, 2);
+    job_t j;
+    
+    assert_not_null(sjq);
+    
+    // a job with a label the queue rejects is not queued
+    set_job(&j, 1, 1, 1);
+    j.label[0] = '\0';
+    sem_jobqueue_enqueue(sjq, &j);
+    assert_int(sem_jobqueue_size(sjq), ==, 0);
+    
+    // and its slot goes back: full has no unit, so a dequeue would block
+    assert_int(sem_trywait(sjq->full), ==, -1);
+    assert_int(errno, ==, EAGAIN);
+    errno = 0;
+    assert_int(sem_trywait(sjq->empty), ==, 0);
+    assert_int(sem_trywait(sjq->empty), ==, 0);
+    sem_post(sjq->empty);
+    sem_post(sjq->empty);
+    
+    // the queue still holds its capacity
+    set_job(&j, 1, 1, 1);
+    sem_jobqueue_enqueue(sjq, &j);
+    set_job(&j, 2, 2, 2);
+    sem_jobqueue_enqueue(sjq, &j);
+    assert_true(sem_jobqueue_is_full(sjq));
+    assert_int(sem_trywait(sjq->empty), ==, -1);
+    errno = 0;
+    
+    del_sjq(sjq);
+    proc_delete(proc);
+    
+    return MUNIT_OK;
+}
+
 MunitResult test_sem_jobqueue_delete(const MunitParameter params[], 
     void* fixture) {
     proc_t* proc = new_init_proc();
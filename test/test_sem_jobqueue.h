@@ -28,6 +28,24 @@ MunitResult test_semjq_space_null(const MunitParameter params[],
 MunitResult test_sem_jobqueue_2proc_ndequeue(const MunitParameter params[],
     void* fixture);
 
+MunitResult test_sem_jobqueue_new_sized(const MunitParameter params[],
+    void* fixture);
+
+MunitResult test_sem_jobqueue_2proc_batch(const MunitParameter params[],
+    void* fixture);
+
+MunitResult test_sem_jobqueue_borrow(const MunitParameter params[],
+    void* fixture);
+
+MunitResult test_sem_jobqueue_deadline(const MunitParameter params[],
+    void* fixture);
+
+MunitResult test_sem_jobqueue_cancel(const MunitParameter params[],
+    void* fixture);
+
+MunitResult test_sem_jobqueue_rejected(const MunitParameter params[],
+    void* fixture);
+
 MunitResult test_sem_jobqueue_delete(const MunitParameter params[],
     void* fixture);
 
@@ -53,6 +71,24 @@ static MunitTest tests[] = {
     { "/test_sem_jobqueue_2proc_ndequeue", test_sem_jobqueue_2proc_ndequeue,
         NULL, NULL, MUNIT_TEST_OPTION_NONE,  NULL },
         
+    { "/test_sem_jobqueue_new_sized", test_sem_jobqueue_new_sized,
+        NULL, NULL, MUNIT_TEST_OPTION_NONE,  NULL },
+        
+    { "/test_sem_jobqueue_2proc_batch", test_sem_jobqueue_2proc_batch,
+        NULL, NULL, MUNIT_TEST_OPTION_NONE,  NULL },
+        
+    { "/test_sem_jobqueue_borrow", test_sem_jobqueue_borrow,
+        NULL, NULL, MUNIT_TEST_OPTION_NONE,  NULL },
+        
+    { "/test_sem_jobqueue_deadline", test_sem_jobqueue_deadline,
+        NULL, NULL, MUNIT_TEST_OPTION_NONE,  NULL },
+        
+    { "/test_sem_jobqueue_cancel", test_sem_jobqueue_cancel,
+        NULL, NULL, MUNIT_TEST_OPTION_NONE,  NULL },
+        
+    { "/test_sem_jobqueue_rejected", test_sem_jobqueue_rejected,
+        NULL, NULL, MUNIT_TEST_OPTION_NONE,  NULL },
+        
     { "/test_sem_jobqueue_delete", test_sem_jobqueue_delete,
         NULL, NULL, MUNIT_TEST_OPTION_NONE,  NULL },
         